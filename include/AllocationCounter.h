@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts calls to the global operator new. AllocationCounter.cpp replaces
+// operator new and delete for the whole program, so it is built into the
+// viewer only and kept out of bloch_core: linked into the library, it would
+// take over every tool's allocations as well.
+
+// Allocations on all threads since startup
+uint64_t heapAllocations();
+
+// Allocations made by the calling thread since it started
+uint64_t threadHeapAllocations();
@@ -1,14 +1,18 @@
 #pragma once
 
+#include "GpuResources.h"
+#include "RenderQueue.h"
 #include "Shader.h"
 #include <glm/glm.hpp>
 
 class Axes {
 public:
     Axes(float length);
-    void draw(const Shader& shader, const glm::mat4& view, const glm::mat4& projection, float thickness);
+    // Queues the three axes in red, green and blue
+    void submit(RenderQueue& queue, const Shader& shader, const glm::mat4& model, float thickness) const;
 
 private:
-    unsigned int m_VAO, m_VBO;
+    GlVertexArray m_VAO;
+    GlBuffer m_VBO;
     float m_length;
 };
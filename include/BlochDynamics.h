@@ -0,0 +1,16 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Drive and relaxation parameters of the rotating-frame Bloch equations.
+// Rates are in radians per unit time; a relaxation time of 0 disables that channel.
+struct BlochEquationParams {
+    float rabi = 0.0f;
+    float detuning = 0.0f;
+    float t1 = 0.0f;
+    float t2 = 0.0f;
+};
+
+// Integrates the Bloch equations from the given Bloch vector for `duration`
+// using `steps` exact precession steps, each followed by T1/T2 decay.
+glm::vec3 evolveBloch(glm::vec3 bloch, const BlochEquationParams& params, float duration, unsigned int steps);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <complex>
+#include <glm/glm.hpp>
+
+// Bloch vectors are kept in physics coordinates, with +z pointing at |0>.
+// The scene draws |0> on +y, so convert with toScene before rendering.
+
+// theta and phi are in radians
+glm::vec3 blochFromAngles(float theta, float phi);
+// Inverse of blochFromAngles for any non-zero vector, phi in [0, 2*PI)
+void blochToAngles(const glm::vec3& bloch, float& theta, float& phi);
+
+glm::vec3 toScene(const glm::vec3& bloch);
+glm::vec3 fromScene(const glm::vec3& scene);
+
+// Blend from `a` (t = 0) to `b` (t = 1): the direction turns along the great
+// circle at constant rate and the length changes linearly, so interpolating
+// between two steps of a precession stays on its path
+glm::vec3 interpolateBloch(const glm::vec3& a, const glm::vec3& b, float t);
+
+// Tr(rho^2) of the state with the given Bloch vector, 1 for pure states and 0.5 fully mixed
+float purity(const glm::vec3& bloch);
+
+// alpha|0> + beta|1> with alpha real and non-negative
+struct Amplitudes {
+    std::complex<float> alpha;
+    std::complex<float> beta;
+};
+
+// Amplitudes of the pure state along the Bloch vector's direction. For mixed
+// states this is the dominant eigenvector of the density matrix.
+Amplitudes amplitudesFromBloch(const glm::vec3& bloch);
+
+// Bloch vector of a (not necessarily normalized) pure state
+glm::vec3 blochFromAmplitudes(const Amplitudes& amplitudes);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "GpuResources.h"
+#include "Shader.h"
+#include "Sphere.h"
+#include "SphereHistogram.h"
+
+// Shades a SphereHistogram onto a solid sphere just inside the wireframe.
+// The counts live in an integer texture that is updated a band of rows at a
+// time, and density.frag finds each fragment's bin itself, so the mesh needs
+// no texture coordinates and the bins do not follow its triangles.
+class DensityMap {
+public:
+    DensityMap();
+
+    // Sends the rows changed since the last upload, or the whole texture if
+    // the resolution changed. Returns the rows sent.
+    unsigned int upload(SphereHistogram& histogram);
+
+    // Draws with density.vert and density.frag; log-scaled to the peak count
+    void draw(const Shader& shader, const glm::mat4& view, const glm::mat4& projection, const glm::mat4& model) const;
+
+private:
+    Sphere m_sphere;
+    GlTexture m_texture;
+    unsigned int m_nside;
+    uint32_t m_peak;
+};
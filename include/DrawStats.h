@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+struct ImDrawData;
+
+// Draw calls issued since the last reset, counted next to each glDraw* call,
+// and objects skipped before submission. The renderer only runs on the GL
+// thread, so the counters are plain fields.
+struct DrawStats {
+    uint32_t drawCalls = 0;
+    uint64_t instances = 0;
+    uint32_t cullTested = 0;  // bounding spheres tested against the frustum
+    uint32_t culled = 0;      // of those, outside it
+    uint32_t occluded = 0;    // labels and arrows hidden behind their sphere
+
+    void reset() { *this = DrawStats(); }
+};
+
+inline DrawStats& drawStats()
+{
+    static DrawStats stats;
+    return stats;
+}
+
+inline void countDraw(uint32_t instances = 1)
+{
+    DrawStats& stats = drawStats();
+    ++stats.drawCalls;
+    stats.instances += instances;
+}
+
+// Counts the draw commands ImGui is about to submit for `data`
+void countImGuiDraws(const ImDrawData* data);
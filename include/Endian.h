@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Little-endian encoding for the binary file and wire formats. Written with
+// shifts so they are correct on any host; compilers reduce them to plain
+// loads and stores on little-endian machines.
+
+inline unsigned char* storeLE(unsigned char* out, uint32_t value)
+{
+    out[0] = static_cast<unsigned char>(value);
+    out[1] = static_cast<unsigned char>(value >> 8);
+    out[2] = static_cast<unsigned char>(value >> 16);
+    out[3] = static_cast<unsigned char>(value >> 24);
+    return out + 4;
+}
+
+inline unsigned char* storeLE(unsigned char* out, uint64_t value)
+{
+    storeLE(out, static_cast<uint32_t>(value));
+    return storeLE(out + 4, static_cast<uint32_t>(value >> 32));
+}
+
+inline unsigned char* storeLE(unsigned char* out, float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return storeLE(out, bits);
+}
+
+inline unsigned char* storeLE(unsigned char* out, double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return storeLE(out, bits);
+}
+
+inline uint32_t loadLE32(const unsigned char* in)
+{
+    return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8
+        | static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24;
+}
+
+inline uint64_t loadLE64(const unsigned char* in)
+{
+    return static_cast<uint64_t>(loadLE32(in)) | static_cast<uint64_t>(loadLE32(in + 4)) << 32;
+}
+
+inline float loadLEFloat(const unsigned char* in)
+{
+    uint32_t bits = loadLE32(in);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline double loadLEDouble(const unsigned char* in)
+{
+    uint64_t bits = loadLE64(in);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
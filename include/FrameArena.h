@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for data that lives for one frame: uniform names, formatted
+// label text, scratch arrays. Allocation is a pointer increment and reset()
+// frees everything at once. When a frame needs more than the block holds the
+// rest comes from overflow chunks, and the next reset() replaces the block
+// with one large enough for that frame, so a steady-state frame never touches
+// the heap. Not thread-safe; each thread that wants one keeps its own.
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity = 256 * 1024);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    // Uninitialised storage for `count` objects; nothing is ever destroyed
+    template <typename T>
+    T* allocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "frame arena objects are never destroyed");
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Null-terminated copy of `text`, for APIs that want a C string
+    const char* copy(std::string_view text);
+
+    // printf into the arena
+    const char* format(const char* fmt, ...);
+
+    // Frees everything allocated since the last reset
+    void reset();
+
+    size_t used() const { return m_used + m_overflowUsed + m_chunkUsed; }
+    size_t capacity() const { return m_capacity; }
+    // Most bytes used in one frame since the arena was created
+    size_t peak() const { return m_peak; }
+
+private:
+    std::unique_ptr<unsigned char[]> m_block;
+    size_t m_capacity;
+    size_t m_used;
+    // Overflow chunks, bumped through like the block; only the last has room
+    std::vector<std::unique_ptr<unsigned char[]>> m_overflow;
+    size_t m_chunkSize;
+    size_t m_chunkUsed;
+    size_t m_overflowUsed;  // in the chunks before the last one
+    size_t m_peak;
+};
+
+// The render thread's arena, reset at the end of every frame
+FrameArena& frameArena();
+
+// STL allocator over a FrameArena, for containers that do not outlive the
+// frame. Deallocation is a no-op; the memory comes back at reset().
+template <typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator() : m_arena(&frameArena()) {}
+    explicit FrameAllocator(FrameArena& arena) : m_arena(&arena) {}
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : m_arena(other.arena()) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    FrameArena* arena() const { return m_arena; }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const { return m_arena == other.arena(); }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>& other) const { return m_arena != other.arena(); }
+
+private:
+    FrameArena* m_arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "FrameStats.h"
+
+struct GLFWwindow;
+
+struct FrameBenchmarkOptions {
+    unsigned int frames = 300;
+    unsigned int warmupFrames = 30;
+    const char* scene = nullptr;         // run only the scene with this name
+    const char* baselinePath = nullptr;  // compare the results against this baseline
+    const char* savePath = nullptr;      // write the results as a new baseline
+    BaselineTolerance tolerance;
+    bool requireNoAllocations = false;   // fail if a measured frame allocates on the heap
+};
+
+// Renders each canned scene into `window` for a fixed number of frames with
+// the camera orbiting, timing every frame up to a glFinish after the swap.
+// Prints p50/p95/p99 frame times, draw calls and heap allocations per scene
+// and compares them with the baseline. Returns the process exit code, 1 on a
+// regression.
+//
+//   single_sphere   the default view: sphere, axes, state vector, labels
+//   instanced_1k    a 32x32 sweep sheet, 1024 instanced spheres
+//   trail_100k      the default view with a 100k-point trajectory trail
+//   labels          the default view with 256 extra state labels
+//   grid_64         an 8x8 grid of Bloch spheres through the render queue
+int runFrameBenchmark(GLFWwindow* window, const FrameBenchmarkOptions& options);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Frame-time summary of one benchmark scene
+struct FrameStats {
+    std::string scene;
+    uint32_t frames = 0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    uint32_t drawCalls = 0;  // per frame
+};
+
+// How far a run may drift from its baseline before it counts as a regression.
+// Times may grow by `timePercent` plus `slackMs`, which keeps sub-millisecond
+// scenes from failing on timer noise; draw calls by `drawPercent`.
+struct BaselineTolerance {
+    double timePercent = 10.0;
+    double slackMs = 0.05;
+    double drawPercent = 0.0;
+};
+
+// Nearest-rank percentiles; sorts `frameMs` in place
+FrameStats summarizeFrames(const std::string& scene, std::vector<double>& frameMs, uint32_t drawCalls);
+
+// Baselines are text files with one scene per line:
+//   scene p50_ms p95_ms p99_ms draw_calls
+// Blank lines and lines starting with '#' are ignored.
+bool readBaseline(const char* path, std::vector<FrameStats>& scenes, std::string& error);
+bool writeBaseline(const char* path, const std::vector<FrameStats>& scenes, std::string& error);
+
+// Returns false and describes the first exceeded limit in `reason` if
+// `current` is slower or issues more draw calls than `baseline` allows
+bool withinBaseline(const FrameStats& current, const FrameStats& baseline, const BaselineTolerance& tolerance, std::string& reason);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// The six planes of a view frustum, normalized and facing inwards, taken from
+// a combined projection * view matrix
+struct Frustum {
+    glm::vec4 planes[6];
+
+    static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+    bool intersectsSphere(const glm::vec3& center, float radius) const;
+};
+
+// Bounding spheres stored one component per array, so four can be tested
+// against a plane with one vector operation
+struct BoundingSpheres {
+    std::vector<float> x, y, z, radius;
+
+    size_t size() const { return x.size(); }
+    void clear();
+    void add(const glm::vec3& center, float r);
+};
+
+// Writes the indices of the spheres that touch `frustum` to `visible` in
+// increasing order and returns how many there are. `visible` needs room for
+// every sphere. Tests four spheres at a time with SSE where available.
+size_t cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, uint32_t* visible);
+
+// Whether `point`, seen from `eye`, is hidden by the solid sphere at `center`:
+// the line of sight passes through the sphere, or the point lies on or in it
+// on the far side
+bool occludedBySphere(const glm::vec3& eye, const glm::vec3& point, const glm::vec3& center, float radius);
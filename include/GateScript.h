@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Gates.h"
+
+// Parses one circuit written as gate tokens separated by whitespace or ';',
+// for example "h t rx(0.5) depol(0.01)". Angles are in radians and anything
+// after '#' is a comment. Every circuit starts from |0>.
+//
+//   i x y z h s sdg t tdg            fixed gates
+//   rx(a) ry(a) rz(a)                rotations
+//   reset  init(theta, phi)          replace the state
+//   depol(p) dephase(p) ampdamp(g)   noise channels
+//   evolve(rabi, detuning, t1, t2, duration)
+//
+// `ops` is cleared and refilled, so reusing it across calls does not allocate
+// once it has grown to the longest circuit. Returns false and fills `error`
+// on a malformed token.
+bool parseCircuit(const char* begin, const char* end, std::vector<BlochChannel>& ops, std::string& error);
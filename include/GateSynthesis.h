@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Single-qubit gate synthesis over Clifford+T. A unitary is a unit quaternion
+// q = (w, x, y, z) standing for w - i (x X + y Y + z Z), the convention of
+// rotationGate, so the product of two unitaries is the quaternion product and
+// q and -q are the same gate up to global phase.
+
+enum class CliffordTGate : uint8_t {
+    H = 0,
+    S = 1,
+    T = 2
+};
+
+glm::dquat cliffordTQuaternion(CliffordTGate gate);
+// Unitary of a sequence applied first to last
+glm::dquat sequenceQuaternion(const std::vector<CliffordTGate>& gates);
+// Distance between two gates up to global phase, sqrt(1 - <a, b>^2): the sine
+// of half the angle of the rotation taking one to the other
+double gateDistance(const glm::dquat& a, const glm::dquat& b);
+
+// Cancels HH pairs and merges each run of S and T gates into T^k, k mod 8,
+// written as up to three S and one T
+void simplifyCliffordT(std::vector<CliffordTGate>& gates);
+// "H T S H ..." in application order, or "I" for the empty sequence
+std::string formatCliffordT(const std::vector<CliffordTGate>& gates);
+unsigned int tCount(const std::vector<CliffordTGate>& gates);
+
+// Epsilon-net of Clifford+T unitaries with a nearest-neighbour index. Every
+// distinct unitary up to a word length is kept with its shortest word, packed
+// into 64 bits: the length in the low five bits, then two bits per gate.
+// Lookups go through a 4D kd-tree over the quaternions, which are stored as
+// floats with w >= 0; a query also tries -q, since both are the same gate.
+//
+// Table files (.ctnet), little-endian:
+//
+//   header   "CTNT" | u32 version | u32 count | u32 max length
+//   words    u64 packed word[count]
+//
+// The quaternions and the tree are rebuilt from the words when loading.
+class CliffordTNet {
+public:
+    static constexpr unsigned int kMaxWordLength = 29;
+
+    // Breadth-first over words of H, S and T, shortest first, until words of
+    // `maxLength` gates are done or the net holds `maxEntries` unitaries
+    void build(unsigned int maxLength, size_t maxEntries);
+    bool save(const char* path, std::string& error) const;
+    bool load(const char* path, std::string& error);
+
+    size_t size() const { return m_words.size(); }
+    unsigned int maxLength() const { return m_maxLength; }
+    // Bytes held in memory, and written to a table file
+    size_t memoryBytes() const;
+    size_t fileBytes() const;
+
+    // Entry nearest `target` up to phase, with its gateDistance
+    uint32_t nearest(const glm::dquat& target, double& distance) const;
+    void word(uint32_t entry, std::vector<CliffordTGate>& gates) const;
+
+private:
+    void buildIndex();
+    void buildNode(std::vector<uint32_t>& order, uint32_t begin, uint32_t end);
+    void search(const glm::vec4& query, uint32_t begin, uint32_t end, float& best, uint32_t& bestEntry) const;
+
+    // In kd-tree order: each range's median splits it along m_axes[median]
+    std::vector<uint64_t> m_words;
+    std::vector<glm::vec4> m_points;  // (x, y, z, w)
+    std::vector<uint8_t> m_axes;
+    unsigned int m_maxLength = 0;
+};
+
+struct SynthesisResult {
+    std::vector<CliffordTGate> gates;  // simplified
+    glm::dquat unitary;
+    double distance;  // gateDistance to the target
+};
+
+// Solovay-Kitaev refinement on top of the net: depth 0 is the plain lookup,
+// and each level corrects the previous approximation with a balanced group
+// commutator of two approximations one level down, so a sequence grows about
+// five times per level while the error shrinks roughly as its 3/2 power
+SynthesisResult synthesizeCliffordT(const CliffordTNet& net, const glm::dquat& target, unsigned int depth);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "BlochDynamics.h"
+
+// Any single-qubit channel acts on Bloch vectors as an affine map
+// r -> matrix * r + offset. Unitary gates are rotations with no offset, noise
+// channels shrink and shift the sphere, and resets have a zero matrix.
+struct BlochChannel {
+    glm::mat3 matrix = glm::mat3(1.0f);
+    glm::vec3 offset = glm::vec3(0.0f);
+
+    glm::vec3 apply(const glm::vec3& bloch) const { return matrix * bloch + offset; }
+};
+
+// `second` applied after `first`
+BlochChannel compose(const BlochChannel& first, const BlochChannel& second);
+
+// Rotation by `angle` radians about the unit vector `axis`, i.e. exp(-i angle/2 n.sigma)
+BlochChannel rotationGate(const glm::vec3& axis, float angle);
+
+BlochChannel pauliX();
+BlochChannel pauliY();
+BlochChannel pauliZ();
+BlochChannel hadamard();
+BlochChannel phaseS();
+BlochChannel phaseSdg();
+BlochChannel phaseT();
+BlochChannel phaseTdg();
+
+// Maps every state to the one with the given Bloch vector
+BlochChannel resetTo(const glm::vec3& bloch);
+
+// With probability p replace the state by the maximally mixed state
+BlochChannel depolarizing(float p);
+// With probability p apply Z
+BlochChannel dephasing(float p);
+// Decay of |1> to |0> with probability gamma
+BlochChannel amplitudeDamping(float gamma);
+
+// The Bloch equations with constant parameters are affine in the initial
+// state, so a whole evolution collapses into a single channel.
+BlochChannel blochEquationChannel(const BlochEquationParams& params, float duration, unsigned int steps);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "GpuResources.h"
+
+// One sphere tessellation on the GPU: positions and 32-bit triangle indices,
+// plus each edge once as line indices for wireframes. The element buffer is
+// vertex array state, so the lines get a second vertex array over the same
+// vertices.
+struct SphereGeometry {
+    GlVertexArray vao;
+    GlVertexArray lineVao;
+    GlBuffer vertices;
+    GlBuffer indices;
+    GlBuffer lineIndices;
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+    unsigned int lineIndexCount = 0;
+};
+
+// Process-wide cache of sphere tessellations keyed by shape, radius and
+// resolution, so each one is generated and uploaded once however many
+// spheres draw it. Entries stay until releaseUnused() or clear(). GL thread
+// only, like the handles it holds.
+class GeometryCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t builds = 0;
+    };
+
+    std::shared_ptr<const SphereGeometry> uvSphere(float radius, unsigned int rings, unsigned int sectors);
+    std::shared_ptr<const SphereGeometry> icosphere(float radius, unsigned int subdivisions);
+
+    // Drops the entries no sphere holds any more
+    void releaseUnused();
+    void clear();
+
+    size_t size() const { return m_entries.size(); }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    enum class Shape { UvSphere, Icosphere };
+
+    struct Entry {
+        Shape shape;
+        float radius;
+        unsigned int a, b;
+        std::shared_ptr<const SphereGeometry> geometry;
+    };
+
+    std::shared_ptr<const SphereGeometry> find(Shape shape, float radius, unsigned int a, unsigned int b);
+
+    std::vector<Entry> m_entries;
+    Stats m_stats;
+};
+
+GeometryCache& geometryCache();
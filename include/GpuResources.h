@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Owning handles for GL objects. Each deletes its object when destroyed and
+// can be moved but not copied, so a class that holds them gets the right
+// destructor and move operations for free. Every live object is listed in
+// gpuObjects() for the GPU Resources panel. Handles must be created and
+// destroyed on the thread that owns the GL context.
+
+enum class GlObjectType : uint8_t {
+    Buffer,
+    VertexArray,
+    Framebuffer,
+    Renderbuffer,
+    Texture,
+    Count
+};
+
+const char* glObjectTypeName(GlObjectType type);
+
+template <GlObjectType Type>
+class GlObject {
+public:
+    GlObject() = default;
+    // Generates a new object; `label` must outlive it, a string literal is typical
+    explicit GlObject(const char* label);
+    ~GlObject() { reset(); }
+
+    GlObject(GlObject&& other) noexcept : m_id(other.m_id), m_pooled(other.m_pooled)
+    {
+        other.m_id = 0;
+    }
+    GlObject& operator=(GlObject&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            m_id = other.m_id;
+            m_pooled = other.m_pooled;
+            other.m_id = 0;
+        }
+        return *this;
+    }
+    GlObject(const GlObject&) = delete;
+    GlObject& operator=(const GlObject&) = delete;
+
+    unsigned int id() const { return m_id; }
+    explicit operator bool() const { return m_id != 0; }
+
+    // Deletes the object, or hands it back to gpuPool() if it came from there
+    void reset();
+
+private:
+    friend class GpuPool;
+
+    unsigned int m_id = 0;
+    bool m_pooled = false;
+};
+
+using GlVertexArray = GlObject<GlObjectType::VertexArray>;
+using GlFramebuffer = GlObject<GlObjectType::Framebuffer>;
+using GlRenderbuffer = GlObject<GlObjectType::Renderbuffer>;
+using GlTexture = GlObject<GlObjectType::Texture>;
+
+// Buffer object that also knows the size of its storage
+class GlBuffer {
+public:
+    GlBuffer() = default;
+    explicit GlBuffer(const char* label);
+    ~GlBuffer() { reset(); }
+
+    GlBuffer(GlBuffer&& other) noexcept;
+    GlBuffer& operator=(GlBuffer&& other) noexcept;
+    GlBuffer(const GlBuffer&) = delete;
+    GlBuffer& operator=(const GlBuffer&) = delete;
+
+    unsigned int id() const { return m_id; }
+    explicit operator bool() const { return m_id != 0; }
+    size_t size() const { return m_size; }
+
+    // Binds the buffer to `target` and (re)creates its storage with glBufferData
+    void allocate(unsigned int target, size_t bytes, const void* data, unsigned int usage);
+    // Binds the buffer to `target` and writes `bytes` at `offset`
+    void write(unsigned int target, size_t offset, size_t bytes, const void* data);
+
+    void reset();
+
+private:
+    friend class GpuPool;
+
+    unsigned int m_id = 0;
+    size_t m_size = 0;
+    bool m_pooled = false;
+};
+
+// Every live GL object created through the handles above
+class GlObjectRegistry {
+public:
+    struct Entry {
+        GlObjectType type;
+        unsigned int id;
+        size_t bytes;
+        const char* label;
+        bool pooled;  // idle in gpuPool()
+    };
+
+    struct Totals {
+        uint32_t live[(size_t)GlObjectType::Count] = {};
+        uint32_t pooled[(size_t)GlObjectType::Count] = {};
+        uint64_t bufferBytes = 0;  // including pooled buffers
+        uint64_t pooledBytes = 0;
+    };
+
+    void add(GlObjectType type, unsigned int id, const char* label);
+    void remove(GlObjectType type, unsigned int id);
+    void setBytes(GlObjectType type, unsigned int id, size_t bytes);
+    void setPooled(GlObjectType type, unsigned int id, bool pooled, const char* label);
+
+    const Totals& totals() const { return m_totals; }
+    size_t size() const { return m_entries.size(); }
+
+    // Live objects sorted by type, then largest first
+    void list(std::vector<Entry>& entries) const;
+
+private:
+    static uint64_t key(GlObjectType type, unsigned int id) { return (uint64_t)type << 32 | id; }
+
+    std::unordered_map<uint64_t, Entry> m_entries;
+    Totals m_totals;
+};
+
+GlObjectRegistry& gpuObjects();
+
+// Recycles buffers and vertex arrays instead of deleting them. Buffers are
+// kept by power-of-two size class, so a buffer acquired for n bytes may be
+// larger, and writing with glBufferSubData reuses its storage without a
+// reallocation in the driver. Vertex arrays come back with every attribute
+// disabled. Idle objects beyond the limits are deleted.
+class GpuPool {
+public:
+    static const size_t kMinBufferClass = 256;
+    static const size_t kMaxIdlePerClass = 16;
+    static const size_t kMaxIdleBytes = 64u << 20;
+
+    struct Stats {
+        uint64_t acquired = 0;
+        uint64_t reused = 0;
+        uint64_t released = 0;
+        uint64_t deleted = 0;  // released past the limits
+    };
+
+    // A buffer of at least `bytes` with storage already allocated, bound to
+    // `target`; its size() is the whole size class
+    GlBuffer acquireBuffer(unsigned int target, size_t bytes, unsigned int usage, const char* label);
+    GlVertexArray acquireVertexArray(const char* label);
+
+    // Deletes every idle object; call before the GL context goes away
+    void clear();
+
+    const Stats& stats() const { return m_stats; }
+
+private:
+    friend class GlBuffer;
+    template <GlObjectType> friend class GlObject;
+
+    void releaseBuffer(unsigned int id, size_t bytes);
+    void releaseVertexArray(unsigned int id);
+
+    std::vector<std::vector<unsigned int>> m_buffers;  // by log2 size class
+    std::vector<unsigned int> m_vertexArrays;
+    size_t m_idleBytes = 0;
+    Stats m_stats;
+};
+
+GpuPool& gpuPool();
+
+// Table of live and pooled objects and bytes by type, with the largest
+// objects listed below. Expects to be called between ImGui::Begin and End.
+void drawGpuResourcesImGui();
@@ -0,0 +1,5 @@
+#pragma once
+
+// Writes an uncompressed 32-bit TGA. Pixels are RGBA, bottom row first, which
+// is the order glReadPixels returns them in.
+bool writeTga(const char* path, int width, int height, const unsigned char* rgba);
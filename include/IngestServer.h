@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include "SpscRing.h"
+#include "StateSample.h"
+
+// Background thread receiving StatePackets on a localhost UDP port or a Unix
+// domain datagram socket. Datagrams are read in batches (recvmmsg on Linux),
+// decoded, and pushed into a bounded queue the render loop drains once per
+// frame. Unix sockets are not available on Windows.
+class IngestServer {
+public:
+    enum class Transport { Udp, Unix };
+
+    // Snapshot of the running totals
+    struct Counters {
+        uint64_t packets = 0;
+        uint64_t samples = 0;
+        uint64_t lostPackets = 0;    // gaps in the sequence numbers
+        uint64_t queueDrops = 0;     // samples rejected because the queue was full
+        uint64_t malformed = 0;      // undecodable, truncated or oversized datagrams
+        double latencyMs = 0.0;      // smoothed sample age when decoded
+        double maxLatencyMs = 0.0;   // worst age since the last resetPeak()
+    };
+
+    explicit IngestServer(uint32_t queueCapacity = 1 << 16);
+    ~IngestServer();
+
+    IngestServer(const IngestServer&) = delete;
+    IngestServer& operator=(const IngestServer&) = delete;
+
+    // `address` is a port number for UDP and a filesystem path for Unix sockets
+    bool start(Transport transport, const char* address, std::string& error);
+    void stop();
+    bool isRunning() const { return m_running.load(std::memory_order_relaxed); }
+
+    // Consumer side: calls fn(const StateSample&) for up to `maxItems` queued samples
+    template <typename Fn>
+    size_t drain(Fn&& fn, size_t maxItems = SIZE_MAX) { return m_queue.drain(fn, maxItems); }
+
+    Counters counters() const;
+    void resetPeak() { m_maxLatencyMs.store(0.0, std::memory_order_relaxed); }
+
+private:
+    void run();
+    void handleDatagram(const unsigned char* data, size_t size);
+
+    std::unique_ptr<unsigned char[]> m_queueMemory;
+    SpscRing<StateSample> m_queue;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    intptr_t m_socket;
+    std::string m_unixPath;
+
+    bool m_haveSequence;
+    uint32_t m_nextSequence;
+
+    std::atomic<uint64_t> m_packets, m_samples, m_lostPackets, m_malformed;
+    std::atomic<double> m_latencyMs, m_maxLatencyMs;
+};
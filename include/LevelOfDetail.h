@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Radius in pixels of a sphere of `radius` at `distance` from the camera,
+// for a perspective projection with vertical field of view `fovY` (radians)
+// onto a viewport `viewportHeight` pixels tall
+float projectedRadiusPixels(float radius, float distance, float fovY, float viewportHeight);
+
+// Picks a level of detail per object from its projected size. Level 0 is the
+// finest. An object only moves to a finer level once it is `hysteresis` above
+// that level's threshold, and to a coarser one once it is the same fraction
+// below its current threshold, so objects near a threshold do not pop back
+// and forth as the camera moves.
+class LodSelector {
+public:
+    // minPixels[i] is the smallest projected radius that uses level i, in
+    // decreasing order; triangles[i] is that level's triangle count
+    LodSelector(std::vector<float> minPixels, std::vector<uint32_t> triangles, float hysteresis = 0.15f);
+
+    size_t levelCount() const { return m_minPixels.size(); }
+    uint32_t triangles(unsigned int level) const { return m_triangles[level]; }
+
+    // Level for an object of `pixels` radius that currently uses `current`
+    unsigned int choose(float pixels, unsigned int current) const;
+
+    // Chooses levels for `count` objects in place, then, while the total is
+    // over `budget` triangles, coarsens the smallest objects first, one level
+    // at a time. Returns the total; it can stay over budget if every object is
+    // already at the coarsest level.
+    uint64_t select(const float* pixels, unsigned int* levels, size_t count, uint64_t budget);
+
+private:
+    std::vector<float> m_minPixels;
+    std::vector<uint32_t> m_triangles;
+    float m_hysteresis;
+    std::vector<uint32_t> m_order;  // scratch, by increasing size
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "GpuResources.h"
+#include "RenderQueue.h"
+#include "Shader.h"
+
+// Draws the Majorana stars of a spin-j state as points on the sphere, all of
+// them one instanced draw of a single point with the star as its attribute
+class MajoranaConstellation {
+public:
+    MajoranaConstellation();
+
+    // Takes the stars in Bloch coordinates, as MajoranaSolver writes them
+    void update(const std::vector<glm::vec3>& stars);
+
+    // Submits one packet for the state_vector shader
+    void submit(RenderQueue& queue, const Shader& shader, const glm::mat4& model, const glm::vec3& color) const;
+
+    unsigned int count() const { return m_count; }
+
+private:
+    GlVertexArray m_VAO;
+    GlBuffer m_VBO;
+    std::vector<glm::vec3> m_scene;
+    unsigned int m_count;
+};
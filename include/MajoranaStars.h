@@ -0,0 +1,57 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Amplitudes c_m of a spin-j state in the |j, m> basis along Bloch z, from
+// m = j down to m = -j, so 2j + 1 of them
+using SpinAmplitudes = std::vector<std::complex<double>>;
+
+// Spin coherent state of spin twoJ / 2 pointing at polar angle `theta` and
+// azimuth `phi`; twoJ = 1 is the qubit state at those angles
+void coherentSpinState(unsigned int twoJ, double theta, double phi, SpinAmplitudes& state);
+// One-axis twisting, exp(-i mu Jz^2): spreads a coherent state into squeezed
+// and then cat-like states
+void twistSpinState(SpinAmplitudes& state, double mu);
+
+// Majorana stars of spin-j states: the 2j roots of
+//
+//   P(z) = sum_m (-1)^(j-m) sqrt(C(2j, j-m)) c_m z^(j+m)
+//
+// taken to the sphere by z = tan(theta / 2) e^(i phi), with the roots lost
+// when the degree drops placed at the south pole. A coherent state has all 2j
+// stars at its own direction, and is recognised by its spin expectation
+// rather than solved for. Roots are found together by Aberth-Ehrlich
+// iteration, two at a time with SSE2 where available, starting from the
+// previous call's roots when the degree has not changed, so a slowly moving
+// state needs only a few iterations per frame.
+class MajoranaSolver {
+public:
+    struct Stats {
+        unsigned int iterations = 0;
+        bool converged = false;
+        bool warmStart = false;
+    };
+
+    // Writes 2j unit vectors in Bloch coordinates to `stars`
+    void solve(const SpinAmplitudes& state, std::vector<glm::vec3>& stars);
+    // Forgets the previous roots
+    void reset();
+
+    const Stats& stats() const { return m_stats; }
+
+private:
+    void iterate();
+
+    // Monic polynomial being solved, coefficient k of z^k, and its roots, all
+    // split into real and imaginary parts
+    std::vector<double> m_coefRe, m_coefIm, m_coefAbs;
+    std::vector<double> m_rootRe, m_rootIm;
+    std::vector<double> m_ratioRe, m_ratioIm;  // p / p' at each root
+    std::vector<double> m_stepRe, m_stepIm;
+    std::vector<unsigned char> m_settled;  // |p| at rounding level, not moved
+    unsigned int m_zeros = 0;  // roots at z = 0, the north pole
+    Stats m_stats;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+#include "GpuResources.h"
+
+// Framebuffer object with an RGBA8 color and a depth renderbuffer, used to
+// render images that are larger than or independent of the window.
+class OffscreenTarget {
+public:
+    OffscreenTarget(int width, int height);
+
+    bool isComplete() const { return m_complete; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    // Binds the framebuffer and sets the viewport to cover it
+    void bind() const;
+    void unbind() const;
+
+    // Reads back the color attachment as RGBA, bottom row first
+    void readPixels(std::vector<unsigned char>& rgba) const;
+
+    // Largest width/height the driver accepts for a render target
+    static int maxSize();
+
+private:
+    GlFramebuffer m_FBO;
+    GlRenderbuffer m_colorRBO, m_depthRBO;
+    int m_width, m_height;
+    bool m_complete;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Number of worker threads parallelFor splits work across
+inline unsigned int workerCount()
+{
+    unsigned int count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+// Splits [0, count) into at most workerCount() contiguous chunks of at least
+// `minChunk` items and calls fn(begin, end, worker) for each one, with worker
+// in [0, workerCount()). The calling thread runs the first chunk itself.
+// `minChunk` should be enough work to pay for starting a thread.
+template <typename Fn>
+void parallelFor(size_t count, size_t minChunk, Fn&& fn)
+{
+    if (count == 0)
+        return;
+
+    size_t workers = std::min<size_t>(workerCount(), (count + minChunk - 1) / std::max<size_t>(minChunk, 1));
+    workers = std::max<size_t>(workers, 1);
+    size_t chunk = (count + workers - 1) / workers;
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t w = 1; w < workers; ++w) {
+        size_t begin = w * chunk;
+        size_t end = std::min(count, begin + chunk);
+        if (begin >= end)
+            break;
+        threads.emplace_back([&fn, begin, end, w]() { fn(begin, end, static_cast<unsigned int>(w)); });
+    }
+    fn(0, std::min(count, chunk), 0u);
+
+    for (std::thread& thread : threads)
+        thread.join();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "BlochDynamics.h"
+
+enum class SweepParameter {
+    Theta,      // initial polar angle, degrees
+    Phi,        // initial azimuthal angle, degrees
+    Detuning,   // drive detuning, radians per unit time
+    Noise,      // dephasing rate 1/T2, per unit time
+    Count
+};
+
+const char* sweepParameterName(SweepParameter parameter);
+
+struct SweepAxis {
+    SweepParameter parameter;
+    float min;
+    float max;
+    unsigned int count;
+
+    // Evenly spaced over [min, max], endpoints included
+    float valueAt(unsigned int index) const;
+};
+
+struct SweepSettings {
+    SweepAxis columns = { SweepParameter::Phi, 0.0f, 360.0f, 16 };
+    SweepAxis rows = { SweepParameter::Theta, 0.0f, 180.0f, 16 };
+
+    // Values used for every parameter that is not swept
+    float theta = 0.0f;
+    float phi = 0.0f;
+    BlochEquationParams dynamics;
+    float duration = 0.0f;
+    unsigned int steps = 100;
+};
+
+// One tile of a sweep sheet. The layout matches the per-instance vertex
+// attributes of the sheet renderer so results upload without repacking.
+struct SweepCell {
+    glm::vec3 bloch;
+    float purity;
+};
+
+// Evolves one initial state per grid cell across all cores. Cells are stored
+// row-major, cell (row, column) at index row * columns + column.
+class ParameterSweep {
+public:
+    void run(const SweepSettings& settings);
+
+    const std::vector<SweepCell>& cells() const { return m_cells; }
+    unsigned int columns() const { return m_columns; }
+    unsigned int rows() const { return m_rows; }
+    double elapsedMs() const { return m_elapsedMs; }
+
+private:
+    std::vector<SweepCell> m_cells;
+    unsigned int m_columns = 0;
+    unsigned int m_rows = 0;
+    double m_elapsedMs = 0.0;
+};
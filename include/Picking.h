@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;  // unit length
+};
+
+// Ray from the near plane through a window position, given in pixels from
+// the top left of a `viewport`-sized window as mouse coordinates are
+Ray rayFromScreen(const glm::mat4& viewProjection, const glm::vec2& pixel, const glm::vec2& viewport);
+
+// Distance along the ray to where it enters the sphere; false if it misses or
+// the sphere is behind the origin
+bool intersectSphere(const Ray& ray, const glm::vec3& center, float radius, float& distance);
+
+struct BoundingSpheres;
+
+// Bounding volume hierarchy over spheres for ray picking: boxes split at the
+// median of their longest axis down to a few spheres per leaf, stored flat
+// with each node's first child right after it. A ray query visits the nearer
+// child first and skips boxes beyond the closest hit so far, so picking one
+// of thousands of spheres tests a few dozen boxes.
+class SphereBvh {
+public:
+    void build(const BoundingSpheres& spheres);
+    void clear();
+
+    size_t size() const { return m_spheres.size(); }
+
+    // Index of the sphere the ray enters first and the distance to it; false
+    // if it hits none
+    bool intersect(const Ray& ray, uint32_t& index, float& distance) const;
+    // Boxes and spheres tested by the last intersect
+    uint32_t lastTests() const { return m_lastTests; }
+
+private:
+    struct Node {
+        glm::vec3 lower, upper;
+        uint32_t first;  // leaf: first sphere; inner: second child
+        uint32_t count;  // spheres in a leaf, 0 for inner nodes
+    };
+    struct Sphere {
+        glm::vec3 center;
+        float radius;
+        uint32_t index;
+    };
+
+    uint32_t buildNode(uint32_t begin, uint32_t end);
+
+    std::vector<Node> m_nodes;
+    std::vector<Sphere> m_spheres;  // in leaf order
+    mutable uint32_t m_lastTests = 0;
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-frame CPU and GPU timings for named scopes. CPU scopes nest freely;
+// GPU scopes use GL_TIME_ELAPSED queries, which cannot nest, so a GPU scope
+// opened inside another one is timed on the CPU only. Queries are double
+// buffered and read back two frames later, so the GPU column of the newest
+// frames fills in late instead of stalling the pipeline.
+class Profiler {
+public:
+    static const size_t kMaxScopes = 32;
+    static const size_t kHistory = 240;
+
+    struct Scope {
+        const char* name;
+        double startMs;  // CPU start, relative to the frame start
+        double cpuMs;
+        double gpuMs;    // negative until the query result arrives, or if not timed
+        int depth;
+        int query;       // index into the frame's query set, -1 for CPU only
+    };
+
+    struct Frame {
+        uint64_t index = 0;
+        double startMs = 0.0;  // since the profiler was created
+        double cpuMs = 0.0;
+        double gpuMs = 0.0;    // sum of the GPU scopes that have arrived
+        uint32_t drawCalls = 0;
+        uint32_t cullTested = 0;
+        uint32_t culled = 0;
+        uint32_t occluded = 0;
+        uint64_t heapAllocations = 0;  // operator new calls on the profiling thread
+        size_t arenaBytes = 0;         // frame arena use at the end of the frame
+        size_t scopeCount = 0;
+        std::array<Scope, kMaxScopes> scopes;
+    };
+
+    Profiler();
+    // Calls shutdown(), so it must also run while the GL context is current
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    void beginFrame();
+    void endFrame();
+    // Deletes the GPU queries; call before the GL context goes away. Scopes
+    // are timed on the CPU only afterwards.
+    void shutdown();
+
+    // Returns an id for endScope, or -1 if the frame is out of scope slots
+    int beginScope(const char* name, bool gpu);
+    void endScope(int id);
+
+    bool isPaused() const { return m_paused; }
+    void setPaused(bool paused) { m_paused = paused; }
+
+    // Completed frames, oldest first; index 0 is at most kHistory frames back
+    size_t frameCount() const;
+    const Frame& frame(size_t i) const;
+
+    // Graph of the recent frames and a flame view of the selected one.
+    // Expects to be called between ImGui::Begin and ImGui::End.
+    void drawImGui();
+
+    // Writes the last `frames` completed frames in the Chrome trace event
+    // format (chrome://tracing, Perfetto). CPU scopes go on one track and GPU
+    // scopes on another, placed at the time their commands were submitted.
+    bool exportChromeTrace(const char* path, size_t frames, std::string& error) const;
+
+private:
+    Frame& current() { return m_history[m_frameIndex % kHistory]; }
+    // With `final` set, results that have not arrived are given up on
+    void collectQueries(uint64_t frameIndex, bool final);
+    double nowMs() const;
+
+    std::chrono::steady_clock::time_point m_origin;
+    std::vector<Frame> m_history;
+    uint64_t m_frameIndex;
+    bool m_inFrame;
+    bool m_paused;
+    int m_openScopes[kMaxScopes];
+    int m_depth;
+    int m_gpuOpen;
+    uint64_t m_frameAllocations;
+    unsigned int m_queries[2][kMaxScopes];
+    bool m_queriesLive;
+    int m_selected;
+    int m_exportFrames;
+    std::string m_exportStatus;
+};
+
+// Times the enclosing block as one scope
+class ProfileScope {
+public:
+    ProfileScope(Profiler& profiler, const char* name, bool gpu = false)
+        : m_profiler(profiler), m_id(profiler.beginScope(name, gpu)) {}
+    ~ProfileScope() { m_profiler.endScope(m_id); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler& m_profiler;
+    int m_id;
+};
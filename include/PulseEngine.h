@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Shaped microwave pulses in the rotating frame. The drive has in-phase and
+// quadrature parts (I, Q) in radians per unit time, so with detuning D the
+// Bloch vector precesses about (I, Q, D), the convention of evolveBloch.
+// Propagators are unit quaternions q = (w, x, y, z) standing for
+// w - i (x X + y Y + z Z), as in GateSynthesis.
+
+enum class PulseShape : uint8_t {
+    Square,
+    Gaussian,  // shifted to zero at both ends
+    Drag,      // Gaussian with the derivative added in quadrature
+    Count
+};
+
+enum class PulseIntegrator : uint8_t {
+    // The envelope held at its midpoint value over each sample, each sample
+    // an exact SU(2) exponential
+    PiecewiseConstant,
+    // Fourth-order Magnus step per sample from the envelope at two Gauss
+    // points, which follows a smooth envelope and a turning drive axis
+    Magnus4,
+    Count
+};
+
+const char* pulseShapeName(PulseShape shape);
+const char* pulseIntegratorName(PulseIntegrator integrator);
+
+struct PulseSettings {
+    PulseShape shape = PulseShape::Gaussian;
+    PulseIntegrator integrator = PulseIntegrator::Magnus4;
+    unsigned int samples = 10000;
+    double duration = 1.0;
+    double angle = 3.14159265358979323846;  // area of the envelope, radians
+    double phase = 0.0;      // drive axis, radians from X towards Y
+    double sigma = 0.25;     // Gaussian width as a fraction of the duration
+    double dragBeta = 0.0;   // quadrature = dragBeta * d(in-phase)/dt
+    double detuning = 0.0;   // radians per unit time
+
+    bool operator==(const PulseSettings& other) const;
+    bool operator!=(const PulseSettings& other) const { return !(*this == other); }
+};
+
+// Rotation by |v| radians about v, exp(-i/2 v.sigma); small angles use a
+// series in |v|^2 with no trigonometry
+glm::dquat rotationQuaternion(const glm::dvec3& v);
+
+// Per-sample propagator cache of a pulse. Building computes every sample's
+// propagator and their running products, after which the state at any
+// sample of any repetition is one quaternion rotation, and a whole pulse one
+// more: playing, scrubbing and repeating a pulse never integrate it again.
+// prepare() only rebuilds when the settings change.
+class PulseEngine {
+public:
+    struct Stats {
+        uint64_t builds = 0;
+        uint64_t reuses = 0;       // prepare() calls answered from the cache
+        double buildMicros = 0.0;  // last build
+    };
+
+    // True if the propagators had to be rebuilt
+    bool prepare(const PulseSettings& settings);
+    // Propagators of a sampled waveform held constant over each `dt`
+    void build(const glm::dvec2* samples, size_t count, double dt, double detuning);
+
+    size_t samples() const { return m_steps.size(); }
+    double sampleTime() const { return m_dt; }
+    const glm::dquat& step(size_t k) const { return m_steps[k]; }
+    // Product of the first k sample propagators, 0 <= k <= samples()
+    const glm::dquat& upTo(size_t k) const { return m_prefix[k]; }
+    const glm::dquat& total() const { return m_prefix.back(); }
+
+    // The pulse applied `repeats` times
+    glm::vec3 apply(const glm::vec3& bloch, unsigned int repeats = 1) const;
+    // State after `k` samples of repetition `repeat` (from 0)
+    glm::vec3 stateAt(const glm::vec3& bloch, unsigned int repeat, size_t k) const;
+    // Every `stride`-th state through `repeats` repetitions, the start and the
+    // end always included
+    void trajectory(const glm::vec3& bloch, unsigned int repeats, size_t stride, std::vector<glm::vec3>& points) const;
+
+    const Stats& stats() const { return m_stats; }
+
+private:
+    void buildMagnus(const PulseSettings& settings);
+    void accumulate();
+
+    PulseSettings m_settings;
+    bool m_built = false;
+    double m_dt = 0.0;
+    std::vector<glm::dvec2> m_drive;  // scratch envelope values
+    std::vector<glm::dquat> m_steps;
+    std::vector<glm::dquat> m_prefix;
+    Stats m_stats;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+enum class QuasiProbabilityKind { Husimi, Wigner };
+
+// Quasi-probability distributions on the sphere for the spin-j state made of
+// 2j copies of the qubit with Bloch vector `bloch` (rho^(2j) on the symmetric
+// subspace), so j = 1/2 is the qubit itself and a pure qubit gives a spin
+// coherent state. That state is symmetric about the Bloch vector, so each
+// distribution is a Legendre series in r.n:
+//
+//   f(n) = sum_k a_k P_k(r.n),  k = 0 .. 2j
+//
+// which is the spherical harmonic expansion of f with the m != 0 terms
+// rotated away. Both are normalized to 1 over the sphere; the Wigner function
+// can go negative.
+struct QuasiProbabilitySeries {
+    glm::vec3 axis = glm::vec3(0.0f, 0.0f, 1.0f);  // unit Bloch direction
+    std::vector<float> coefficients;                // a_k
+
+    float evaluate(const glm::vec3& direction) const;
+    // Smallest and largest value over the sphere
+    void range(float& low, float& high) const;
+};
+
+// Largest 2j whose 3j symbols stay within double range; beyond it the
+// factorial products in wigner3j overflow
+const unsigned int kMaxQuasiTwoJ = 62;
+
+// twoJ is 2j, clamped to [1, kMaxQuasiTwoJ]
+QuasiProbabilitySeries quasiProbabilitySeries(QuasiProbabilityKind kind, const glm::vec3& bloch, unsigned int twoJ);
+
+// Wigner 3j symbol with every argument doubled, so half-integers are exact;
+// NaN once j1 + j2 + j3 passes 169, the largest the factorials reach
+double wigner3j(int twoJ1, int twoJ2, int twoJ3, int twoM1, int twoM2, int twoM3);
+
+// A series evaluated on a latitude/longitude grid in Bloch coordinates: row 0
+// is the +z pole, rows step down in polar angle through pixel centres, and
+// columns step through the azimuth from x towards y. Every value depends on
+// the whole series, so a new series makes every row stale; each row remembers
+// the series it was computed from so the recomputation can be spread over
+// several update() calls and only the rows it touched are uploaded. Rows are
+// split across threads and evaluated four columns at a time with SSE where
+// available.
+class QuasiProbabilityGrid {
+public:
+    QuasiProbabilityGrid(unsigned int width = 256, unsigned int height = 128);
+
+    void resize(unsigned int width, unsigned int height);
+    // Marks every row whose series differs from `series` for recomputation
+    void setSeries(const QuasiProbabilitySeries& series);
+    // Recomputes at most `maxRows` stale rows, nearest the top first, and
+    // returns how many it did
+    unsigned int update(unsigned int maxRows = ~0u);
+
+    unsigned int width() const { return m_width; }
+    unsigned int height() const { return m_height; }
+    // width() * height() values, row by row
+    const std::vector<float>& values() const { return m_values; }
+    const QuasiProbabilitySeries& series() const { return m_series; }
+    // Rows still computed from an older series
+    unsigned int staleRows() const;
+
+    // Rows [first, end) recomputed since the last call; false if none were
+    bool takeDirtyRows(unsigned int& first, unsigned int& end);
+
+private:
+    void computeRow(unsigned int row);
+
+    unsigned int m_width, m_height;
+    std::vector<float> m_values;
+    std::vector<float> m_cosPhi, m_sinPhi;
+    QuasiProbabilitySeries m_series;
+    uint64_t m_version;
+    std::vector<uint64_t> m_rowVersions;  // series version each row holds
+    std::vector<unsigned int> m_stale;    // scratch
+    unsigned int m_dirtyFirst, m_dirtyEnd;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "GpuResources.h"
+#include "QuasiProbability.h"
+#include "Shader.h"
+#include "Sphere.h"
+
+// Shades a QuasiProbabilityGrid onto a solid sphere just inside the
+// wireframe, from a float texture that only receives the recomputed rows
+class QuasiProbabilityMap {
+public:
+    QuasiProbabilityMap();
+
+    // Sends the rows recomputed since the last upload, or the whole grid if
+    // its size changed. Returns the rows sent.
+    unsigned int upload(QuasiProbabilityGrid& grid);
+
+    // Draws with density.vert and quasi.frag: a blue-white-red scale when the
+    // series can go negative, viridis otherwise
+    void draw(const Shader& shader, const glm::mat4& view, const glm::mat4& projection, const glm::mat4& model) const;
+
+private:
+    Sphere m_sphere;
+    GlTexture m_texture;
+    unsigned int m_width, m_height;
+    float m_low, m_high;
+};
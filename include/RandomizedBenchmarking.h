@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Gates.h"
+
+// A single-qubit Clifford as the rotation it makes of the Bloch sphere, which
+// permutes the axes with signs: component i of the image is
+// sign[i] * r[axis[i]].
+struct CliffordRotation {
+    uint8_t axis[3];
+    int8_t sign[3];
+
+    constexpr bool operator==(const CliffordRotation& other) const
+    {
+        return axis[0] == other.axis[0] && axis[1] == other.axis[1] && axis[2] == other.axis[2] &&
+               sign[0] == other.sign[0] && sign[1] == other.sign[1] && sign[2] == other.sign[2];
+    }
+
+    glm::vec3 apply(const glm::vec3& bloch) const
+    {
+        return glm::vec3(sign[0] * bloch[axis[0]], sign[1] * bloch[axis[1]], sign[2] * bloch[axis[2]]);
+    }
+    BlochChannel channel() const;
+};
+
+// `second` applied after `first`, as compose() for channels
+constexpr CliffordRotation composeClifford(const CliffordRotation& first, const CliffordRotation& second)
+{
+    CliffordRotation result = {};
+    for (int i = 0; i < 3; ++i) {
+        result.axis[i] = first.axis[second.axis[i]];
+        result.sign[i] = (int8_t)(second.sign[i] * first.sign[second.axis[i]]);
+    }
+    return result;
+}
+
+// The 24 elements of the single-qubit Clifford group up to phase, generated
+// from H and S breadth-first so element 0 is the identity and elements come
+// in order of their shortest H/S word.
+struct CliffordTable {
+    static constexpr unsigned int kCount = 24;
+
+    CliffordRotation elements[kCount];
+    uint8_t wordLength[kCount];       // H and S gates in the shortest word
+    uint8_t product[kCount][kCount];  // product[a][b]: b applied after a
+    uint8_t inverse[kCount];
+};
+
+constexpr CliffordTable makeCliffordTable()
+{
+    constexpr CliffordRotation identity = { { 0, 1, 2 }, { 1, 1, 1 } };
+    constexpr CliffordRotation generators[2] = {
+        { { 2, 1, 0 }, { 1, -1, 1 } },  // H: x <-> z, y -> -y
+        { { 1, 0, 2 }, { -1, 1, 1 } },  // S: x -> y, y -> -x
+    };
+
+    CliffordTable table = {};
+    table.elements[0] = identity;
+    unsigned int count = 1;
+    for (unsigned int next = 0; next < count; ++next) {
+        for (const CliffordRotation& generator : generators) {
+            CliffordRotation element = composeClifford(table.elements[next], generator);
+            bool known = false;
+            for (unsigned int i = 0; i < count; ++i)
+                known = known || table.elements[i] == element;
+            if (!known && count < CliffordTable::kCount) {
+                table.elements[count] = element;
+                table.wordLength[count] = (uint8_t)(table.wordLength[next] + 1);
+                ++count;
+            }
+        }
+    }
+
+    for (unsigned int a = 0; a < CliffordTable::kCount; ++a) {
+        for (unsigned int b = 0; b < CliffordTable::kCount; ++b) {
+            CliffordRotation element = composeClifford(table.elements[a], table.elements[b]);
+            for (unsigned int i = 0; i < CliffordTable::kCount; ++i) {
+                if (table.elements[i] == element)
+                    table.product[a][b] = (uint8_t)i;
+            }
+            if (table.product[a][b] == 0)
+                table.inverse[a] = (uint8_t)b;
+        }
+    }
+    return table;
+}
+
+inline constexpr CliffordTable kCliffords = makeCliffordTable();
+
+static_assert(kCliffords.wordLength[CliffordTable::kCount - 1] > 0, "H and S must generate all 24 Cliffords");
+static_assert(kCliffords.product[5][kCliffords.inverse[5]] == 0 && kCliffords.product[kCliffords.inverse[17]][17] == 0,
+              "Clifford inverses must cancel on both sides");
+
+// Uniformly random Cliffords followed by the one that undoes them, so an
+// ideal run returns to its initial state; `sequence` gets length + 1 indices
+// into kCliffords
+void randomCliffordSequence(uint64_t seed, unsigned int length, std::vector<uint8_t>& sequence);
+
+struct RbSettings {
+    unsigned int maxLength = 300;    // random Cliffords in the longest sequences
+    unsigned int lengthCount = 16;   // lengths, log-spaced from 1 to maxLength
+    unsigned int sequences = 1000;   // random sequences per length
+    uint64_t seed = 1;
+
+    // Noise after every Clifford, the recovery included
+    float depolarizing = 0.01f;
+    float dephasing = 0.0f;
+    float amplitudeDamping = 0.0f;
+    float overRotation = 0.0f;  // coherent error about X, radians
+
+    BlochChannel noise() const;
+};
+
+struct RbPoint {
+    unsigned int length;
+    double survival;      // mean probability of measuring |0> at the end
+    double spread;        // standard deviation of the survival over sequences
+    glm::vec3 meanBloch;  // final Bloch vector averaged over sequences
+};
+
+// Survival fitted as amplitude * decay^length + offset
+struct RbFit {
+    double decay = 0.0;
+    double amplitude = 0.0;
+    double offset = 0.0;
+    double errorPerClifford = 0.0;  // (1 - decay) / 2
+};
+
+// Runs every sequence from |0> across all cores. Each noisy Clifford is one
+// affine map, its rotation folded into the noise channel, and the running
+// product is tracked through the table, so a step costs a 3x3 multiply.
+// Results do not depend on the number of threads.
+class RandomizedBenchmark {
+public:
+    void run(const RbSettings& settings);
+
+    const std::vector<RbPoint>& points() const { return m_points; }
+    const RbFit& fit() const { return m_fit; }
+    uint64_t cliffords() const { return m_cliffords; }  // applied in the last run
+    double elapsedMs() const { return m_elapsedMs; }
+
+private:
+    void fitDecay();
+
+    std::vector<RbPoint> m_points;
+    RbFit m_fit;
+    uint64_t m_cliffords = 0;
+    double m_elapsedMs = 0.0;
+};
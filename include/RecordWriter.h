@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <glm/glm.hpp>
+
+// One sample of a simulated circuit. In the binary format every field is
+// stored little-endian in declaration order, 40 bytes per record.
+struct BlochRecord {
+    uint32_t circuit;
+    uint32_t step;
+    float x, y, z;
+    float alphaRe, alphaIm;
+    float betaRe, betaIm;
+    float purity;
+};
+static_assert(sizeof(BlochRecord) == 40, "BlochRecord must stay packed");
+
+// Fills the amplitudes and purity of a record from its Bloch vector
+BlochRecord makeRecord(uint32_t circuit, uint32_t step, const glm::vec3& bloch);
+
+// Buffered writer for BlochRecords. Formatting goes straight into a fixed
+// buffer that is flushed with a single fwrite when full, so writing a record
+// never allocates.
+class RecordWriter {
+public:
+    enum class Format { Csv, Binary };
+
+    RecordWriter(FILE* file, Format format);
+    ~RecordWriter();
+
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    void writeHeader();
+    void write(const BlochRecord& record);
+    bool flush();
+
+    uint64_t recordCount() const { return m_records; }
+    bool failed() const { return m_failed; }
+
+private:
+    static const size_t kBufferSize = 1 << 20;
+    // Longest CSV line: two integers and eight floats with separators
+    static const size_t kMaxRecordSize = 256;
+
+    void writeCsv(const BlochRecord& record);
+    void writeBinary(const BlochRecord& record);
+
+    FILE* m_file;
+    Format m_format;
+    char* m_buffer;
+    size_t m_used;
+    uint64_t m_records;
+    bool m_failed;
+};
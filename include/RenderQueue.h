@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Shader;
+
+// Fixed-function state a packet needs; the queue only changes what differs
+// from the previous packet
+struct RenderState {
+    bool wireframe = false;
+    float lineWidth = 1.0f;
+    float pointSize = 1.0f;
+
+    bool operator==(const RenderState& other) const
+    {
+        return wireframe == other.wireframe && lineWidth == other.lineWidth && pointSize == other.pointSize;
+    }
+    bool operator!=(const RenderState& other) const { return !(*this == other); }
+};
+
+// One draw call with everything needed to issue it. Shaders get the camera
+// matrices as `view` and `projection`, the packet's transform as `model`
+// and, if set, its color as `lineColor`.
+struct DrawPacket {
+    const Shader* shader = nullptr;
+    unsigned int vao = 0;
+    unsigned int primitive = 0;  // GL_TRIANGLES, GL_LINES, ...
+    bool indexed = false;        // 32-bit indices from the VAO's element buffer
+    unsigned int first = 0;
+    unsigned int count = 0;
+    unsigned int instances = 1;
+    glm::mat4 model = glm::mat4(1.0f);
+    bool hasColor = false;
+    glm::vec3 color = glm::vec3(1.0f);
+    RenderState state;
+};
+
+// Collects the frame's draw packets, sorts them by program, polygon mode, line
+// width and vertex array, and issues them with every redundant bind, state
+// change and uniform write skipped. Uniform locations are looked up once per
+// program. Packets with equal keys keep their submission order. The queue
+// assumes nothing about GL state at the start of a flush, and leaves the last
+// program, vertex array and state bound.
+class RenderQueue {
+public:
+    struct Stats {
+        uint32_t packets = 0;
+        uint32_t drawCalls = 0;
+        uint32_t programBinds = 0;
+        uint32_t vertexArrayBinds = 0;
+        uint32_t stateChanges = 0;
+        uint32_t uniformUpdates = 0;
+        uint32_t uniformsSkipped = 0;  // writes dropped because the value was already set
+    };
+
+    RenderQueue();
+
+    // Starts a frame with the camera shared by all packets
+    void begin(const glm::mat4& view, const glm::mat4& projection);
+    void submit(const DrawPacket& packet);
+    // Sorts (unless disabled), issues and clears the packets
+    void flush();
+
+    // Without sorting, packets run in submission order; for comparing counts
+    void setSorting(bool sorting) { m_sorting = sorting; }
+    bool sorting() const { return m_sorting; }
+
+    // Counters of the last flush
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct Program {
+        unsigned int id;
+        int view, projection, model, color;
+        // Values last written this frame
+        bool cameraSet;
+        bool modelSet, colorSet;
+        glm::mat4 lastModel;
+        glm::vec3 lastColor;
+    };
+
+    Program& program(unsigned int id);
+    void setCamera(Program& program);
+    void applyState(const RenderState& state);
+
+    glm::mat4 m_view, m_projection;
+    std::vector<DrawPacket> m_packets;
+    std::vector<uint32_t> m_order;
+    std::vector<Program> m_programs;
+    bool m_sorting;
+    Stats m_stats;
+
+    // What the last flush left bound
+    unsigned int m_boundProgram;
+    unsigned int m_boundVertexArray;
+    RenderState m_state;
+    bool m_stateKnown;
+};
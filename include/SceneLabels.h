@@ -0,0 +1,12 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Draws `text` as a borderless ImGui window centred on the screen position of
+// `position`, unless the point is behind the camera. Must be called between
+// ImGui::NewFrame and ImGui::Render.
+void drawSceneLabel(const char* id, const glm::vec3& position, const char* text, const glm::mat4& viewProjection, const glm::vec4& viewport);
+
+// The six basis state labels at the ends of the axes, except those the unit
+// sphere hides from `eye`
+void drawAxisLabels(const glm::mat4& viewProjection, const glm::vec4& viewport, const glm::vec3& eye);
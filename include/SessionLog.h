@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "StateSample.h"
+
+// Recorded viewer sessions (.bses), all fields little-endian:
+//
+//   header  "BSES" | u32 version
+//   record  u8 type | payload
+//
+//   Frame            f64 seconds since the session started
+//   CursorPos        f32 x | f32 y
+//   MouseButton      u8 button | u8 action | u8 mods
+//   Scroll           f32 x | f32 y
+//   Key              i32 key | i32 scancode | u8 action | u8 mods
+//   Char             u32 codepoint
+//   CursorEnter      u8 entered
+//   WindowFocus      u8 focused
+//   FramebufferSize  u32 width | u32 height
+//   State            f64 timestamp | u32 kind | f32 values[4]
+//
+// Every frame starts with a Frame record; the records after it are the
+// states injected by the live feeds and the window events polled during
+// that frame, in the order the viewer handled them. ImGui interactions are
+// reproduced by replaying the same window events.
+
+struct SessionEvent {
+    enum Type : uint8_t {
+        Frame = 0,
+        CursorPos,
+        MouseButton,
+        Scroll,
+        Key,
+        Char,
+        CursorEnter,
+        WindowFocus,
+        FramebufferSize,
+        State
+    };
+
+    Type type = Frame;
+    double x = 0.0, y = 0.0;  // cursor position, scroll offset or framebuffer size
+    int code = 0;             // key, mouse button, codepoint, or the entered/focused flag
+    int scancode = 0;
+    int action = 0;
+    int mods = 0;
+    StateSample sample = {};
+};
+
+// Buffered writer; events are encoded into memory and written in large blocks
+class SessionWriter {
+public:
+    SessionWriter() = default;
+    ~SessionWriter();
+
+    SessionWriter(const SessionWriter&) = delete;
+    SessionWriter& operator=(const SessionWriter&) = delete;
+
+    bool open(const char* path, std::string& error);
+    bool close();
+
+    bool isOpen() const { return m_file != nullptr; }
+    uint64_t frameCount() const { return m_frames; }
+
+    void beginFrame(double time);
+    void write(const SessionEvent& event);
+
+private:
+    bool flush();
+
+    FILE* m_file = nullptr;
+    bool m_failed = false;
+    uint64_t m_frames = 0;
+    std::vector<unsigned char> m_buffer;
+};
+
+class SessionReader {
+public:
+    bool open(const char* path, std::string& error);
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    bool atEnd() const { return m_offset >= m_file.size(); }
+
+    // Reads the next frame's time and events; returns false at the end of the
+    // log or on a truncated record
+    bool readFrame(double& time, std::vector<SessionEvent>& events);
+
+private:
+    MappedFile m_file;
+    size_t m_offset = 0;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <glm/glm.hpp>
 
 class Shader {
@@ -11,9 +12,12 @@ public:
 
     void use() const;
 
-    void setMat4(const std::string &name, const glm::mat4 &mat) const;
-    void setVec3(const std::string &name, const glm::vec3 &value) const;
-    void setFloat(const std::string &name, float value) const;
+    // Uniform names are copied into the frame arena to null-terminate them,
+    // so setting a uniform never allocates
+    void setMat4(std::string_view name, const glm::mat4 &mat) const;
+    void setVec3(std::string_view name, const glm::vec3 &value) const;
+    void setFloat(std::string_view name, float value) const;
+    void setInt(std::string_view name, int value) const;
 private:
     void checkCompileErrors(unsigned int shader, std::string type);
 };
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "SpscRing.h"
+#include "StateSample.h"
+
+// SpscRing of StateSamples in a named shared-memory segment (POSIX shm or a
+// Windows file mapping), used to feed states from another process. The
+// producer creates the segment and removes its name again on close; the
+// consumer opens it by name and keeps its mapping even after that.
+class SharedStateRing {
+public:
+    SharedStateRing() = default;
+    ~SharedStateRing();
+
+    SharedStateRing(const SharedStateRing&) = delete;
+    SharedStateRing& operator=(const SharedStateRing&) = delete;
+
+    // `capacity` is rounded up to a power of two
+    bool create(const char* name, uint32_t capacity, std::string& error);
+    bool open(const char* name, std::string& error);
+    void close();
+
+    bool isOpen() const { return m_memory != nullptr; }
+    SpscRing<StateSample>& ring() { return m_ring; }
+
+private:
+    bool map(const char* name, size_t size, bool create, std::string& error);
+
+    void* m_memory = nullptr;
+    size_t m_size = 0;
+    bool m_owner = false;
+    std::string m_name;
+    SpscRing<StateSample> m_ring;
+#ifdef _WIN32
+    void* m_mapping = nullptr;
+#endif
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+// BLOCH_SSE is defined where SSE2 is always available: x86-64, and 32-bit x86
+// built for it. Code using it keeps a scalar path for everything else.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLOCH_SSE 1
+#include <emmintrin.h>
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+// Fixed-timestep clock. Wall time scaled by the time scale fills an
+// accumulator, and the simulation takes one step of exactly fixedStep() per
+// consumeStep() until it runs dry; what is left over gives alpha() for
+// interpolating the display between the last two steps. Single steps and
+// fast-forward queue steps that run regardless of pause and time scale.
+class SimulationClock {
+public:
+    explicit SimulationClock(double fixedStep = 0.001);
+
+    double fixedStep() const { return m_fixedStep; }
+    void setFixedStep(double seconds);
+
+    // Simulated seconds per wall second
+    double timeScale() const { return m_timeScale; }
+    void setTimeScale(double scale) { m_timeScale = scale < 0.0 ? 0.0 : scale; }
+
+    bool isPaused() const { return m_paused; }
+    void setPaused(bool paused) { m_paused = paused; }
+
+    void singleStep() { ++m_queuedSteps; }
+    void fastForward(double seconds);
+    uint64_t queuedSteps() const { return m_queuedSteps; }
+
+    // Adds wall time. Backlog beyond maxLagSteps steps is dropped so a stall
+    // does not turn into a burst of catch-up steps.
+    void advance(double wallSeconds);
+    void setMaxLagSteps(unsigned int steps) { m_maxLagSteps = steps; }
+
+    // True if a step is due, in which case the step is taken off the queue or
+    // the accumulator and time() moves forward by fixedStep()
+    bool consumeStep();
+
+    // Simulated time of the last completed step
+    double time() const { return m_time; }
+    uint64_t steps() const { return m_steps; }
+
+    // Fraction of the next step already accumulated, in [0, 1)
+    double alpha() const { return m_accumulator / m_fixedStep; }
+
+private:
+    double m_fixedStep;
+    double m_timeScale = 1.0;
+    bool m_paused = false;
+    double m_accumulator = 0.0;
+    double m_time = 0.0;
+    uint64_t m_steps = 0;
+    uint64_t m_queuedSteps = 0;
+    unsigned int m_maxLagSteps = 100000;
+};
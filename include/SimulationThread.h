@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include "BlochDynamics.h"
+#include "SimulationClock.h"
+#include "SpscRing.h"
+#include "StateSample.h"
+#include "TripleBuffer.h"
+
+// Everything the renderer needs from the simulation, published as a whole
+struct SimulationSnapshot {
+    uint64_t step = 0;
+    double time = 0.0;             // simulated time of the last step
+    glm::vec3 bloch = glm::vec3(0.0f, 0.0f, 1.0f);
+    glm::vec3 previousBloch = glm::vec3(0.0f, 0.0f, 1.0f);  // one step earlier
+    uint64_t stateVersion = 0;     // bumped when the simulation moved the state itself
+    std::vector<glm::vec3> trail;  // newest points last, Bloch coordinates
+    uint64_t trailVersion = 0;
+
+    // Clock when the snapshot was published
+    double alpha = 0.0;            // fraction of the next step already accumulated
+    double publishedAt = 0.0;      // steadySeconds()
+    double fixedStep = 0.001;
+    double timeScale = 1.0;
+    bool paused = false;
+    uint64_t queuedSteps = 0;      // single-step and fast-forward steps still to run
+
+    double stepRate = 0.0;         // measured steps per wall second
+    uint64_t commandDrops = 0;     // commands lost because the queue was full
+    uint64_t sampleDrops = 0;      // injected samples lost because their ring was full
+
+    // The state to draw at wall time `now`: between previousBloch and bloch,
+    // as far as the clock would have got since publishing
+    glm::vec3 displayBloch(double now) const;
+};
+
+// Requests from the UI thread, applied at the start of the next tick
+struct SimulationCommand {
+    enum Type : uint32_t {
+        SetState,     // replace the state without bumping stateVersion
+        Inject,       // live-feed samples up to `sampleEnd`: new state, appended to the trail
+        SetDynamics,  // Bloch equation parameters and whether to evolve
+        ClearTrail,
+        SetClock,     // pause, time scale and fixed step
+        SingleStep,
+        FastForward   // queue `seconds` of simulated time
+    };
+
+    Type type = SetState;
+    bool evolve = false;
+    unsigned int substeps = 1;
+    glm::vec3 bloch = glm::vec3(0.0f);
+    BlochEquationParams params;
+    bool paused = false;
+    double timeScale = 1.0;
+    double seconds = 0.0;  // fixed step for SetClock, duration for FastForward
+    uint64_t sampleEnd = 0;  // Inject: samples pushed to the sample ring so far
+};
+
+// Steps the Bloch equations in fixed steps of simulated time and folds in
+// live-feed samples on its own thread. Each tick runs the steps that became
+// due on its SimulationClock and publishes one snapshot through a
+// TripleBuffer, so the render loop never waits on it and a fast-forward costs
+// one publish per batch instead of one per step. Without start() the owner
+// can drive it with tick() instead, which replays use to stay deterministic.
+class SimulationThread {
+public:
+    explicit SimulationThread(size_t maxTrail = 2000, uint32_t commandCapacity = 1 << 14);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Wakes `tickHz` times per second and advances the clock by the wall time
+    // since the last tick
+    void start(double tickHz);
+    void stop();
+    bool isRunning() const { return m_running.load(std::memory_order_relaxed); }
+
+    // UI thread side
+    bool post(const SimulationCommand& command);
+    bool setState(const glm::vec3& bloch);
+    bool inject(const glm::vec3& bloch);
+    // A frame's worth of feed samples as one command. Only the newest
+    // maxTrail samples can show in the trail, so only those are queued; the
+    // batch is dropped whole, and counted, if the sample ring is full.
+    bool injectBatch(const glm::vec3* samples, size_t count);
+    bool clearTrail();
+    bool setClock(bool paused, double timeScale, double fixedStep);
+    bool singleStep();
+    bool fastForward(double seconds);
+
+    // Render thread side: true if a newer snapshot is in snapshot()
+    bool update() { return m_snapshots.update(); }
+    const SimulationSnapshot& snapshot() const { return m_snapshots.readSlot(); }
+
+    // Advances the clock by `wallSeconds` and runs the due steps on the
+    // calling thread; only valid while the thread is not running
+    void tick(double wallSeconds);
+
+private:
+    void run();
+    void applyCommand(const SimulationCommand& command);
+    void appendTrail(const glm::vec3& bloch);
+    void publish();
+
+    size_t m_maxTrail;
+    std::unique_ptr<unsigned char[]> m_commandMemory;
+    SpscRing<SimulationCommand> m_commands;
+    // Inject samples travel in their own ring, in order, and each Inject
+    // command says how far to read; a sample whose command was dropped is
+    // picked up by the next one
+    std::unique_ptr<unsigned char[]> m_sampleMemory;
+    SpscRing<glm::vec3> m_samples;
+    uint64_t m_samplesPushed;    // UI thread
+    uint64_t m_samplesConsumed;  // simulation side
+    TripleBuffer<SimulationSnapshot> m_snapshots;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    double m_tickHz;
+
+    // Simulation state, only touched by whichever thread ticks
+    SimulationClock m_clock;
+    glm::vec3 m_bloch;
+    glm::vec3 m_previousBloch;
+    uint64_t m_stateVersion;
+    std::vector<glm::vec3> m_trail;
+    uint64_t m_trailVersion;
+    bool m_evolve;
+    unsigned int m_substeps;
+    BlochEquationParams m_params;
+    double m_stepRate;
+    double m_rateWindowStart;
+    uint64_t m_rateWindowStep;
+};
@@ -1,19 +1,24 @@
 #pragma once
 
-#include <vector>
-#include <glm/glm.hpp>
+#include <memory>
+#include "GeometryCache.h"
+#include "RenderQueue.h"
 
+// A drawable sphere. The mesh is shared through geometryCache(), so any
+// number of spheres of the same tessellation cost one upload.
 class Sphere {
 public:
     Sphere(float radius, unsigned int rings, unsigned int sectors);
+    explicit Sphere(std::shared_ptr<const SphereGeometry> geometry);
 
-    void draw() const;
+    // Queues the mesh as one indexed draw; a wireframe draws each edge once
+    // as a line rather than every triangle in line polygon mode
+    void submit(RenderQueue& queue, const Shader& shader, const glm::mat4& model, bool wireframe) const;
+    void drawInstanced(unsigned int instanceCount, bool wireframe) const;
 
-private:
-    void generateVertices(float radius, unsigned int rings, unsigned int sectors);
-    void setupMesh();
+    unsigned int triangleCount() const { return m_geometry->indexCount / 3; }
+    unsigned int edgeCount() const { return m_geometry->lineIndexCount / 2; }
 
-    unsigned int m_VAO, m_VBO, m_EBO;
-    std::vector<glm::vec3> m_positions;
-    std::vector<unsigned int> m_indices;
+private:
+    std::shared_ptr<const SphereGeometry> m_geometry;
 };
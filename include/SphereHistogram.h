@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// HEALPix pixelization of the sphere into 12 * nside^2 pixels of equal area.
+// Pixels are stored as the 12 base faces, each nside x nside, tiled 4 across
+// and 3 down: face f starts at column (f % 4) * nside and row (f / 4) * nside.
+// density.frag computes the same texel for each fragment, so the two must
+// change together. `direction` is a Bloch vector of any nonzero length; other
+// input still gives a texel in range.
+unsigned int healpixTexel(unsigned int nside, const glm::vec3& direction);
+
+// Counts Bloch vectors per HEALPix pixel, for showing where an ensemble or a
+// stream of shots lands on the sphere. Large batches are binned on all cores,
+// each worker into its own histogram, and the workers' histograms are summed
+// at the end, so no counter is shared between threads.
+class SphereHistogram {
+public:
+    // nside must be a power of two
+    explicit SphereHistogram(unsigned int nside = 64);
+
+    // Changes the resolution and clears the counts
+    void reset(unsigned int nside);
+    void clear();
+
+    // Bins `count` vectors given in Bloch coordinates; zero vectors and vectors
+    // with a NaN or infinite component are skipped
+    void add(const glm::vec3* points, size_t count);
+
+    unsigned int nside() const { return m_nside; }
+    unsigned int width() const { return 4 * m_nside; }
+    unsigned int height() const { return 3 * m_nside; }
+    // width() * height() counts, row by row
+    const std::vector<uint32_t>& counts() const { return m_counts; }
+    uint64_t total() const { return m_total; }
+    uint32_t peak() const { return m_peak; }
+
+    // Rows [first, end) changed since the last call; false if none did
+    bool takeDirtyRows(unsigned int& first, unsigned int& end);
+
+private:
+    struct Worker {
+        std::vector<uint32_t> counts;
+        unsigned int firstRow, endRow;
+        uint64_t total;
+    };
+
+    void markRows(unsigned int first, unsigned int end);
+
+    unsigned int m_nside;
+    std::vector<uint32_t> m_counts;
+    std::vector<Worker> m_workers;
+    uint64_t m_total;
+    uint32_t m_peak;
+    unsigned int m_dirtyFirst, m_dirtyEnd;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Spatial index of directions on the sphere for nearest-state and cap
+// queries by geodesic angle. Each of the six cube faces is a quadtree of
+// 2^16 x 2^16 cells, warped so that cell areas stay within a factor of
+// about two. A point's key is its face followed by the Morton code of its
+// cell, so every quadtree node is one contiguous range of the points sorted
+// by key and the tree itself is never stored. Inserted points wait in a short
+// unsorted list, which is merged into a sorted run of recent points, which in
+// turn is merged into the main run once it reaches an eighth of its size.
+class SphereIndex {
+public:
+    struct Neighbor {
+        uint32_t id;
+        float angle;  // radians
+    };
+
+    // Replaces the contents with `count` Bloch vectors, given ids 0..count-1,
+    // so count must fit in the ids. Keys are computed on all cores and sorted
+    // with a radix sort.
+    void build(const glm::vec3* points, size_t count);
+    // As build(), but fill(out) writes the `count` vectors straight into the
+    // index, so the caller never holds its own copy of a large source
+    template <typename Fill>
+    void buildInPlace(size_t count, Fill&& fill)
+    {
+        clear();
+        m_points.resize(count);
+        fill(m_points.data());
+        indexPoints();
+    }
+    // Adds one point and returns its id
+    uint32_t insert(const glm::vec3& point);
+    void clear();
+
+    size_t size() const { return m_points.size(); }
+    // Unit direction of a point; zero vectors are indexed at the north pole
+    const glm::vec3& point(uint32_t id) const { return m_points[id]; }
+
+    // The k points nearest `direction`, nearest first, visiting quadtree
+    // nodes best first by the angle to their bounding caps
+    void nearest(const glm::vec3& direction, size_t k, std::vector<Neighbor>& out) const;
+    // Ids of the points within `angle` radians of `direction`, in no order
+    void withinCap(const glm::vec3& direction, float angle, std::vector<uint32_t>& out) const;
+
+private:
+    // Points sorted by key
+    struct Run {
+        std::vector<uint64_t> keys;
+        std::vector<uint32_t> ids;
+        std::vector<glm::vec3> points;
+    };
+
+    struct Node {
+        unsigned int face, level;
+        uint32_t x, y;        // cell at this level
+        uint32_t begin, end;  // range in the run
+    };
+
+    // Normalizes m_points and sorts them into the main run
+    void indexPoints();
+    static uint64_t keyOf(const glm::vec3& direction);
+    // Bounding cap of a node: its center direction and angular radius
+    static void nodeCap(const Node& node, glm::vec3& center, float& radius);
+    // The six faces of a run that hold points
+    static int faces(const Run& run, Node* out);
+    // Children of a node that hold points, found within the node's range
+    static int children(const Run& run, const Node& node, Node* out);
+    // Merges the (key, id) pairs, sorted by key, into `run`
+    void merge(Run& run, const std::vector<std::pair<uint64_t, uint32_t>>& added);
+    void mergePending();
+
+    std::vector<glm::vec3> m_points;  // by id
+    Run m_main, m_recent;
+    std::vector<uint32_t> m_pending;  // inserted since the last merge
+    // Scratch for merges
+    std::vector<std::pair<uint64_t, uint32_t>> m_added;
+};
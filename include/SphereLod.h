@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "LevelOfDetail.h"
+#include "Sphere.h"
+
+// Icosphere levels of one radius, from 20480 triangles down to 80, chosen per
+// sphere by its radius on screen. The meshes come from geometryCache().
+class SphereLod {
+public:
+    explicit SphereLod(float radius);
+
+    // Chooses a level for the `count` spheres centred at centers[indices[i]],
+    // seen from `eye` through a perspective projection with vertical field of
+    // view `fovY` onto a viewport `viewportHeight` pixels tall, and keeps the
+    // total within `triangleBudget` where it can. levels[indices[i]] holds
+    // each sphere's level from the previous frame, for hysteresis, and
+    // receives the new one. Returns the triangles selected.
+    uint64_t select(const glm::vec3* centers, unsigned int* levels, const uint32_t* indices, size_t count,
+                    const glm::vec3& eye, float fovY, float viewportHeight, uint64_t triangleBudget);
+
+    size_t levelCount() const { return m_levels.size(); }
+    const Sphere& level(unsigned int index) const { return m_levels[index]; }
+    unsigned int coarsest() const { return (unsigned int)m_levels.size() - 1; }
+
+private:
+    float m_radius;
+    std::vector<Sphere> m_levels;
+    LodSelector m_selector;
+    std::vector<float> m_pixels;  // scratch, gathered by index
+    std::vector<unsigned int> m_selected;
+};
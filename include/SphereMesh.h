@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// CPU-side triangle mesh, ready for upload
+struct MeshData {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+};
+
+// Latitude/longitude sphere with the poles on +/-y, (rings + 1) * (sectors + 1)
+// vertices. The buffers are sized up front and large meshes are filled on all
+// cores, a band of rings per worker.
+void generateUvSphere(float radius, unsigned int rings, unsigned int sectors, MeshData& mesh);
+
+// Icosahedron with each face split into four `subdivisions` times and the
+// vertices pushed out to the sphere: 10 * 4^n + 2 vertices of nearly equal
+// spacing, without the pole crowding of the UV sphere
+void generateIcosphere(float radius, unsigned int subdivisions, MeshData& mesh);
+
+// Each edge of the triangle list `indices` once, as line-list indices, for
+// drawing a wireframe with GL_LINES instead of a line polygon mode
+void generateEdgeIndices(const std::vector<unsigned int>& indices, std::vector<unsigned int>& lines);
+
+// Vertex and triangle counts of generateIcosphere, for sizing and budgets
+size_t icosphereVertexCount(unsigned int subdivisions);
+size_t icosphereTriangleCount(unsigned int subdivisions);
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+// Control block of a single-producer single-consumer ring. It sits at the
+// start of the ring's memory, which may be shared between processes, so the
+// indices must be address-free (lock-free) atomics. Head and tail live on
+// separate cache lines so the two sides don't false-share.
+struct SpscRingHeader {
+    std::atomic<uint32_t> magic;  // written last, with release ordering
+    uint32_t version;
+    uint32_t capacity;  // slots, a power of two
+    uint32_t slotSize;
+    alignas(64) std::atomic<uint64_t> head;     // total slots written by the producer
+    alignas(64) std::atomic<uint64_t> tail;     // total slots consumed
+    alignas(64) std::atomic<uint64_t> dropped;  // pushes rejected because the ring was full
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "ring header fields must be lock-free to work across processes");
+
+// Typed view over a header followed by `capacity` slots of T. Pushing and
+// draining are wait-free and never enter the kernel; each side keeps a
+// private copy of the other side's index and only reloads it when the ring
+// looks full or empty.
+template <typename T>
+class SpscRing {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "ring slots are copied as raw memory");
+
+    static size_t bytesFor(uint32_t capacity)
+    {
+        return slotsOffset() + static_cast<size_t>(capacity) * sizeof(T);
+    }
+
+    SpscRing() = default;
+    explicit SpscRing(void* memory) { attach(memory); }
+
+    // Constructs the control block in `memory`; capacity must be a power of two
+    static SpscRingHeader* initialize(void* memory, uint32_t capacity, uint32_t magic, uint32_t version)
+    {
+        SpscRingHeader* header = new (memory) SpscRingHeader();
+        header->capacity = capacity;
+        header->slotSize = sizeof(T);
+        header->version = version;
+        header->head.store(0, std::memory_order_relaxed);
+        header->tail.store(0, std::memory_order_relaxed);
+        header->dropped.store(0, std::memory_order_relaxed);
+        // Publish the magic last so an opener that acquires it never sees a
+        // half-built header
+        header->magic.store(magic, std::memory_order_release);
+        return header;
+    }
+
+    void attach(void* memory)
+    {
+        m_header = static_cast<SpscRingHeader*>(memory);
+        m_slots = reinterpret_cast<T*>(static_cast<unsigned char*>(memory) + slotsOffset());
+        m_mask = m_header->capacity - 1;
+        m_cachedHead = m_header->head.load(std::memory_order_acquire);
+        m_cachedTail = m_header->tail.load(std::memory_order_acquire);
+    }
+
+    bool isAttached() const { return m_header != nullptr; }
+    uint32_t capacity() const { return m_header->capacity; }
+    uint64_t dropped() const { return m_header->dropped.load(std::memory_order_relaxed); }
+
+    // Producer side
+    bool tryPush(const T& value)
+    {
+        uint64_t head = m_header->head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail > m_mask) {
+            m_cachedTail = m_header->tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail > m_mask) {
+                m_header->dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        m_slots[head & m_mask] = value;
+        m_header->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pushes all `count` values or, if they do not fit, none of them; a
+    // rejected batch adds `count` to dropped()
+    bool tryPushAll(const T* values, size_t count)
+    {
+        uint64_t head = m_header->head.load(std::memory_order_relaxed);
+        if (head + count - m_cachedTail > m_mask + 1) {
+            m_cachedTail = m_header->tail.load(std::memory_order_acquire);
+            if (head + count - m_cachedTail > m_mask + 1) {
+                m_header->dropped.fetch_add(count, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        for (size_t i = 0; i < count; ++i)
+            m_slots[(head + i) & m_mask] = values[i];
+        m_header->head.store(head + count, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: calls fn(const T&) for up to `maxItems` queued items and
+    // releases their slots in one store. Returns the number consumed.
+    template <typename Fn>
+    size_t drain(Fn&& fn, size_t maxItems = SIZE_MAX)
+    {
+        uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead)
+            m_cachedHead = m_header->head.load(std::memory_order_acquire);
+        uint64_t available = m_cachedHead - tail;
+        size_t count = available < maxItems ? static_cast<size_t>(available) : maxItems;
+        for (size_t i = 0; i < count; ++i)
+            fn(m_slots[(tail + i) & m_mask]);
+        if (count > 0)
+            m_header->tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    static size_t slotsOffset()
+    {
+        size_t alignment = alignof(T) > 64 ? alignof(T) : 64;
+        return (sizeof(SpscRingHeader) + alignment - 1) / alignment * alignment;
+    }
+
+    SpscRingHeader* m_header = nullptr;
+    T* m_slots = nullptr;
+    uint64_t m_mask = 0;
+    uint64_t m_cachedHead = 0;  // consumer's copy of head
+    uint64_t m_cachedTail = 0;  // producer's copy of tail
+};
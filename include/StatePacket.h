@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "StateSample.h"
+
+// Datagram carrying a batch of StateSamples, all fields little-endian:
+//
+//   "BSPK" | u32 sequence | u16 count | u16 reserved
+//   count x (f64 timestamp | u32 kind | f32 values[4] | u32 reserved)
+//
+// The sequence number increases by one per datagram so receivers can count
+// lost packets.
+
+const size_t kStatePacketHeaderSize = 12;
+const size_t kStatePacketSampleSize = 32;
+// Keeps a full packet under the 1472-byte UDP payload of a 1500-byte MTU
+const size_t kMaxSamplesPerPacket = 45;
+const size_t kMaxStatePacketSize = kStatePacketHeaderSize + kMaxSamplesPerPacket * kStatePacketSampleSize;
+
+// Returns the encoded size; at most kMaxSamplesPerPacket samples are taken
+size_t encodeStatePacket(uint32_t sequence, const StateSample* samples, size_t count, unsigned char* out);
+
+// Returns false if the datagram is not a well-formed state packet. `out`
+// must have room for kMaxSamplesPerPacket samples.
+bool decodeStatePacket(const unsigned char* data, size_t size, uint32_t& sequence, StateSample* out, size_t& count);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "BlochMath.h"
+
+// A timestamped state pushed by an external source. Shared between
+// processes, so it is plain data with a fixed 32-byte layout.
+struct StateSample {
+    enum Kind : uint32_t {
+        Bloch = 0,      // values = x, y, z
+        Amplitudes = 1  // values = alpha re, alpha im, beta re, beta im
+    };
+
+    double timestamp;   // steadySeconds() of the producer
+    uint32_t kind;
+    float values[4];
+    uint32_t reserved;
+
+    glm::vec3 bloch() const
+    {
+        if (kind == Amplitudes)
+            return blochFromAmplitudes({ { values[0], values[1] }, { values[2], values[3] } });
+        return glm::vec3(values[0], values[1], values[2]);
+    }
+};
+static_assert(sizeof(StateSample) == 32, "StateSample layout is shared with other processes");
+
+// Seconds on the monotonic clock, which is system-wide on Linux
+// (CLOCK_MONOTONIC) and Windows (QueryPerformanceCounter), so timestamps from
+// another process can be compared against it to measure latency
+inline double steadySeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
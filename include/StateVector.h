@@ -1,19 +1,33 @@
 #pragma once
 
+#include <cstddef>
 #include <glm/glm.hpp>
+#include "GpuResources.h"
+#include "RenderQueue.h"
 #include "Shader.h"
 
 class StateVector {
 public:
     StateVector();
     void update(float theta, float phi);
-    void draw(const Shader& shader, const glm::mat4& view, const glm::mat4& projection);
+    // Any Bloch vector, shorter than the radius for a mixed state
+    void update(const glm::vec3& bloch);
+    // Queues the trail, the previous vector if shown and the current vector
+    void submit(RenderQueue& queue, const Shader& shader, const glm::mat4& model) const;
     void storePreviousState();
     void hidePrevious();
 
+    // Polyline drawn along with the vector, points in scene coordinates
+    void setTrail(const glm::vec3* points, size_t count);
+    void clearTrail();
+
+    // Tip of the current vector in scene coordinates, relative to the centre
+    const glm::vec3& tip() const { return m_currentVector; }
+
 private:
-    unsigned int m_VAO, m_VBO;
-    unsigned int m_prev_VAO, m_prev_VBO;
+    GlVertexArray m_VAO, m_prev_VAO, m_trail_VAO;
+    GlBuffer m_VBO, m_prev_VBO, m_trail_VBO;
+    size_t m_trailCount;
     glm::vec3 m_currentVector;
     glm::vec3 m_previousVector;
     bool m_drawPrevious;
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include "GpuResources.h"
+#include "Shader.h"
+#include "Sphere.h"
+#include "ParameterSweep.h"
+
+// Draws the cells of a ParameterSweep as a tiled figure sheet. Every cell is
+// one instance, so the whole sheet is a single render pass of three draws.
+class SweepRenderer {
+public:
+    SweepRenderer();
+
+    // Renders the sheet offscreen at `cellSize` pixels per tile (shrunk if the
+    // sheet would exceed the driver limit) and writes it to `path` as TGA.
+    bool renderSheet(const ParameterSweep& sweep, int cellSize, const Shader& sphereShader, const Shader& vectorShader, const char* path);
+
+    // Uploads the cells for drawSheet; renderSheet does this itself
+    void uploadCells(const ParameterSweep& sweep);
+
+    // Draws the uploaded cells into the bound framebuffer, filling the viewport
+    // with `columns` x `rows` tiles
+    void drawSheet(unsigned int columns, unsigned int rows, float pointSize, const Shader& sphereShader, const Shader& vectorShader);
+
+    const std::string& status() const { return m_status; }
+
+private:
+
+    Sphere m_sphere;
+    GlVertexArray m_VAO;
+    GlBuffer m_instanceVBO;
+    std::string m_status;
+};
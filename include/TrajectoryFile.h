@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "MappedFile.h"
+
+// Bloch trajectory files (.btraj), all fields little-endian:
+//
+//   header   "BTRJ" | u32 version | u32 chunk capacity | u32 reserved
+//   chunk*   f64 time[n] | f32 x[n] | f32 y[n] | f32 z[n], padded to 8 bytes
+//   index    per chunk: f64 first time | f64 last time | u64 offset | u32 n | u32 reserved
+//   trailer  u64 index offset | u64 chunk count | u64 sample count | "BTRJEND\0"
+//
+// Chunks are columnar so a window read touches only the pages it needs, and
+// the index sits at the end so the writer never has to seek. Sample times
+// must be non-decreasing.
+
+class TrajectoryWriter {
+public:
+    explicit TrajectoryWriter(unsigned int chunkCapacity = 4096);
+    ~TrajectoryWriter();
+
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    // Writes to an already open stream, which may be a pipe
+    bool open(FILE* file);
+    bool open(const char* path);
+
+    // Fails if `time` is earlier than the previous sample
+    bool append(double time, const glm::vec3& bloch);
+
+    // Writes the last chunk, the index and the trailer
+    bool close();
+
+    uint64_t sampleCount() const { return m_samples; }
+
+private:
+    struct ChunkEntry {
+        double firstTime;
+        double lastTime;
+        uint64_t offset;
+        uint32_t count;
+    };
+
+    bool writeBytes(const void* data, size_t size);
+    bool flushChunk();
+
+    FILE* m_file = nullptr;
+    bool m_ownsFile = false;
+    bool m_failed = false;
+    unsigned int m_chunkCapacity;
+    uint64_t m_offset = 0;
+    uint64_t m_samples = 0;
+    std::vector<double> m_times;
+    std::vector<glm::vec3> m_blochs;
+    std::vector<unsigned char> m_encoded;
+    std::vector<ChunkEntry> m_index;
+};
+
+class TrajectoryReader {
+public:
+    bool open(const char* path, std::string& error);
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    uint64_t sampleCount() const { return m_samples; }
+    double startTime() const;
+    double endTime() const;
+
+    // Index of the first sample at or after `time` (sampleCount() if none),
+    // by binary search over the chunk index and then the chunk's time column
+    uint64_t seek(double time) const;
+
+    double timeAt(uint64_t index) const;
+    glm::vec3 blochAt(uint64_t index) const;
+
+    // Samples [first, first + count), which must lie within the file, written
+    // to `blochs` and, if given, their times to `times`. Chunks are walked in
+    // order, so reading a file block by block touches each page once.
+    void readSamples(uint64_t first, size_t count, glm::vec3* blochs, double* times = nullptr) const;
+
+    // Replaces `out` with the samples in [from, to], evenly decimated to at
+    // most `maxSamples`. Only the pages holding the returned samples are read.
+    void readWindow(double from, double to, size_t maxSamples, std::vector<glm::vec3>& out) const;
+
+private:
+    struct Chunk {
+        double firstTime;
+        double lastTime;
+        const unsigned char* data;
+        uint32_t count;
+        uint64_t firstSample;
+    };
+
+    const Chunk& chunkFor(uint64_t index) const;
+
+    MappedFile m_file;
+    std::vector<Chunk> m_chunks;
+    uint64_t m_samples = 0;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free single-writer single-reader triple buffer. The writer fills its
+// private slot and publishes it by swapping it with the shared middle slot;
+// the reader swaps the middle slot with its own when a new one is waiting.
+// Neither side ever waits, and the reader always sees the latest complete
+// value, possibly skipping intermediate ones.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side: fill this, then publish(). After publishing, the slot
+    // returned next may hold an older value than the one just published.
+    T& writeSlot() { return m_slots[m_write]; }
+
+    void publish()
+    {
+        m_write = m_middle.exchange(m_write | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Reader side: takes the newest published value, if any, into readSlot().
+    // Returns false if nothing was published since the last update.
+    bool update()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & kFresh))
+            return false;
+        m_read = m_middle.exchange(m_read, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    const T& readSlot() const { return m_slots[m_read]; }
+
+private:
+    static const int kIndexMask = 3;
+    static const int kFresh = 4;
+
+    T m_slots[3];
+    int m_write = 0;
+    alignas(64) std::atomic<int> m_middle{ 1 };
+    alignas(64) int m_read = 2;
+};
@@ -0,0 +1,73 @@
+#version 330 core
+in vec3 spherePos;
+out vec4 FragColor;
+
+// HEALPix bin counts laid out as in SphereHistogram: 12 faces of nside x nside,
+// 4 across and 3 down
+uniform usampler2D counts;
+uniform int nside;
+uniform float logScale;  // 1 / log(1 + peak count)
+
+// Polynomial fit of matplotlib's viridis
+vec3 viridis(float t)
+{
+    const vec3 c0 = vec3(0.2777273272234177, 0.005407344544966578, 0.3340998053353061);
+    const vec3 c1 = vec3(0.1050930431085774, 1.404613529898575, 1.384590162594685);
+    const vec3 c2 = vec3(-0.3308618287255563, 0.214847559468213, 0.09509516302823659);
+    const vec3 c3 = vec3(-4.634230498983486, -5.799100973351585, -19.33244095627987);
+    const vec3 c4 = vec3(6.228269936347081, 14.17993336680509, 56.69055260068105);
+    const vec3 c5 = vec3(4.776384997670288, -13.74514537774601, -65.35303263337234);
+    const vec3 c6 = vec3(-5.435455855934631, 4.645852612178535, 26.3124352495832);
+    return c0 + t * (c1 + t * (c2 + t * (c3 + t * (c4 + t * (c5 + t * c6)))));
+}
+
+// Same as texelOf in SphereHistogram.cpp
+ivec2 healpixTexel(vec3 bloch)
+{
+    float len = length(bloch);
+    float cosTheta = bloch.z / len;
+    float za = abs(cosTheta);
+    float tt = atan(bloch.y, bloch.x) * 0.63661977236758134;
+    if (tt < 0.0)
+        tt += 4.0;
+    int face, ix, iy;
+    if (za <= 2.0 / 3.0) {
+        float temp1 = float(nside) * (0.5 + tt);
+        float temp2 = float(nside) * (cosTheta * 0.75);
+        int jp = int(temp1 - temp2);
+        int jm = int(temp1 + temp2);
+        int ifp = jp / nside;
+        int ifm = jm / nside;
+        face = ifp == ifm ? ((ifp & 3) | 4) : (ifp < ifm ? (ifp & 3) : (ifm & 3) + 8);
+        ix = jm & (nside - 1);
+        iy = nside - (jp & (nside - 1)) - 1;
+    } else {
+        int ntt = min(3, int(tt));
+        float tp = tt - float(ntt);
+        float sinSquared = (bloch.x * bloch.x + bloch.y * bloch.y) / (len * len);
+        float tmp = float(nside) * sqrt(3.0 * sinSquared / (1.0 + za));
+        int jp = min(nside - 1, int(tp * tmp));
+        int jm = min(nside - 1, int((1.0 - tp) * tmp));
+        if (cosTheta >= 0.0) {
+            face = ntt;
+            ix = nside - jm - 1;
+            iy = nside - jp - 1;
+        } else {
+            face = ntt + 8;
+            ix = jp;
+            iy = jm;
+        }
+    }
+    return ivec2((face & 3) * nside + ix, (face >> 2) * nside + iy);
+}
+
+void main()
+{
+    // Scene y is the Bloch z axis, see toScene
+    vec3 bloch = vec3(spherePos.x, spherePos.z, spherePos.y);
+    uint count = texelFetch(counts, healpixTexel(bloch), 0).r;
+    if (count == 0u)
+        FragColor = vec4(0.12, 0.12, 0.12, 1.0);
+    else
+        FragColor = vec4(viridis(clamp(log(1.0 + float(count)) * logScale, 0.0, 1.0)), 1.0);
+}
@@ -0,0 +1,41 @@
+#version 330 core
+in vec3 spherePos;
+out vec4 FragColor;
+
+// Latitude/longitude grid from QuasiProbabilityGrid: u is the azimuth from
+// Bloch x towards y, v the polar angle from +z
+uniform sampler2D values;
+uniform int diverging;  // Wigner functions go negative
+uniform float scale;    // 1 / the largest magnitude
+
+const float PI = 3.14159265358979;
+
+// Polynomial fit of matplotlib's viridis
+vec3 viridis(float t)
+{
+    const vec3 c0 = vec3(0.2777273272234177, 0.005407344544966578, 0.3340998053353061);
+    const vec3 c1 = vec3(0.1050930431085774, 1.404613529898575, 1.384590162594685);
+    const vec3 c2 = vec3(-0.3308618287255563, 0.214847559468213, 0.09509516302823659);
+    const vec3 c3 = vec3(-4.634230498983486, -5.799100973351585, -19.33244095627987);
+    const vec3 c4 = vec3(6.228269936347081, 14.17993336680509, 56.69055260068105);
+    const vec3 c5 = vec3(4.776384997670288, -13.74514537774601, -65.35303263337234);
+    const vec3 c6 = vec3(-5.435455855934631, 4.645852612178535, 26.3124352495832);
+    return c0 + t * (c1 + t * (c2 + t * (c3 + t * (c4 + t * (c5 + t * c6)))));
+}
+
+// Blue below zero, white at zero, red above
+vec3 blueWhiteRed(float t)
+{
+    return t < 0.0 ? mix(vec3(1.0), vec3(0.15, 0.3, 0.85), -t) : mix(vec3(1.0), vec3(0.8, 0.1, 0.1), t);
+}
+
+void main()
+{
+    // Scene y is the Bloch z axis, see toScene
+    vec3 bloch = normalize(vec3(spherePos.x, spherePos.z, spherePos.y));
+    float u = atan(bloch.y, bloch.x) / (2.0 * PI);
+    float v = acos(clamp(bloch.z, -1.0, 1.0)) / PI;
+    float value = texture(values, vec2(fract(u), v)).r * scale;
+    vec3 color = diverging != 0 ? blueWhiteRed(clamp(value, -1.0, 1.0)) : viridis(clamp(value, 0.0, 1.0));
+    FragColor = vec4(color, 1.0);
+}
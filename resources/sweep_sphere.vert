@@ -0,0 +1,13 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 tileModel;
+uniform mat4 projection;
+uniform int columns;
+
+void main()
+{
+    vec2 tileCenter = vec2(gl_InstanceID % columns, gl_InstanceID / columns) + 0.5;
+    vec4 local = tileModel * vec4(aPos, 1.0);
+    gl_Position = projection * vec4(local.xy + tileCenter, local.z, 1.0);
+}
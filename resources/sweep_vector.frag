@@ -0,0 +1,11 @@
+#version 330 core
+out vec4 FragColor;
+
+in float purity;
+
+void main()
+{
+    // Yellow like the main state vector for pure states, fading to red as the state mixes
+    float t = clamp(2.0 * purity - 1.0, 0.0, 1.0);
+    FragColor = vec4(mix(vec3(0.8, 0.15, 0.1), vec3(1.0, 1.0, 0.0), t), 1.0);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aBloch;   // per instance, physics coordinates
+layout (location = 1) in float aPurity; // per instance
+
+uniform mat4 tileModel;
+uniform mat4 projection;
+uniform int columns;
+uniform float pointSize;
+
+out float purity;
+
+void main()
+{
+    // Vertex 0 is the sphere center, vertex 1 the tip. |0> is drawn on +y like the main view.
+    vec3 tip = gl_VertexID == 0 ? vec3(0.0) : aBloch.xzy * 0.4;
+    vec2 tileCenter = vec2(gl_InstanceID % columns, gl_InstanceID / columns) + 0.5;
+    vec4 local = tileModel * vec4(tip, 1.0);
+    gl_Position = projection * vec4(local.xy + tileCenter, local.z, 1.0);
+    gl_PointSize = pointSize;
+    purity = aPurity;
+}
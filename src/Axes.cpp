@@ -2,7 +2,7 @@
 #include <glad/glad.h>
 #include <vector>
 
-Axes::Axes(float length) : m_length(length)
+Axes::Axes(float length) : m_VAO("Axes"), m_VBO("Axes vertices"), m_length(length)
 {
     std::vector<glm::vec3> vertices = {
         // X-axis
@@ -16,13 +16,8 @@ Axes::Axes(float length) : m_length(length)
         glm::vec3(0.0f, 0.0f, m_length)
     };
 
-    glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-
-    glBindVertexArray(m_VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), &vertices[0], GL_STATIC_DRAW);
+    glBindVertexArray(m_VAO.id());
+    m_VBO.allocate(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
     glEnableVertexAttribArray(0);
@@ -31,29 +26,20 @@ Axes::Axes(float length) : m_length(length)
     glBindVertexArray(0);
 }
 
-void Axes::draw(const Shader& shader, const glm::mat4& view, const glm::mat4& projection, float thickness)
+void Axes::submit(RenderQueue& queue, const Shader& shader, const glm::mat4& model, float thickness) const
 {
-    glLineWidth(thickness); // Set line thickness
-    shader.use();
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
-    
-    glm::mat4 model = glm::mat4(1.0f);
-    shader.setMat4("model", model);
-
-    glBindVertexArray(m_VAO);
-    
-    // Draw X-axis (red)
-    shader.setVec3("lineColor", glm::vec3(1.0f, 0.0f, 0.0f));
-    glDrawArrays(GL_LINES, 0, 2);
-
-    // Draw Y-axis (green)
-    shader.setVec3("lineColor", glm::vec3(0.0f, 1.0f, 0.0f));
-    glDrawArrays(GL_LINES, 2, 2);
-
-    // Draw Z-axis (blue)
-    shader.setVec3("lineColor", glm::vec3(0.0f, 0.0f, 1.0f));
-    glDrawArrays(GL_LINES, 4, 2);
-
-    glBindVertexArray(0);
+    const glm::vec3 colors[3] = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+    DrawPacket packet;
+    packet.shader = &shader;
+    packet.vao = m_VAO.id();
+    packet.primitive = GL_LINES;
+    packet.count = 2;
+    packet.model = model;
+    packet.hasColor = true;
+    packet.state.lineWidth = thickness;
+    for (unsigned int axis = 0; axis < 3; ++axis) {
+        packet.first = 2 * axis;
+        packet.color = colors[axis];
+        queue.submit(packet);
+    }
 }
@@ -0,0 +1,60 @@
+#include "DensityMap.h"
+#include <glad/glad.h>
+#include <cmath>
+
+namespace {
+
+// Inside the wireframe, so its lines stay visible over the shading
+const float kRadius = 0.99f;
+const unsigned int kSubdivisions = 5;
+
+}
+
+DensityMap::DensityMap()
+    : m_sphere(geometryCache().icosphere(kRadius, kSubdivisions)), m_texture("Density counts"), m_nside(0), m_peak(0)
+{
+}
+
+unsigned int DensityMap::upload(SphereHistogram& histogram)
+{
+    unsigned int first, end;
+    if (!histogram.takeDirtyRows(first, end) && histogram.nside() == m_nside)
+        return 0;
+
+    glBindTexture(GL_TEXTURE_2D, m_texture.id());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    unsigned int width = histogram.width();
+    if (histogram.nside() != m_nside) {
+        // Integer textures cannot be filtered
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width, histogram.height(), 0, GL_RED_INTEGER, GL_UNSIGNED_INT,
+                     histogram.counts().data());
+        m_nside = histogram.nside();
+        first = 0;
+        end = histogram.height();
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, width, end - first, GL_RED_INTEGER, GL_UNSIGNED_INT,
+                        histogram.counts().data() + (size_t)first * width);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_peak = histogram.peak();
+    return end - first;
+}
+
+void DensityMap::draw(const Shader& shader, const glm::mat4& view, const glm::mat4& projection, const glm::mat4& model) const
+{
+    if (m_nside == 0)
+        return;
+    shader.use();
+    shader.setMat4("view", view);
+    shader.setMat4("projection", projection);
+    shader.setMat4("model", model);
+    shader.setInt("counts", 0);
+    shader.setInt("nside", (int)m_nside);
+    shader.setFloat("logScale", m_peak > 0 ? 1.0f / std::log(1.0f + (float)m_peak) : 0.0f);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_texture.id());
+    m_sphere.drawInstanced(1, false);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
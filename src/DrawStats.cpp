@@ -0,0 +1,11 @@
+#include "DrawStats.h"
+
+#include "imgui.h"
+
+void countImGuiDraws(const ImDrawData* data)
+{
+    if (!data)
+        return;
+    for (int i = 0; i < data->CmdListsCount; ++i)
+        drawStats().drawCalls += (uint32_t)data->CmdLists[i]->CmdBuffer.Size;
+}
@@ -0,0 +1,265 @@
+#include "FrameBenchmark.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "Axes.h"
+#include "BlochMath.h"
+#include "Camera.h"
+#include "DrawStats.h"
+#include "FrameArena.h"
+#include "FrustumCulling.h"
+#include "ParameterSweep.h"
+#include "RenderQueue.h"
+#include "SceneLabels.h"
+#include "Shader.h"
+#include "Sphere.h"
+#include "SphereLod.h"
+#include "StateVector.h"
+#include "SweepRenderer.h"
+
+#include "imgui.h"
+#include "imgui_impl_opengl3.h"
+#include "imgui_impl_glfw.h"
+
+namespace {
+
+const int kWidth = 1280;
+const int kHeight = 720;
+const unsigned int kSheetSize = 32;
+const size_t kTrailPoints = 100000;
+const unsigned int kExtraLabels = 256;
+const int kGridSize = 8;
+const float kGridSpacing = 3.5f;
+const float kFovY = glm::radians(45.0f);
+const uint64_t kLodTriangleBudget = 100000;
+
+struct Scene {
+    const char* name;
+    // Draws the 3D part of one frame and any labels; ImGui is already in a frame
+    std::function<void(const glm::mat4& view, const glm::mat4& projection)> draw;
+};
+
+}
+
+int runFrameBenchmark(GLFWwindow* window, const FrameBenchmarkOptions& options)
+{
+    glfwSetWindowSize(window, kWidth, kHeight);
+    glfwPollEvents();
+    glViewport(0, 0, kWidth, kHeight);
+    glfwSwapInterval(0);
+
+    Shader sphereShader(RESOURCES_PATH "vertex.vert", RESOURCES_PATH "fragment.frag");
+    Shader axesShader(RESOURCES_PATH "axes.vert", RESOURCES_PATH "axes.frag");
+    Shader stateVectorShader(RESOURCES_PATH "state_vector.vert", RESOURCES_PATH "state_vector.frag");
+    Shader sweepSphereShader(RESOURCES_PATH "sweep_sphere.vert", RESOURCES_PATH "fragment.frag");
+    Shader sweepVectorShader(RESOURCES_PATH "sweep_vector.vert", RESOURCES_PATH "sweep_vector.frag");
+
+    Sphere sphere(1.0f, 8, 8);
+    Axes axes(1.5f);
+    StateVector stateVector;
+    stateVector.update(45.0f, 30.0f);
+    SweepRenderer sweepRenderer;
+    RenderQueue renderQueue;
+    glm::vec4 viewport(0.0f, 0.0f, (float)kWidth, (float)kHeight);
+    SphereLod sphereLod(1.0f);
+    std::vector<glm::vec3> gridCenters;
+    BoundingSpheres gridBounds;
+    std::vector<unsigned int> gridLevels(kGridSize * kGridSize, sphereLod.coarsest());
+    std::vector<uint32_t> gridVisible(kGridSize * kGridSize);
+    float gridOffset = 0.5f * (kGridSize - 1) * kGridSpacing;
+    for (int row = 0; row < kGridSize; ++row) {
+        for (int column = 0; column < kGridSize; ++column) {
+            gridCenters.emplace_back(column * kGridSpacing - gridOffset, 0.0f, row * kGridSpacing - gridOffset);
+            gridBounds.add(gridCenters.back(), 1.5f);
+        }
+    }
+
+    auto submitBlochSphere = [&](const glm::mat4& model, const Sphere& mesh) {
+        mesh.submit(renderQueue, sphereShader, model, true);
+        axes.submit(renderQueue, axesShader, model, 1.0f);
+        stateVector.submit(renderQueue, stateVectorShader, model);
+    };
+    auto drawDefaultView = [&](const glm::mat4& view, const glm::mat4& projection) {
+        renderQueue.begin(view, projection);
+        submitBlochSphere(glm::mat4(1.0f), sphere);
+        renderQueue.flush();
+        drawAxisLabels(projection * view, viewport, glm::vec3(glm::inverse(view)[3]));
+    };
+    // Writes the grid cells in view to gridVisible and returns their count
+    auto cullGrid = [&](const glm::mat4& viewProjection) {
+        return cullSpheres(Frustum::fromMatrix(viewProjection), gridBounds, gridVisible.data());
+    };
+
+    // Precessing, slowly decaying spiral as a stand-in for a long trajectory
+    std::vector<glm::vec3> trail(kTrailPoints);
+    for (size_t i = 0; i < kTrailPoints; ++i) {
+        float t = (float)i / kTrailPoints;
+        float radius = std::exp(-1.5f * t);
+        float angle = 400.0f * t;
+        trail[i] = toScene(glm::vec3(radius * std::cos(angle), radius * std::sin(angle), 1.0f - 2.0f * t));
+    }
+
+    // Extra labels spread evenly over the sphere on a Fibonacci lattice
+    std::vector<glm::vec3> labelPositions(kExtraLabels);
+    for (unsigned int i = 0; i < kExtraLabels; ++i) {
+        float z = 1.0f - 2.0f * (i + 0.5f) / kExtraLabels;
+        float angle = 2.39996323f * i;
+        float r = std::sqrt(1.0f - z * z);
+        labelPositions[i] = 1.2f * glm::vec3(r * std::cos(angle), z, r * std::sin(angle));
+    }
+
+    ParameterSweep sweep;
+    SweepSettings sweepSettings;
+    sweepSettings.columns.count = kSheetSize;
+    sweepSettings.rows.count = kSheetSize;
+
+    std::vector<Scene> scenes = {
+        { "single_sphere", drawDefaultView },
+        { "instanced_1k", [&](const glm::mat4&, const glm::mat4&) {
+            sweepRenderer.drawSheet(kSheetSize, kSheetSize, 4.0f, sweepSphereShader, sweepVectorShader);
+        } },
+        { "trail_100k", drawDefaultView },
+        { "grid_64", [&](const glm::mat4& view, const glm::mat4& projection) {
+            // Pulled back so the whole grid is in view
+            glm::mat4 pulledBack = glm::translate(view, glm::vec3(0.0f, 0.0f, -4.0f * kGridSpacing));
+            size_t visibleCount = cullGrid(projection * pulledBack);
+            renderQueue.begin(pulledBack, projection);
+            for (size_t k = 0; k < visibleCount; ++k)
+                submitBlochSphere(glm::translate(glm::mat4(1.0f), gridCenters[gridVisible[k]]), sphere);
+            renderQueue.flush();
+        } },
+        { "grid_64_lod", [&](const glm::mat4& view, const glm::mat4& projection) {
+            // The same grid with icosphere levels picked by size on screen
+            glm::mat4 pulledBack = glm::translate(view, glm::vec3(0.0f, 0.0f, -4.0f * kGridSpacing));
+            glm::vec3 eye = glm::vec3(glm::inverse(pulledBack)[3]);
+            size_t visibleCount = cullGrid(projection * pulledBack);
+            sphereLod.select(gridCenters.data(), gridLevels.data(), gridVisible.data(), visibleCount, eye, kFovY,
+                             (float)kHeight, kLodTriangleBudget);
+            renderQueue.begin(pulledBack, projection);
+            for (size_t k = 0; k < visibleCount; ++k) {
+                uint32_t i = gridVisible[k];
+                submitBlochSphere(glm::translate(glm::mat4(1.0f), gridCenters[i]), sphereLod.level(gridLevels[i]));
+            }
+            renderQueue.flush();
+        } },
+        { "labels", [&](const glm::mat4& view, const glm::mat4& projection) {
+            drawDefaultView(view, projection);
+            glm::mat4 viewProjection = projection * view;
+            glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+            // Label text is formatted every frame, as live labels would be
+            for (unsigned int i = 0; i < kExtraLabels; ++i) {
+                if (occludedBySphere(eye, labelPositions[i], glm::vec3(0.0f), 1.0f))
+                    continue;
+                const char* text = frameArena().format("|s%u>", i);
+                drawSceneLabel(text, labelPositions[i], text, viewProjection, viewport);
+            }
+        } },
+    };
+
+    std::vector<FrameStats> results;
+    std::vector<uint64_t> sceneAllocations;
+    std::vector<double> frameMs;
+    frameMs.reserve(options.frames);
+    for (const Scene& scene : scenes) {
+        if (options.scene && std::strcmp(options.scene, scene.name) != 0)
+            continue;
+
+        // Per-scene setup is done before the clock starts
+        if (std::strcmp(scene.name, "instanced_1k") == 0) {
+            sweep.run(sweepSettings);
+            sweepRenderer.uploadCells(sweep);
+        }
+        if (std::strcmp(scene.name, "trail_100k") == 0)
+            stateVector.setTrail(trail.data(), trail.size());
+        else
+            stateVector.clearTrail();
+
+        Camera camera(5.0f);
+        glm::mat4 projection = glm::perspective(kFovY, (float)kWidth / kHeight, 0.1f, 100.0f);
+        frameMs.clear();
+        uint32_t drawCalls = 0;
+        uint64_t allocations = 0;
+        for (unsigned int frame = 0; frame < options.warmupFrames + options.frames; ++frame) {
+            auto start = std::chrono::steady_clock::now();
+            drawStats().reset();
+            uint64_t allocationsBefore = threadHeapAllocations();
+
+            camera.ProcessMouseMovement(1.5f, 0.2f * std::sin(frame * 0.05f), 1.0f);
+            glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+            scene.draw(camera.GetViewMatrix(), projection);
+            ImGui::Render();
+            countImGuiDraws(ImGui::GetDrawData());
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+            glfwSwapBuffers(window);
+            glFinish();
+            glfwPollEvents();
+            frameArena().reset();
+
+            if (frame >= options.warmupFrames) {
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                // Read before push_back so the benchmark's own bookkeeping is not counted
+                allocations += threadHeapAllocations() - allocationsBefore;
+                frameMs.push_back(ms);
+                drawCalls = std::max(drawCalls, drawStats().drawCalls);
+            }
+        }
+        results.push_back(summarizeFrames(scene.name, frameMs, drawCalls));
+        sceneAllocations.push_back(allocations);
+    }
+    stateVector.clearTrail();
+
+    std::vector<FrameStats> baseline;
+    std::string error;
+    if (options.baselinePath && !readBaseline(options.baselinePath, baseline, error)) {
+        std::printf("%s\n", error.c_str());
+        return 2;
+    }
+
+    bool regressed = false;
+    std::printf("%-16s %7s %9s %9s %9s %7s %7s  %s\n", "scene", "frames", "p50 ms", "p95 ms", "p99 ms", "draws", "allocs", "baseline");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const FrameStats& stats = results[i];
+        std::string verdict = options.baselinePath ? "not in baseline" : "-";
+        for (const FrameStats& reference : baseline) {
+            if (reference.scene != stats.scene)
+                continue;
+            std::string reason;
+            if (withinBaseline(stats, reference, options.tolerance, reason)) {
+                verdict = "ok";
+            } else {
+                verdict = "REGRESSION: " + reason;
+                regressed = true;
+            }
+        }
+        if (options.requireNoAllocations && sceneAllocations[i] > 0) {
+            verdict = "ALLOCATES: " + verdict;
+            regressed = true;
+        }
+        std::printf("%-16s %7u %9.3f %9.3f %9.3f %7u %7llu  %s\n", stats.scene.c_str(), stats.frames,
+            stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.drawCalls, (unsigned long long)sceneAllocations[i], verdict.c_str());
+    }
+
+    if (options.savePath) {
+        if (!writeBaseline(options.savePath, results, error)) {
+            std::printf("%s\n", error.c_str());
+            return 2;
+        }
+        std::printf("Wrote baseline %s\n", options.savePath);
+    }
+    return regressed ? 1 : 0;
+}
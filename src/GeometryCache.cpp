@@ -0,0 +1,96 @@
+#include "GeometryCache.h"
+#include "SphereMesh.h"
+#include <glad/glad.h>
+#include <algorithm>
+
+namespace {
+
+// Binds `vertices` as attribute 0 of `vao` and gives it `indices` as its
+// element buffer
+void setupVertexArray(const GlVertexArray& vao, const GlBuffer& vertices, GlBuffer& indices,
+                      const std::vector<unsigned int>& data, const char* label)
+{
+    size_t indexBytes = data.size() * sizeof(unsigned int);
+    glBindVertexArray(vao.id());
+    indices = gpuPool().acquireBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBytes, GL_STATIC_DRAW, label);
+    indices.write(GL_ELEMENT_ARRAY_BUFFER, 0, indexBytes, data.data());
+
+    // Vertex Positions
+    glBindBuffer(GL_ARRAY_BUFFER, vertices.id());
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+}
+
+std::shared_ptr<SphereGeometry> upload(const MeshData& mesh)
+{
+    auto geometry = std::make_shared<SphereGeometry>();
+    size_t positionBytes = mesh.positions.size() * sizeof(glm::vec3);
+    geometry->vertices = gpuPool().acquireBuffer(GL_ARRAY_BUFFER, positionBytes, GL_STATIC_DRAW, "Sphere vertices");
+    geometry->vertices.write(GL_ARRAY_BUFFER, 0, positionBytes, mesh.positions.data());
+
+    std::vector<unsigned int> lines;
+    generateEdgeIndices(mesh.indices, lines);
+
+    geometry->vao = gpuPool().acquireVertexArray("Sphere");
+    setupVertexArray(geometry->vao, geometry->vertices, geometry->indices, mesh.indices, "Sphere indices");
+    geometry->lineVao = gpuPool().acquireVertexArray("Sphere lines");
+    setupVertexArray(geometry->lineVao, geometry->vertices, geometry->lineIndices, lines, "Sphere line indices");
+
+    glBindVertexArray(0);
+    geometry->vertexCount = (unsigned int)mesh.positions.size();
+    geometry->indexCount = (unsigned int)mesh.indices.size();
+    geometry->lineIndexCount = (unsigned int)lines.size();
+    return geometry;
+}
+
+}
+
+std::shared_ptr<const SphereGeometry> GeometryCache::find(Shape shape, float radius, unsigned int a, unsigned int b)
+{
+    for (const Entry& entry : m_entries) {
+        if (entry.shape == shape && entry.radius == radius && entry.a == a && entry.b == b) {
+            ++m_stats.hits;
+            return entry.geometry;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const SphereGeometry> GeometryCache::uvSphere(float radius, unsigned int rings, unsigned int sectors)
+{
+    if (auto geometry = find(Shape::UvSphere, radius, rings, sectors))
+        return geometry;
+    ++m_stats.builds;
+    MeshData mesh;
+    generateUvSphere(radius, rings, sectors, mesh);
+    m_entries.push_back({ Shape::UvSphere, radius, rings, sectors, upload(mesh) });
+    return m_entries.back().geometry;
+}
+
+std::shared_ptr<const SphereGeometry> GeometryCache::icosphere(float radius, unsigned int subdivisions)
+{
+    if (auto geometry = find(Shape::Icosphere, radius, subdivisions, 0))
+        return geometry;
+    ++m_stats.builds;
+    MeshData mesh;
+    generateIcosphere(radius, subdivisions, mesh);
+    m_entries.push_back({ Shape::Icosphere, radius, subdivisions, 0, upload(mesh) });
+    return m_entries.back().geometry;
+}
+
+void GeometryCache::releaseUnused()
+{
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+        [](const Entry& entry) { return entry.geometry.use_count() == 1; }), m_entries.end());
+}
+
+void GeometryCache::clear()
+{
+    m_entries.clear();
+}
+
+GeometryCache& geometryCache()
+{
+    static GeometryCache cache;
+    return cache;
+}
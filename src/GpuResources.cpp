@@ -0,0 +1,360 @@
+#include "GpuResources.h"
+#include <glad/glad.h>
+#include <algorithm>
+
+#include "imgui.h"
+
+namespace {
+
+// GL guarantees at least this many vertex attributes
+const unsigned int kVertexAttribs = 16;
+const size_t kMaxIdleVertexArrays = 64;
+
+unsigned int generate(GlObjectType type)
+{
+    unsigned int id = 0;
+    switch (type) {
+    case GlObjectType::Buffer: glGenBuffers(1, &id); break;
+    case GlObjectType::VertexArray: glGenVertexArrays(1, &id); break;
+    case GlObjectType::Framebuffer: glGenFramebuffers(1, &id); break;
+    case GlObjectType::Renderbuffer: glGenRenderbuffers(1, &id); break;
+    case GlObjectType::Texture: glGenTextures(1, &id); break;
+    case GlObjectType::Count: break;
+    }
+    return id;
+}
+
+void destroy(GlObjectType type, unsigned int id)
+{
+    switch (type) {
+    case GlObjectType::Buffer: glDeleteBuffers(1, &id); break;
+    case GlObjectType::VertexArray: glDeleteVertexArrays(1, &id); break;
+    case GlObjectType::Framebuffer: glDeleteFramebuffers(1, &id); break;
+    case GlObjectType::Renderbuffer: glDeleteRenderbuffers(1, &id); break;
+    case GlObjectType::Texture: glDeleteTextures(1, &id); break;
+    case GlObjectType::Count: break;
+    }
+    gpuObjects().remove(type, id);
+}
+
+// Index of the smallest power-of-two size class holding `bytes`
+size_t sizeClass(size_t bytes)
+{
+    size_t index = 0;
+    while (((size_t)1 << index) < std::max(bytes, GpuPool::kMinBufferClass))
+        ++index;
+    return index;
+}
+
+}
+
+const char* glObjectTypeName(GlObjectType type)
+{
+    switch (type) {
+    case GlObjectType::Buffer: return "Buffer";
+    case GlObjectType::VertexArray: return "Vertex array";
+    case GlObjectType::Framebuffer: return "Framebuffer";
+    case GlObjectType::Renderbuffer: return "Renderbuffer";
+    case GlObjectType::Texture: return "Texture";
+    case GlObjectType::Count: break;
+    }
+    return "?";
+}
+
+template <GlObjectType Type>
+GlObject<Type>::GlObject(const char* label) : m_id(generate(Type))
+{
+    gpuObjects().add(Type, m_id, label);
+}
+
+template <GlObjectType Type>
+void GlObject<Type>::reset()
+{
+    if (!m_id)
+        return;
+    if (Type == GlObjectType::VertexArray && m_pooled)
+        gpuPool().releaseVertexArray(m_id);
+    else
+        destroy(Type, m_id);
+    m_id = 0;
+    m_pooled = false;
+}
+
+template class GlObject<GlObjectType::VertexArray>;
+template class GlObject<GlObjectType::Framebuffer>;
+template class GlObject<GlObjectType::Renderbuffer>;
+template class GlObject<GlObjectType::Texture>;
+
+GlBuffer::GlBuffer(const char* label) : m_id(generate(GlObjectType::Buffer))
+{
+    gpuObjects().add(GlObjectType::Buffer, m_id, label);
+}
+
+GlBuffer::GlBuffer(GlBuffer&& other) noexcept : m_id(other.m_id), m_size(other.m_size), m_pooled(other.m_pooled)
+{
+    other.m_id = 0;
+    other.m_size = 0;
+}
+
+GlBuffer& GlBuffer::operator=(GlBuffer&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        m_id = other.m_id;
+        m_size = other.m_size;
+        m_pooled = other.m_pooled;
+        other.m_id = 0;
+        other.m_size = 0;
+    }
+    return *this;
+}
+
+void GlBuffer::allocate(unsigned int target, size_t bytes, const void* data, unsigned int usage)
+{
+    glBindBuffer(target, m_id);
+    glBufferData(target, bytes, data, usage);
+    m_size = bytes;
+    gpuObjects().setBytes(GlObjectType::Buffer, m_id, bytes);
+}
+
+void GlBuffer::write(unsigned int target, size_t offset, size_t bytes, const void* data)
+{
+    glBindBuffer(target, m_id);
+    if (bytes > 0)
+        glBufferSubData(target, offset, bytes, data);
+}
+
+void GlBuffer::reset()
+{
+    if (!m_id)
+        return;
+    if (m_pooled)
+        gpuPool().releaseBuffer(m_id, m_size);
+    else
+        destroy(GlObjectType::Buffer, m_id);
+    m_id = 0;
+    m_size = 0;
+    m_pooled = false;
+}
+
+void GlObjectRegistry::add(GlObjectType type, unsigned int id, const char* label)
+{
+    Entry& entry = m_entries[key(type, id)];
+    entry = Entry{ type, id, 0, label, false };
+    ++m_totals.live[(size_t)type];
+}
+
+void GlObjectRegistry::remove(GlObjectType type, unsigned int id)
+{
+    auto it = m_entries.find(key(type, id));
+    if (it == m_entries.end())
+        return;
+    setPooled(type, id, false, it->second.label);
+    m_totals.bufferBytes -= it->second.bytes;
+    --m_totals.live[(size_t)type];
+    m_entries.erase(it);
+}
+
+void GlObjectRegistry::setBytes(GlObjectType type, unsigned int id, size_t bytes)
+{
+    auto it = m_entries.find(key(type, id));
+    if (it == m_entries.end())
+        return;
+    m_totals.bufferBytes += bytes - it->second.bytes;
+    it->second.bytes = bytes;
+}
+
+void GlObjectRegistry::setPooled(GlObjectType type, unsigned int id, bool pooled, const char* label)
+{
+    auto it = m_entries.find(key(type, id));
+    if (it == m_entries.end())
+        return;
+    Entry& entry = it->second;
+    entry.label = label;
+    if (entry.pooled == pooled)
+        return;
+    entry.pooled = pooled;
+    if (pooled) {
+        ++m_totals.pooled[(size_t)type];
+        m_totals.pooledBytes += entry.bytes;
+    } else {
+        --m_totals.pooled[(size_t)type];
+        m_totals.pooledBytes -= entry.bytes;
+    }
+}
+
+void GlObjectRegistry::list(std::vector<Entry>& entries) const
+{
+    entries.clear();
+    for (const auto& item : m_entries)
+        entries.push_back(item.second);
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.type != b.type)
+            return a.type < b.type;
+        if (a.bytes != b.bytes)
+            return a.bytes > b.bytes;
+        return a.id < b.id;
+    });
+}
+
+GlObjectRegistry& gpuObjects()
+{
+    static GlObjectRegistry registry;
+    return registry;
+}
+
+GlBuffer GpuPool::acquireBuffer(unsigned int target, size_t bytes, unsigned int usage, const char* label)
+{
+    ++m_stats.acquired;
+    size_t index = sizeClass(bytes);
+    size_t size = (size_t)1 << index;
+    if (m_buffers.size() <= index)
+        m_buffers.resize(index + 1);
+
+    GlBuffer buffer;
+    std::vector<unsigned int>& idle = m_buffers[index];
+    if (!idle.empty()) {
+        ++m_stats.reused;
+        buffer.m_id = idle.back();
+        buffer.m_size = size;
+        idle.pop_back();
+        m_idleBytes -= size;
+        gpuObjects().setPooled(GlObjectType::Buffer, buffer.m_id, false, label);
+        glBindBuffer(target, buffer.m_id);
+    } else {
+        buffer = GlBuffer(label);
+        buffer.allocate(target, size, nullptr, usage);
+    }
+    buffer.m_pooled = true;
+    return buffer;
+}
+
+GlVertexArray GpuPool::acquireVertexArray(const char* label)
+{
+    ++m_stats.acquired;
+    GlVertexArray vertexArray;
+    if (!m_vertexArrays.empty()) {
+        ++m_stats.reused;
+        vertexArray.m_id = m_vertexArrays.back();
+        m_vertexArrays.pop_back();
+        gpuObjects().setPooled(GlObjectType::VertexArray, vertexArray.m_id, false, label);
+    } else {
+        vertexArray = GlVertexArray(label);
+    }
+    vertexArray.m_pooled = true;
+    return vertexArray;
+}
+
+void GpuPool::releaseBuffer(unsigned int id, size_t bytes)
+{
+    ++m_stats.released;
+    size_t index = sizeClass(bytes);
+    // Buffers that were reallocated to an odd size no longer fit a class
+    bool fits = bytes == ((size_t)1 << index) && index < m_buffers.size();
+    if (!fits || m_buffers[index].size() >= kMaxIdlePerClass || m_idleBytes + bytes > kMaxIdleBytes) {
+        ++m_stats.deleted;
+        destroy(GlObjectType::Buffer, id);
+        return;
+    }
+    m_buffers[index].push_back(id);
+    m_idleBytes += bytes;
+    gpuObjects().setPooled(GlObjectType::Buffer, id, true, "(idle)");
+}
+
+void GpuPool::releaseVertexArray(unsigned int id)
+{
+    ++m_stats.released;
+    if (m_vertexArrays.size() >= kMaxIdleVertexArrays) {
+        ++m_stats.deleted;
+        destroy(GlObjectType::VertexArray, id);
+        return;
+    }
+    // Back to the default state, so the next owner starts clean
+    glBindVertexArray(id);
+    for (unsigned int i = 0; i < kVertexAttribs; ++i) {
+        glDisableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 0);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    m_vertexArrays.push_back(id);
+    gpuObjects().setPooled(GlObjectType::VertexArray, id, true, "(idle)");
+}
+
+void GpuPool::clear()
+{
+    for (std::vector<unsigned int>& idle : m_buffers) {
+        for (unsigned int id : idle)
+            destroy(GlObjectType::Buffer, id);
+        idle.clear();
+    }
+    for (unsigned int id : m_vertexArrays)
+        destroy(GlObjectType::VertexArray, id);
+    m_vertexArrays.clear();
+    m_idleBytes = 0;
+}
+
+GpuPool& gpuPool()
+{
+    static GpuPool pool;
+    return pool;
+}
+
+void drawGpuResourcesImGui()
+{
+    const GlObjectRegistry::Totals& totals = gpuObjects().totals();
+    const GpuPool::Stats& pool = gpuPool().stats();
+    ImGui::Text("Buffers %.2f MB, %.2f MB of it idle in the pool", totals.bufferBytes / 1048576.0, totals.pooledBytes / 1048576.0);
+    ImGui::Text("Pool: %llu acquired, %llu reused, %llu released, %llu deleted", (unsigned long long)pool.acquired,
+        (unsigned long long)pool.reused, (unsigned long long)pool.released, (unsigned long long)pool.deleted);
+    if (ImGui::SmallButton("Empty Pool"))
+        gpuPool().clear();
+
+    if (ImGui::BeginTable("gl_totals", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Type");
+        ImGui::TableSetupColumn("Live");
+        ImGui::TableSetupColumn("Idle");
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < (size_t)GlObjectType::Count; ++i) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(glObjectTypeName((GlObjectType)i));
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", totals.live[i]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", totals.pooled[i]);
+        }
+        ImGui::EndTable();
+    }
+
+    // Kept across frames so the listing does not allocate once it has grown
+    static std::vector<GlObjectRegistry::Entry> entries;
+    gpuObjects().list(entries);
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("gl_objects", 4, flags, ImVec2(0.0f, 240.0f))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Type");
+        ImGui::TableSetupColumn("Id");
+        ImGui::TableSetupColumn("KB");
+        ImGui::TableSetupColumn("Owner", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+        ImGuiListClipper clipper;
+        clipper.Begin((int)entries.size());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const GlObjectRegistry::Entry& entry = entries[row];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(glObjectTypeName(entry.type));
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", entry.id);
+                ImGui::TableNextColumn();
+                if (entry.type == GlObjectType::Buffer)
+                    ImGui::Text("%.1f", entry.bytes / 1024.0);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(entry.label ? entry.label : "");
+            }
+        }
+        ImGui::EndTable();
+    }
+}
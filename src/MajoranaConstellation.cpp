@@ -0,0 +1,47 @@
+#include "MajoranaConstellation.h"
+#include "BlochMath.h"
+#include <glad/glad.h>
+
+MajoranaConstellation::MajoranaConstellation() : m_VAO("MajoranaConstellation"), m_count(0)
+{
+    // The star buffer is taken from the pool on the first update
+}
+
+void MajoranaConstellation::update(const std::vector<glm::vec3>& stars)
+{
+    m_scene.resize(stars.size());
+    for (size_t i = 0; i < stars.size(); ++i)
+        m_scene[i] = toScene(stars[i]);
+
+    size_t bytes = m_scene.size() * sizeof(glm::vec3);
+    if (bytes > m_VBO.size()) {
+        m_VBO = gpuPool().acquireBuffer(GL_ARRAY_BUFFER, bytes, GL_STREAM_DRAW, "MajoranaConstellation stars");
+        // One star per instance
+        glBindVertexArray(m_VAO.id());
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribDivisor(0, 1);
+        glBindVertexArray(0);
+    }
+    if (bytes > 0)
+        m_VBO.write(GL_ARRAY_BUFFER, 0, bytes, m_scene.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_count = (unsigned int)m_scene.size();
+}
+
+void MajoranaConstellation::submit(RenderQueue& queue, const Shader& shader, const glm::mat4& model, const glm::vec3& color) const
+{
+    if (m_count == 0)
+        return;
+    DrawPacket packet;
+    packet.shader = &shader;
+    packet.vao = m_VAO.id();
+    packet.primitive = GL_POINTS;
+    packet.count = 1;
+    packet.instances = m_count;
+    packet.model = model;
+    packet.hasColor = true;
+    packet.color = color;
+    packet.state.pointSize = 10.0f;
+    queue.submit(packet);
+}
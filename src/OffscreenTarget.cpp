@@ -0,0 +1,53 @@
+#include "OffscreenTarget.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <iostream>
+
+OffscreenTarget::OffscreenTarget(int width, int height)
+    : m_FBO("OffscreenTarget"), m_colorRBO("OffscreenTarget color"), m_depthRBO("OffscreenTarget depth"),
+      m_width(width), m_height(height)
+{
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorRBO.id());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRBO.id());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FBO.id());
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorRBO.id());
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRBO.id());
+    m_complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!m_complete)
+        std::cout << "ERROR::FRAMEBUFFER:: Offscreen target " << width << "x" << height << " is not complete" << std::endl;
+}
+
+void OffscreenTarget::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FBO.id());
+    glViewport(0, 0, m_width, m_height);
+}
+
+void OffscreenTarget::unbind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void OffscreenTarget::readPixels(std::vector<unsigned char>& rgba) const
+{
+    rgba.resize(static_cast<size_t>(m_width) * m_height * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_FBO.id());
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+int OffscreenTarget::maxSize()
+{
+    GLint renderbufferSize = 0;
+    GLint viewportDims[2] = { 0, 0 };
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &renderbufferSize);
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, viewportDims);
+    return std::min({ renderbufferSize, viewportDims[0], viewportDims[1] });
+}
@@ -0,0 +1,362 @@
+#include "Profiler.h"
+#include "AllocationCounter.h"
+#include "DrawStats.h"
+#include "FrameArena.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "imgui.h"
+
+namespace {
+
+const float kGraphHeight = 90.0f;
+const float kFlameRowHeight = 18.0f;
+const double kBudgetMs = 1000.0 / 60.0;
+
+// Stable color per scope name, so a scope keeps its color across frames
+ImU32 scopeColor(const char* name)
+{
+    uint32_t hash = 2166136261u;
+    for (const char* c = name; *c; ++c)
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    return ImColor::HSV((hash % 360) / 360.0f, 0.55f, 0.85f);
+}
+
+void writeJsonString(FILE* file, const char* text)
+{
+    std::fputc('"', file);
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\')
+            std::fputc('\\', file);
+        if ((unsigned char)*c >= 0x20)
+            std::fputc(*c, file);
+    }
+    std::fputc('"', file);
+}
+
+}
+
+Profiler::Profiler()
+    : m_origin(std::chrono::steady_clock::now()), m_history(kHistory), m_frameIndex(0),
+      m_inFrame(false), m_paused(false), m_depth(0), m_gpuOpen(-1), m_frameAllocations(0), m_queriesLive(true), m_selected(-1), m_exportFrames(120)
+{
+    glGenQueries(2 * kMaxScopes, &m_queries[0][0]);
+}
+
+Profiler::~Profiler()
+{
+    shutdown();
+}
+
+void Profiler::shutdown()
+{
+    if (!m_queriesLive)
+        return;
+    if (m_gpuOpen >= 0) {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_gpuOpen = -1;
+    }
+    glDeleteQueries(2 * kMaxScopes, &m_queries[0][0]);
+    m_queriesLive = false;
+}
+
+double Profiler::nowMs() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_origin).count();
+}
+
+void Profiler::beginFrame()
+{
+    if (m_paused) {
+        // Nothing new is recorded, but results still in flight can land
+        if (m_frameIndex >= 1)
+            collectQueries(m_frameIndex - 1, false);
+        if (m_frameIndex >= 2)
+            collectQueries(m_frameIndex - 2, false);
+        return;
+    }
+
+    // This frame reuses the query set of two frames ago, so read it out first
+    if (m_frameIndex >= 2)
+        collectQueries(m_frameIndex - 2, true);
+
+    Frame& frame = current();
+    frame.index = m_frameIndex;
+    frame.startMs = nowMs();
+    frame.cpuMs = 0.0;
+    frame.gpuMs = 0.0;
+    frame.scopeCount = 0;
+    drawStats().reset();
+    m_frameAllocations = threadHeapAllocations();
+    m_depth = 0;
+    m_gpuOpen = -1;
+    m_inFrame = true;
+}
+
+void Profiler::endFrame()
+{
+    if (!m_inFrame)
+        return;
+    while (m_depth > 0)
+        endScope(m_openScopes[m_depth - 1]);
+    Frame& frame = current();
+    frame.cpuMs = nowMs() - frame.startMs;
+    frame.drawCalls = drawStats().drawCalls;
+    frame.cullTested = drawStats().cullTested;
+    frame.culled = drawStats().culled;
+    frame.occluded = drawStats().occluded;
+    frame.heapAllocations = threadHeapAllocations() - m_frameAllocations;
+    frame.arenaBytes = frameArena().used();
+    m_inFrame = false;
+    ++m_frameIndex;
+}
+
+int Profiler::beginScope(const char* name, bool gpu)
+{
+    if (!m_inFrame)
+        return -1;
+    Frame& frame = current();
+    if (frame.scopeCount == kMaxScopes || m_depth == (int)kMaxScopes)
+        return -1;
+
+    int id = (int)frame.scopeCount++;
+    Scope& scope = frame.scopes[id];
+    scope.name = name;
+    scope.startMs = nowMs() - frame.startMs;
+    scope.cpuMs = 0.0;
+    scope.gpuMs = -1.0;
+    scope.depth = m_depth;
+    scope.query = -1;
+    if (gpu && m_queriesLive && m_gpuOpen < 0) {
+        scope.query = id;
+        m_gpuOpen = id;
+        glBeginQuery(GL_TIME_ELAPSED, m_queries[m_frameIndex % 2][id]);
+    }
+    m_openScopes[m_depth++] = id;
+    return id;
+}
+
+void Profiler::endScope(int id)
+{
+    if (!m_inFrame || id < 0 || m_depth == 0)
+        return;
+    Frame& frame = current();
+    // Close anything left open inside this scope first
+    while (m_depth > 0) {
+        int open = m_openScopes[--m_depth];
+        Scope& scope = frame.scopes[open];
+        scope.cpuMs = nowMs() - frame.startMs - scope.startMs;
+        if (open == m_gpuOpen) {
+            glEndQuery(GL_TIME_ELAPSED);
+            m_gpuOpen = -1;
+        }
+        if (open == id)
+            break;
+    }
+}
+
+void Profiler::collectQueries(uint64_t frameIndex, bool final)
+{
+    Frame& frame = m_history[frameIndex % kHistory];
+    if (frame.index != frameIndex || !m_queriesLive)
+        return;
+    const unsigned int* queries = m_queries[frameIndex % 2];
+    frame.gpuMs = 0.0;
+    for (size_t i = 0; i < frame.scopeCount; ++i) {
+        Scope& scope = frame.scopes[i];
+        if (scope.query < 0)
+            continue;
+        if (scope.gpuMs < 0.0) {
+            GLint available = 0;
+            glGetQueryObjectiv(queries[scope.query], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                if (final)
+                    scope.query = -1;
+                continue;
+            }
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(queries[scope.query], GL_QUERY_RESULT, &elapsedNs);
+            scope.gpuMs = elapsedNs / 1e6;
+        }
+        frame.gpuMs += scope.gpuMs;
+    }
+}
+
+size_t Profiler::frameCount() const
+{
+    // The slot of the frame being recorded is never reported
+    return (size_t)std::min<uint64_t>(m_frameIndex, kHistory - 1);
+}
+
+const Profiler::Frame& Profiler::frame(size_t i) const
+{
+    return m_history[(m_frameIndex - frameCount() + i) % kHistory];
+}
+
+void Profiler::drawImGui()
+{
+    size_t count = frameCount();
+    if (count == 0)
+        return;
+
+    double averageCpu = 0.0, averageGpu = 0.0, worstCpu = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        averageCpu += frame(i).cpuMs;
+        averageGpu += frame(i).gpuMs;
+        worstCpu = std::max(worstCpu, frame(i).cpuMs);
+    }
+    averageCpu /= count;
+    averageGpu /= count;
+    ImGui::Text("CPU %.2f ms avg, %.2f ms worst; GPU %.2f ms avg over %zu frames", averageCpu, worstCpu, averageGpu, count);
+    const Frame& last = frame(count - 1);
+    ImGui::Text("%u draw calls, %llu heap allocations, %.1f KB frame arena last frame", last.drawCalls,
+        (unsigned long long)last.heapAllocations, last.arenaBytes / 1024.0);
+    ImGui::Text("Culling: %u of %u spheres outside the frustum, %u labels and arrows occluded", last.culled,
+        last.cullTested, last.occluded);
+    ImGui::Checkbox("Pause", &m_paused);
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Latest"))
+        m_selected = -1;
+
+    // Rolling bar graph, one bar per frame, stacked by top-level scope
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float width = std::max(ImGui::GetContentRegionAvail().x, 50.0f);
+    ImGui::InvisibleButton("##frames", ImVec2(width, kGraphHeight));
+    bool graphHovered = ImGui::IsItemHovered();
+    double scaleMs = std::max(worstCpu, 2.0 * kBudgetMs);
+    float barWidth = width / kHistory;
+    auto barY = [&](double ms) { return origin.y + kGraphHeight - (float)(ms / scaleMs) * kGraphHeight; };
+
+    drawList->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + kGraphHeight), IM_COL32(20, 20, 20, 255));
+    size_t selected = m_selected >= 0 ? std::min((size_t)m_selected, count - 1) : count - 1;
+    for (size_t i = 0; i < count; ++i) {
+        const Frame& f = frame(i);
+        float x0 = origin.x + (kHistory - count + i) * barWidth;
+        float x1 = x0 + std::max(barWidth - 1.0f, 1.0f);
+        drawList->AddRectFilled(ImVec2(x0, barY(f.cpuMs)), ImVec2(x1, barY(0.0)), IM_COL32(90, 90, 90, 255));
+        for (size_t s = 0; s < f.scopeCount; ++s) {
+            const Scope& scope = f.scopes[s];
+            if (scope.depth != 0)
+                continue;
+            drawList->AddRectFilled(ImVec2(x0, barY(scope.startMs + scope.cpuMs)), ImVec2(x1, barY(scope.startMs)), scopeColor(scope.name));
+        }
+        if (i == selected)
+            drawList->AddRect(ImVec2(x0 - 1.0f, origin.y), ImVec2(x1 + 1.0f, origin.y + kGraphHeight), IM_COL32(255, 255, 255, 255));
+    }
+    drawList->AddLine(ImVec2(origin.x, barY(kBudgetMs)), ImVec2(origin.x + width, barY(kBudgetMs)), IM_COL32(255, 80, 80, 160));
+
+    if (graphHovered) {
+        float offset = (ImGui::GetIO().MousePos.x - origin.x) / barWidth - (kHistory - count);
+        if (offset >= 0.0f) {
+            size_t hovered = std::min((size_t)offset, count - 1);
+            const Frame& f = frame(hovered);
+            ImGui::SetTooltip("Frame %llu\nCPU %.3f ms\nGPU %.3f ms\n%u draw calls\n%llu heap allocations", (unsigned long long)f.index,
+                f.cpuMs, f.gpuMs, f.drawCalls, (unsigned long long)f.heapAllocations);
+            if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+                m_selected = (int)hovered;
+                m_paused = true;
+            }
+        }
+    }
+
+    // Flame view of the selected frame, nested scopes stacked downwards
+    const Frame& shown = frame(selected);
+    int maxDepth = 0;
+    for (size_t s = 0; s < shown.scopeCount; ++s)
+        maxDepth = std::max(maxDepth, shown.scopes[s].depth);
+    origin = ImGui::GetCursorScreenPos();
+    float flameHeight = (maxDepth + 1) * kFlameRowHeight;
+    ImGui::InvisibleButton("##flame", ImVec2(width, flameHeight));
+    bool flameHovered = ImGui::IsItemHovered();
+    double frameMs = std::max(shown.cpuMs, 1e-6);
+    for (size_t s = 0; s < shown.scopeCount; ++s) {
+        const Scope& scope = shown.scopes[s];
+        ImVec2 min(origin.x + (float)(scope.startMs / frameMs) * width, origin.y + scope.depth * kFlameRowHeight);
+        ImVec2 max(std::max(min.x + 1.0f, origin.x + (float)((scope.startMs + scope.cpuMs) / frameMs) * width), min.y + kFlameRowHeight - 1.0f);
+        drawList->AddRectFilled(min, max, scopeColor(scope.name));
+        if (max.x - min.x > ImGui::CalcTextSize(scope.name).x + 4.0f)
+            drawList->AddText(ImVec2(min.x + 2.0f, min.y + 1.0f), IM_COL32(0, 0, 0, 255), scope.name);
+        if (flameHovered && ImGui::IsMouseHoveringRect(min, max))
+            ImGui::SetTooltip("%s\nCPU %.3f ms\nGPU %.3f ms", scope.name, scope.cpuMs, scope.gpuMs);
+    }
+
+    if (ImGui::BeginTable("##scopes", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("CPU ms");
+        ImGui::TableSetupColumn("GPU ms");
+        ImGui::TableHeadersRow();
+        for (size_t s = 0; s < shown.scopeCount; ++s) {
+            const Scope& scope = shown.scopes[s];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Indent(scope.depth * 10.0f + 0.001f);
+            ImGui::TextUnformatted(scope.name);
+            ImGui::Unindent(scope.depth * 10.0f + 0.001f);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", scope.cpuMs);
+            ImGui::TableNextColumn();
+            if (scope.query < 0)
+                ImGui::TextUnformatted("-");
+            else if (scope.gpuMs < 0.0)
+                ImGui::TextUnformatted("pending");
+            else
+                ImGui::Text("%.3f", scope.gpuMs);
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::SliderInt("Frames", &m_exportFrames, 1, (int)kHistory - 1);
+    if (ImGui::Button("Export Chrome Trace")) {
+        if (exportChromeTrace("profile_trace.json", (size_t)m_exportFrames, m_exportStatus))
+            m_exportStatus = "Wrote profile_trace.json";
+    }
+    ImGui::SameLine();
+    ImGui::TextUnformatted(m_exportStatus.c_str());
+}
+
+bool Profiler::exportChromeTrace(const char* path, size_t frames, std::string& error) const
+{
+    FILE* file = std::fopen(path, "w");
+    if (!file) {
+        error = std::string("Could not open ") + path;
+        return false;
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+
+    size_t count = frameCount();
+    frames = std::min(frames, count);
+    double gpuEndUs = 0.0;
+    for (size_t i = count - frames; i < count; ++i) {
+        const Frame& f = frame(i);
+        double frameUs = f.startMs * 1000.0;
+        std::fprintf(file, ",\n{\"name\":\"Frame\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu,\"draw_calls\":%u,\"heap_allocations\":%llu}}",
+            frameUs, f.cpuMs * 1000.0, (unsigned long long)f.index, f.drawCalls, (unsigned long long)f.heapAllocations);
+        for (size_t s = 0; s < f.scopeCount; ++s) {
+            const Scope& scope = f.scopes[s];
+            double startUs = frameUs + scope.startMs * 1000.0;
+            std::fprintf(file, ",\n{\"name\":");
+            writeJsonString(file, scope.name);
+            std::fprintf(file, ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}", startUs, scope.cpuMs * 1000.0);
+            if (scope.gpuMs < 0.0)
+                continue;
+            // The GPU runs its work in order, so a scope cannot start before the previous one ended
+            startUs = std::max(startUs, gpuEndUs);
+            gpuEndUs = startUs + scope.gpuMs * 1000.0;
+            std::fprintf(file, ",\n{\"name\":");
+            writeJsonString(file, scope.name);
+            std::fprintf(file, ",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f}", startUs, scope.gpuMs * 1000.0);
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+
+    bool ok = std::fclose(file) == 0;
+    if (!ok)
+        error = std::string("Could not write ") + path;
+    return ok;
+}
@@ -0,0 +1,66 @@
+#include "QuasiProbabilityMap.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Same sphere as the density map; only one of the two is shown at a time
+const float kRadius = 0.99f;
+const unsigned int kSubdivisions = 5;
+
+}
+
+QuasiProbabilityMap::QuasiProbabilityMap()
+    : m_sphere(geometryCache().icosphere(kRadius, kSubdivisions)), m_texture("Quasi-probability values"),
+      m_width(0), m_height(0), m_low(0.0f), m_high(0.0f)
+{
+}
+
+unsigned int QuasiProbabilityMap::upload(QuasiProbabilityGrid& grid)
+{
+    unsigned int first, end;
+    bool resized = grid.width() != m_width || grid.height() != m_height;
+    if (!grid.takeDirtyRows(first, end) && !resized)
+        return 0;
+
+    glBindTexture(GL_TEXTURE_2D, m_texture.id());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (resized) {
+        // Wraps around in azimuth, stops at the poles
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, grid.width(), grid.height(), 0, GL_RED, GL_FLOAT, grid.values().data());
+        m_width = grid.width();
+        m_height = grid.height();
+        first = 0;
+        end = m_height;
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, m_width, end - first, GL_RED, GL_FLOAT,
+                        grid.values().data() + (size_t)first * m_width);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    grid.series().range(m_low, m_high);
+    return end - first;
+}
+
+void QuasiProbabilityMap::draw(const Shader& shader, const glm::mat4& view, const glm::mat4& projection, const glm::mat4& model) const
+{
+    if (m_width == 0)
+        return;
+    float magnitude = std::max(std::fabs(m_low), std::fabs(m_high));
+    shader.use();
+    shader.setMat4("view", view);
+    shader.setMat4("projection", projection);
+    shader.setMat4("model", model);
+    shader.setInt("values", 0);
+    // Float rounding leaves tiny negatives in the Husimi function
+    shader.setInt("diverging", m_low < -1e-4f * magnitude ? 1 : 0);
+    shader.setFloat("scale", magnitude > 0.0f ? 1.0f / magnitude : 0.0f);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_texture.id());
+    m_sphere.drawInstanced(1, false);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -0,0 +1,171 @@
+#include "RenderQueue.h"
+#include "DrawStats.h"
+#include "Shader.h"
+#include <glad/glad.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+const unsigned int kUnknown = ~0u;
+
+}
+
+RenderQueue::RenderQueue()
+    : m_view(1.0f), m_projection(1.0f), m_sorting(true),
+      m_boundProgram(kUnknown), m_boundVertexArray(kUnknown), m_stateKnown(false)
+{
+}
+
+void RenderQueue::begin(const glm::mat4& view, const glm::mat4& projection)
+{
+    m_view = view;
+    m_projection = projection;
+    m_packets.clear();
+}
+
+void RenderQueue::submit(const DrawPacket& packet)
+{
+    m_packets.push_back(packet);
+}
+
+RenderQueue::Program& RenderQueue::program(unsigned int id)
+{
+    for (Program& program : m_programs) {
+        if (program.id == id)
+            return program;
+    }
+    Program program = {};
+    program.id = id;
+    program.view = glGetUniformLocation(id, "view");
+    program.projection = glGetUniformLocation(id, "projection");
+    program.model = glGetUniformLocation(id, "model");
+    program.color = glGetUniformLocation(id, "lineColor");
+    m_programs.push_back(program);
+    return m_programs.back();
+}
+
+void RenderQueue::setCamera(Program& program)
+{
+    if (program.cameraSet) {
+        m_stats.uniformsSkipped += (program.view >= 0) + (program.projection >= 0);
+        return;
+    }
+    if (program.view >= 0) {
+        glUniformMatrix4fv(program.view, 1, GL_FALSE, glm::value_ptr(m_view));
+        ++m_stats.uniformUpdates;
+    }
+    if (program.projection >= 0) {
+        glUniformMatrix4fv(program.projection, 1, GL_FALSE, glm::value_ptr(m_projection));
+        ++m_stats.uniformUpdates;
+    }
+    program.cameraSet = true;
+}
+
+void RenderQueue::applyState(const RenderState& state)
+{
+    if (!m_stateKnown || state.wireframe != m_state.wireframe) {
+        glPolygonMode(GL_FRONT_AND_BACK, state.wireframe ? GL_LINE : GL_FILL);
+        ++m_stats.stateChanges;
+    }
+    if (!m_stateKnown || state.lineWidth != m_state.lineWidth) {
+        glLineWidth(state.lineWidth);
+        ++m_stats.stateChanges;
+    }
+    if (!m_stateKnown || state.pointSize != m_state.pointSize) {
+        glPointSize(state.pointSize);
+        ++m_stats.stateChanges;
+    }
+    m_state = state;
+    m_stateKnown = true;
+}
+
+void RenderQueue::flush()
+{
+    m_stats = Stats();
+    m_stats.packets = (uint32_t)m_packets.size();
+
+    // Anything may have run since the last flush, so start from scratch
+    m_boundProgram = kUnknown;
+    m_boundVertexArray = kUnknown;
+    m_stateKnown = false;
+    for (Program& program : m_programs) {
+        program.cameraSet = false;
+        program.modelSet = false;
+        program.colorSet = false;
+    }
+
+    m_order.resize(m_packets.size());
+    std::iota(m_order.begin(), m_order.end(), 0u);
+    if (m_sorting) {
+        std::sort(m_order.begin(), m_order.end(), [this](uint32_t a, uint32_t b) {
+            const DrawPacket& x = m_packets[a];
+            const DrawPacket& y = m_packets[b];
+            if (x.shader->ID != y.shader->ID)
+                return x.shader->ID < y.shader->ID;
+            if (x.state.wireframe != y.state.wireframe)
+                return x.state.wireframe < y.state.wireframe;
+            if (x.state.lineWidth != y.state.lineWidth)
+                return x.state.lineWidth < y.state.lineWidth;
+            // Point size is left out: grouping by it would split the line and
+            // point of each vector and cost a model write per packet instead
+            if (x.vao != y.vao)
+                return x.vao < y.vao;
+            return a < b;
+        });
+    }
+
+    for (uint32_t index : m_order) {
+        const DrawPacket& packet = m_packets[index];
+        Program& program = this->program(packet.shader->ID);
+        if (program.id != m_boundProgram) {
+            glUseProgram(program.id);
+            m_boundProgram = program.id;
+            ++m_stats.programBinds;
+        }
+        setCamera(program);
+        if (program.model >= 0) {
+            if (program.modelSet && program.lastModel == packet.model) {
+                ++m_stats.uniformsSkipped;
+            } else {
+                glUniformMatrix4fv(program.model, 1, GL_FALSE, glm::value_ptr(packet.model));
+                program.lastModel = packet.model;
+                program.modelSet = true;
+                ++m_stats.uniformUpdates;
+            }
+        }
+        if (packet.hasColor && program.color >= 0) {
+            if (program.colorSet && program.lastColor == packet.color) {
+                ++m_stats.uniformsSkipped;
+            } else {
+                glUniform3fv(program.color, 1, glm::value_ptr(packet.color));
+                program.lastColor = packet.color;
+                program.colorSet = true;
+                ++m_stats.uniformUpdates;
+            }
+        }
+        applyState(packet.state);
+        if (packet.vao != m_boundVertexArray) {
+            glBindVertexArray(packet.vao);
+            m_boundVertexArray = packet.vao;
+            ++m_stats.vertexArrayBinds;
+        }
+
+        if (packet.indexed) {
+            const void* offset = (const void*)(uintptr_t)(packet.first * sizeof(unsigned int));
+            if (packet.instances > 1)
+                glDrawElementsInstanced(packet.primitive, packet.count, GL_UNSIGNED_INT, offset, packet.instances);
+            else
+                glDrawElements(packet.primitive, packet.count, GL_UNSIGNED_INT, offset);
+        } else {
+            if (packet.instances > 1)
+                glDrawArraysInstanced(packet.primitive, packet.first, packet.count, packet.instances);
+            else
+                glDrawArrays(packet.primitive, packet.first, packet.count);
+        }
+        countDraw(packet.instances);
+        ++m_stats.drawCalls;
+    }
+    m_packets.clear();
+}
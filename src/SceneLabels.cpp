@@ -0,0 +1,43 @@
+#include "SceneLabels.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include "DrawStats.h"
+#include "FrustumCulling.h"
+
+#include "imgui.h"
+
+void drawSceneLabel(const char* id, const glm::vec3& position, const char* text, const glm::mat4& viewProjection, const glm::vec4& viewport)
+{
+    glm::vec3 screen = glm::project(position, glm::mat4(1.0f), viewProjection, viewport);
+    if (screen.z >= 1.0f)
+        return;
+    ImGui::SetNextWindowPos(ImVec2(screen.x, screen.y), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+    ImGui::Begin(id, nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoBackground);
+    ImGui::TextUnformatted(text);
+    ImGui::End();
+}
+
+void drawAxisLabels(const glm::mat4& viewProjection, const glm::vec4& viewport, const glm::vec3& eye)
+{
+    // Scene axes carry the Bloch x, z, y axes, see toScene
+    struct AxisLabel {
+        const char* id;
+        glm::vec3 position;
+        const char* text;
+    };
+    static const AxisLabel kLabels[] = {
+        { "X Label", glm::vec3(1.5f, 0.0f, 0.0f), "(|0> + |1>)/sqrt(2)" },
+        { "Y Label", glm::vec3(0.0f, 1.5f, 0.0f), "|0>" },
+        { "Z Label", glm::vec3(0.0f, 0.0f, 1.5f), "(|0> + i|1>)/sqrt(2)" },
+        { "Neg X Label", glm::vec3(-1.5f, 0.0f, 0.0f), "(|0> - |1>)/sqrt(2)" },
+        { "Neg Y Label", glm::vec3(0.0f, -1.5f, 0.0f), "|1>" },
+        { "Neg Z Label", glm::vec3(0.0f, 0.0f, -1.5f), "(|0> - i|1>)/sqrt(2)" },
+    };
+    for (const AxisLabel& label : kLabels) {
+        // ImGui draws over the scene, so the sphere cannot hide a label by depth
+        if (occludedBySphere(eye, label.position, glm::vec3(0.0f), 1.0f)) {
+            ++drawStats().occluded;
+            continue;
+        }
+        drawSceneLabel(label.id, label.position, label.text, viewProjection, viewport);
+    }
+}
@@ -4,6 +4,8 @@
 #include <sstream>
 #include <iostream>
 
+#include "FrameArena.h"
+
 Shader::Shader(const char* vertexPath, const char* fragmentPath)
 {
     // 1. retrieve the vertex/fragment source code from filePath
@@ -64,19 +66,24 @@ void Shader::use() const
     glUseProgram(ID);
 }
 
-void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
+void Shader::setMat4(std::string_view name, const glm::mat4& mat) const
+{
+    glUniformMatrix4fv(glGetUniformLocation(ID, frameArena().copy(name)), 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setVec3(std::string_view name, const glm::vec3& value) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniform3fv(glGetUniformLocation(ID, frameArena().copy(name)), 1, &value[0]);
 }
 
-void Shader::setVec3(const std::string& name, const glm::vec3& value) const
+void Shader::setFloat(std::string_view name, float value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform1f(glGetUniformLocation(ID, frameArena().copy(name)), value);
 }
 
-void Shader::setFloat(const std::string& name, float value) const
+void Shader::setInt(std::string_view name, int value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1i(glGetUniformLocation(ID, frameArena().copy(name)), value);
 }
 
 void Shader::checkCompileErrors(unsigned int shader, std::string type)
@@ -1,72 +1,33 @@
 #include "Sphere.h"
+#include "DrawStats.h"
 #include <glad/glad.h>
-#include <cmath>
-
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
 
 Sphere::Sphere(float radius, unsigned int rings, unsigned int sectors)
+    : m_geometry(geometryCache().uvSphere(radius, rings, sectors))
 {
-    generateVertices(radius, rings, sectors);
-    setupMesh();
 }
 
-void Sphere::draw() const
+Sphere::Sphere(std::shared_ptr<const SphereGeometry> geometry) : m_geometry(std::move(geometry))
 {
-    glBindVertexArray(m_VAO);
-    glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 }
 
-void Sphere::generateVertices(float radius, unsigned int rings, unsigned int sectors)
+void Sphere::submit(RenderQueue& queue, const Shader& shader, const glm::mat4& model, bool wireframe) const
 {
-    m_positions.clear();
-    m_indices.clear();
-
-    for (unsigned int r = 0; r <= rings; ++r) {
-        for (unsigned int s = 0; s <= sectors; ++s) {
-            float theta = r * M_PI / rings;
-            float phi = s * 2 * M_PI / sectors;
-
-            float x = radius * sin(theta) * cos(phi);
-            float y = radius * cos(theta);
-            float z = radius * sin(theta) * sin(phi);
-
-            m_positions.push_back(glm::vec3(x, y, z));
-        }
-    }
-
-    for (unsigned int r = 0; r < rings; ++r) {
-        for (unsigned int s = 0; s < sectors; ++s) {
-            m_indices.push_back(r * (sectors + 1) + s);
-            m_indices.push_back((r + 1) * (sectors + 1) + s);
-            m_indices.push_back(r * (sectors + 1) + (s + 1));
-
-            m_indices.push_back(r * (sectors + 1) + (s + 1));
-            m_indices.push_back((r + 1) * (sectors + 1) + s);
-            m_indices.push_back((r + 1) * (sectors + 1) + (s + 1));
-        }
-    }
+    DrawPacket packet;
+    packet.shader = &shader;
+    packet.vao = wireframe ? m_geometry->lineVao.id() : m_geometry->vao.id();
+    packet.primitive = wireframe ? GL_LINES : GL_TRIANGLES;
+    packet.indexed = true;
+    packet.count = wireframe ? m_geometry->lineIndexCount : m_geometry->indexCount;
+    packet.model = model;
+    queue.submit(packet);
 }
 
-void Sphere::setupMesh()
+void Sphere::drawInstanced(unsigned int instanceCount, bool wireframe) const
 {
-    glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-    glGenBuffers(1, &m_EBO);
-
-    glBindVertexArray(m_VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, m_positions.size() * sizeof(glm::vec3), &m_positions[0], GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int), &m_indices[0], GL_STATIC_DRAW);
-
-    // Vertex Positions
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
-
+    glBindVertexArray(wireframe ? m_geometry->lineVao.id() : m_geometry->vao.id());
+    glDrawElementsInstanced(wireframe ? GL_LINES : GL_TRIANGLES, wireframe ? m_geometry->lineIndexCount : m_geometry->indexCount,
+                            GL_UNSIGNED_INT, 0, instanceCount);
+    countDraw(instanceCount);
     glBindVertexArray(0);
 }
@@ -0,0 +1,47 @@
+#include "SphereLod.h"
+
+namespace {
+
+// Subdivisions of each level and the smallest radius on screen, in pixels,
+// that uses it; a level has four times the triangles of the next
+const unsigned int kSubdivisions[] = { 5, 4, 3, 2, 1 };
+const float kMinPixels[] = { 320.0f, 140.0f, 60.0f, 24.0f, 0.0f };
+
+std::vector<Sphere> buildLevels(float radius)
+{
+    std::vector<Sphere> levels;
+    for (unsigned int subdivisions : kSubdivisions)
+        levels.emplace_back(geometryCache().icosphere(radius, subdivisions));
+    return levels;
+}
+
+std::vector<uint32_t> triangleCounts(const std::vector<Sphere>& levels)
+{
+    std::vector<uint32_t> counts;
+    for (const Sphere& level : levels)
+        counts.push_back(level.triangleCount());
+    return counts;
+}
+
+}
+
+SphereLod::SphereLod(float radius)
+    : m_radius(radius), m_levels(buildLevels(radius)),
+      m_selector(std::vector<float>(std::begin(kMinPixels), std::end(kMinPixels)), triangleCounts(m_levels))
+{
+}
+
+uint64_t SphereLod::select(const glm::vec3* centers, unsigned int* levels, const uint32_t* indices, size_t count,
+                           const glm::vec3& eye, float fovY, float viewportHeight, uint64_t triangleBudget)
+{
+    m_pixels.resize(count);
+    m_selected.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        m_pixels[i] = projectedRadiusPixels(m_radius, glm::length(centers[indices[i]] - eye), fovY, viewportHeight);
+        m_selected[i] = levels[indices[i]];
+    }
+    uint64_t triangles = m_selector.select(m_pixels.data(), m_selected.data(), count, triangleBudget);
+    for (size_t i = 0; i < count; ++i)
+        levels[indices[i]] = m_selected[i];
+    return triangles;
+}
@@ -1,81 +1,92 @@
 #include "StateVector.h"
+#include "BlochMath.h"
 #include <glad/glad.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <cmath>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
-StateVector::StateVector() : m_drawPrevious(false)
+StateVector::StateVector()
+    : m_VAO("StateVector"), m_prev_VAO("StateVector previous"), m_trail_VAO("StateVector trail"),
+      m_VBO("StateVector vertices"), m_prev_VBO("StateVector previous vertices"),
+      m_trailCount(0), m_drawPrevious(false)
 {
     // Current state vector setup
-    glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBindVertexArray(m_VAO.id());
     glm::vec3 vertices[2] = { glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f) };
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
+    m_VBO.allocate(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
     glEnableVertexAttribArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
     // Previous state vector setup
-    glGenVertexArrays(1, &m_prev_VAO);
-    glGenBuffers(1, &m_prev_VBO);
-    glBindVertexArray(m_prev_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_prev_VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
+    glBindVertexArray(m_prev_VAO.id());
+    m_prev_VBO.allocate(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
     glEnableVertexAttribArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+
+    // The trail buffer is taken from the pool on the first setTrail
 }
 
 void StateVector::update(float theta, float phi)
 {
-    float radTheta = glm::radians(theta);
-    float radPhi = glm::radians(phi);
-
-    float x = sin(radTheta) * cos(radPhi);
-    float y = cos(radTheta);
-    float z = sin(radTheta) * sin(radPhi);
+    update(blochFromAngles(glm::radians(theta), glm::radians(phi)));
+}
 
-    m_currentVector = glm::vec3(x, y, z);
+void StateVector::update(const glm::vec3& bloch)
+{
+    m_currentVector = toScene(bloch);
 
     glm::vec3 vertices[2] = { glm::vec3(0.0f, 0.0f, 0.0f), m_currentVector };
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+    m_VBO.write(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void StateVector::draw(const Shader& shader, const glm::mat4& view, const glm::mat4& projection)
+void StateVector::submit(RenderQueue& queue, const Shader& shader, const glm::mat4& model) const
 {
-    shader.use();
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
-    glm::mat4 model = glm::mat4(1.0f);
-    shader.setMat4("model", model);
+    DrawPacket packet;
+    packet.shader = &shader;
+    packet.model = model;
+    packet.hasColor = true;
 
-    // Draw previous state vector if flag is set
+    // Previous state vector if flag is set, in a dimmed color
     if (m_drawPrevious) {
-        shader.setVec3("lineColor", glm::vec3(1.0f, 1.0f, 0.0f) * 0.5f); // Dimmed color
-        glBindVertexArray(m_prev_VAO);
-        glDrawArrays(GL_LINES, 0, 2);
-        glPointSize(5.0f);
-        glDrawArrays(GL_POINTS, 1, 1);
+        packet.vao = m_prev_VAO.id();
+        packet.color = glm::vec3(1.0f, 1.0f, 0.0f) * 0.5f;
+        packet.primitive = GL_LINES;
+        packet.first = 0;
+        packet.count = 2;
+        queue.submit(packet);
+        packet.primitive = GL_POINTS;
+        packet.first = 1;
+        packet.count = 1;
+        packet.state.pointSize = 5.0f;
+        queue.submit(packet);
+        packet.state.pointSize = 1.0f;
     }
 
-    // Draw current state vector
-    shader.setVec3("lineColor", glm::vec3(1.0f, 1.0f, 0.0f));
-    glBindVertexArray(m_VAO);
-    glDrawArrays(GL_LINES, 0, 2);
-    glPointSize(10.0f);
-    glDrawArrays(GL_POINTS, 1, 1);
+    if (m_trailCount > 1) {
+        packet.vao = m_trail_VAO.id();
+        packet.color = glm::vec3(0.3f, 0.7f, 1.0f);
+        packet.primitive = GL_LINE_STRIP;
+        packet.first = 0;
+        packet.count = (unsigned int)m_trailCount;
+        queue.submit(packet);
+    }
 
-    glBindVertexArray(0);
+    // Current state vector
+    packet.vao = m_VAO.id();
+    packet.color = glm::vec3(1.0f, 1.0f, 0.0f);
+    packet.primitive = GL_LINES;
+    packet.first = 0;
+    packet.count = 2;
+    queue.submit(packet);
+    packet.primitive = GL_POINTS;
+    packet.first = 1;
+    packet.count = 1;
+    packet.state.pointSize = 10.0f;
+    queue.submit(packet);
 }
 
 void StateVector::storePreviousState()
@@ -84,8 +95,7 @@ void StateVector::storePreviousState()
     m_drawPrevious = true;
 
     glm::vec3 vertices[2] = { glm::vec3(0.0f, 0.0f, 0.0f), m_previousVector };
-    glBindBuffer(GL_ARRAY_BUFFER, m_prev_VBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+    m_prev_VBO.write(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
@@ -93,3 +103,25 @@ void StateVector::hidePrevious()
 {
     m_drawPrevious = false;
 }
+
+void StateVector::setTrail(const glm::vec3* points, size_t count)
+{
+    size_t bytes = count * sizeof(glm::vec3);
+    if (bytes > m_trail_VBO.size()) {
+        // Size classes double, so scrubbing with a changing window doesn't
+        // reallocate every frame; the old buffer goes back to the pool
+        m_trail_VBO = gpuPool().acquireBuffer(GL_ARRAY_BUFFER, bytes, GL_STREAM_DRAW, "StateVector trail");
+        glBindVertexArray(m_trail_VAO.id());
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+    }
+    m_trail_VBO.write(GL_ARRAY_BUFFER, 0, bytes, points);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_trailCount = count;
+}
+
+void StateVector::clearTrail()
+{
+    m_trailCount = 0;
+}
@@ -0,0 +1,113 @@
+#include "SweepRenderer.h"
+#include "DrawStats.h"
+#include "OffscreenTarget.h"
+#include "ImageWriter.h"
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+SweepRenderer::SweepRenderer() : m_sphere(0.4f, 8, 8), m_VAO("SweepRenderer"), m_instanceVBO("SweepRenderer instances")
+{
+    glBindVertexArray(m_VAO.id());
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO.id());
+
+    // Per-instance Bloch vector and purity, straight from SweepCell
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SweepCell), (void*)offsetof(SweepCell, bloch));
+    glEnableVertexAttribArray(0);
+    glVertexAttribDivisor(0, 1);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(SweepCell), (void*)offsetof(SweepCell, purity));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void SweepRenderer::uploadCells(const ParameterSweep& sweep)
+{
+    const std::vector<SweepCell>& cells = sweep.cells();
+    size_t bytes = cells.size() * sizeof(SweepCell);
+    if (bytes > m_instanceVBO.size())
+        m_instanceVBO.allocate(GL_ARRAY_BUFFER, bytes, cells.data(), GL_DYNAMIC_DRAW);
+    else
+        m_instanceVBO.write(GL_ARRAY_BUFFER, 0, bytes, cells.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool SweepRenderer::renderSheet(const ParameterSweep& sweep, int cellSize, const Shader& sphereShader, const Shader& vectorShader, const char* path)
+{
+    unsigned int columns = sweep.columns();
+    unsigned int rows = sweep.rows();
+    unsigned int count = columns * rows;
+    if (count == 0) {
+        m_status = "Nothing to render";
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    int maxSize = OffscreenTarget::maxSize();
+    cellSize = std::max(1, std::min({ cellSize, maxSize / (int)columns, maxSize / (int)rows }));
+    OffscreenTarget target(cellSize * columns, cellSize * rows);
+    if (!target.isComplete()) {
+        m_status = "Could not create offscreen target";
+        return false;
+    }
+
+    uploadCells(sweep);
+
+    GLint previousViewport[4];
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+    target.bind();
+    glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    drawSheet(columns, rows, std::max(2.0f, cellSize / 16.0f), sphereShader, vectorShader);
+
+    std::vector<unsigned char> pixels;
+    target.readPixels(pixels);
+    target.unbind();
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+
+    bool written = writeTga(path, target.width(), target.height(), pixels.data());
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    char buffer[256];
+    if (written)
+        snprintf(buffer, sizeof(buffer), "%u cells, %dx%d px, rendered in %.1f ms -> %s", count, target.width(), target.height(), elapsedMs, path);
+    else
+        snprintf(buffer, sizeof(buffer), "Failed to write %s", path);
+    m_status = buffer;
+    return written;
+}
+
+void SweepRenderer::drawSheet(unsigned int columns, unsigned int rows, float pointSize, const Shader& sphereShader, const Shader& vectorShader)
+{
+    // One unit per tile with row 0 at the top of the sheet. Every tile shares the
+    // same slightly raised view of the sphere so the vectors read as 3D.
+    glm::mat4 projection = glm::ortho(0.0f, (float)columns, (float)rows, 0.0f, -2.0f, 2.0f);
+    glm::mat4 tileModel = glm::mat4(glm::mat3(glm::lookAt(glm::vec3(0.5f, 0.35f, -1.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f))));
+    tileModel = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, -1.0f, 1.0f)) * tileModel; // undo the flipped y of the projection
+
+    sphereShader.use();
+    sphereShader.setMat4("projection", projection);
+    sphereShader.setMat4("tileModel", tileModel);
+    sphereShader.setInt("columns", columns);
+    m_sphere.drawInstanced(columns * rows, true);
+
+    vectorShader.use();
+    vectorShader.setMat4("projection", projection);
+    vectorShader.setMat4("tileModel", tileModel);
+    vectorShader.setInt("columns", columns);
+    vectorShader.setFloat("pointSize", pointSize);
+    glBindVertexArray(m_VAO.id());
+    glDrawArraysInstanced(GL_LINES, 0, 2, columns * rows);
+    countDraw(columns * rows);
+    glDrawArraysInstanced(GL_POINTS, 1, 1, columns * rows);
+    countDraw(columns * rows);
+    glBindVertexArray(0);
+}
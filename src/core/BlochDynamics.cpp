@@ -0,0 +1,30 @@
+#include "BlochDynamics.h"
+#include "Gates.h"
+#include <cmath>
+
+glm::vec3 evolveBloch(glm::vec3 bloch, const BlochEquationParams& params, float duration, unsigned int steps)
+{
+    if (steps == 0 || duration <= 0.0f)
+        return bloch;
+
+    float dt = duration / steps;
+
+    // The field is constant, so the per-step propagator is built once.
+    glm::vec3 field(params.rabi, 0.0f, params.detuning);
+    float strength = glm::length(field);
+    glm::mat3 precession(1.0f);
+    if (strength > 0.0f)
+        precession = rotationGate(field / strength, strength * dt).matrix;
+
+    float transverseDecay = params.t2 > 0.0f ? std::exp(-dt / params.t2) : 1.0f;
+    float longitudinalDecay = params.t1 > 0.0f ? std::exp(-dt / params.t1) : 1.0f;
+
+    for (unsigned int i = 0; i < steps; ++i) {
+        bloch = precession * bloch;
+        bloch.x *= transverseDecay;
+        bloch.y *= transverseDecay;
+        // T1 relaxes towards the ground state |0>, i.e. z = +1
+        bloch.z = 1.0f + (bloch.z - 1.0f) * longitudinalDecay;
+    }
+    return bloch;
+}
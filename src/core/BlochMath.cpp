@@ -0,0 +1,77 @@
+#include "BlochMath.h"
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+glm::vec3 blochFromAngles(float theta, float phi)
+{
+    return glm::vec3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+}
+
+void blochToAngles(const glm::vec3& bloch, float& theta, float& phi)
+{
+    glm::vec3 n = glm::normalize(bloch);
+    theta = std::acos(glm::clamp(n.z, -1.0f, 1.0f));
+    phi = std::atan2(n.y, n.x);
+    if (phi < 0.0f)
+        phi += 2.0f * glm::pi<float>();
+}
+
+glm::vec3 toScene(const glm::vec3& bloch)
+{
+    return glm::vec3(bloch.x, bloch.z, bloch.y);
+}
+
+glm::vec3 fromScene(const glm::vec3& scene)
+{
+    return glm::vec3(scene.x, scene.z, scene.y);
+}
+
+glm::vec3 interpolateBloch(const glm::vec3& a, const glm::vec3& b, float t)
+{
+    float lengthA = glm::length(a);
+    float lengthB = glm::length(b);
+    float length = lengthA + (lengthB - lengthA) * t;
+    if (lengthA <= 1e-6f || lengthB <= 1e-6f)
+        return a + (b - a) * t;
+
+    glm::vec3 u = a / lengthA;
+    glm::vec3 v = b / lengthB;
+    float cosAngle = glm::clamp(glm::dot(u, v), -1.0f, 1.0f);
+    float angle = std::acos(cosAngle);
+    // Nearly parallel (or exactly opposite, where the arc is undefined)
+    if (angle < 1e-4f || angle > glm::pi<float>() - 1e-4f)
+        return a + (b - a) * t;
+    float sinAngle = std::sin(angle);
+    glm::vec3 direction = (std::sin((1.0f - t) * angle) * u + std::sin(t * angle) * v) / sinAngle;
+    return direction * length;
+}
+
+float purity(const glm::vec3& bloch)
+{
+    return 0.5f * (1.0f + glm::dot(bloch, bloch));
+}
+
+Amplitudes amplitudesFromBloch(const glm::vec3& bloch)
+{
+    float length = glm::length(bloch);
+    if (length <= 0.0f)
+        return { 1.0f, 0.0f };
+
+    // alpha = cos(theta/2) and beta = e^{i phi} sin(theta/2), written with
+    // half-angle identities so no trigonometry is needed
+    glm::vec3 n = bloch / length;
+    float alpha = std::sqrt(0.5f * (1.0f + n.z));
+    if (alpha < 1e-6f)
+        return { 0.0f, 1.0f };
+    return { alpha, std::complex<float>(n.x, n.y) / (2.0f * alpha) };
+}
+
+glm::vec3 blochFromAmplitudes(const Amplitudes& amplitudes)
+{
+    // x + iy = 2 conj(alpha) beta, z = |alpha|^2 - |beta|^2
+    std::complex<float> coherence = 2.0f * std::conj(amplitudes.alpha) * amplitudes.beta;
+    float norm = std::norm(amplitudes.alpha) + std::norm(amplitudes.beta);
+    if (norm <= 0.0f)
+        return glm::vec3(0.0f);
+    return glm::vec3(coherence.real(), coherence.imag(), std::norm(amplitudes.alpha) - std::norm(amplitudes.beta)) / norm;
+}
@@ -0,0 +1,94 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+uintptr_t alignUp(uintptr_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~uintptr_t(alignment - 1);
+}
+
+}
+
+FrameArena::FrameArena(size_t capacity)
+    : m_block(new unsigned char[capacity]), m_capacity(capacity), m_used(0),
+      m_chunkSize(0), m_chunkUsed(0), m_overflowUsed(0), m_peak(0)
+{
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_block.get());
+    uintptr_t start = alignUp(base + m_used, alignment);
+    if (start + bytes <= base + m_capacity) {
+        m_used = start + bytes - base;
+        return reinterpret_cast<void*>(start);
+    }
+
+    // Out of room this frame; reset() sizes the block to fit next time
+    if (!m_overflow.empty()) {
+        base = reinterpret_cast<uintptr_t>(m_overflow.back().get());
+        start = alignUp(base + m_chunkUsed, alignment);
+        if (start + bytes <= base + m_chunkSize) {
+            m_chunkUsed = start + bytes - base;
+            return reinterpret_cast<void*>(start);
+        }
+    }
+    m_overflowUsed += m_chunkUsed;
+    m_chunkSize = std::max(m_capacity, bytes + alignment);
+    m_overflow.emplace_back(new unsigned char[m_chunkSize]);
+    base = reinterpret_cast<uintptr_t>(m_overflow.back().get());
+    start = alignUp(base, alignment);
+    m_chunkUsed = start + bytes - base;
+    return reinterpret_cast<void*>(start);
+}
+
+const char* FrameArena::copy(std::string_view text)
+{
+    char* out = static_cast<char*>(allocate(text.size() + 1, 1));
+    std::memcpy(out, text.data(), text.size());
+    out[text.size()] = '\0';
+    return out;
+}
+
+const char* FrameArena::format(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    va_list measure;
+    va_copy(measure, args);
+    int length = std::vsnprintf(nullptr, 0, fmt, measure);
+    va_end(measure);
+    if (length < 0) {
+        va_end(args);
+        return "";
+    }
+    char* out = static_cast<char*>(allocate((size_t)length + 1, 1));
+    std::vsnprintf(out, (size_t)length + 1, fmt, args);
+    va_end(args);
+    return out;
+}
+
+void FrameArena::reset()
+{
+    m_peak = std::max(m_peak, used());
+    if (!m_overflow.empty()) {
+        // Grow once to what this frame needed, with room to spare
+        m_capacity = std::max(m_capacity * 2, used() + used() / 2);
+        m_block.reset(new unsigned char[m_capacity]);
+        m_overflow.clear();
+    }
+    m_used = 0;
+    m_chunkSize = 0;
+    m_chunkUsed = 0;
+    m_overflowUsed = 0;
+}
+
+FrameArena& frameArena()
+{
+    static FrameArena arena;
+    return arena;
+}
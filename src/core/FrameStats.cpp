@@ -0,0 +1,100 @@
+#include "FrameStats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+}
+
+FrameStats summarizeFrames(const std::string& scene, std::vector<double>& frameMs, uint32_t drawCalls)
+{
+    std::sort(frameMs.begin(), frameMs.end());
+    FrameStats stats;
+    stats.scene = scene;
+    stats.frames = (uint32_t)frameMs.size();
+    stats.p50Ms = percentile(frameMs, 50.0);
+    stats.p95Ms = percentile(frameMs, 95.0);
+    stats.p99Ms = percentile(frameMs, 99.0);
+    stats.drawCalls = drawCalls;
+    return stats;
+}
+
+bool readBaseline(const char* path, std::vector<FrameStats>& scenes, std::string& error)
+{
+    std::ifstream file(path);
+    if (!file) {
+        error = std::string("Could not open ") + path;
+        return false;
+    }
+    scenes.clear();
+    std::string line;
+    for (int number = 1; std::getline(file, line); ++number) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+        std::istringstream fields(line);
+        FrameStats stats;
+        if (!(fields >> stats.scene >> stats.p50Ms >> stats.p95Ms >> stats.p99Ms >> stats.drawCalls)) {
+            error = std::string(path) + ":" + std::to_string(number) + ": expected scene p50_ms p95_ms p99_ms draw_calls";
+            return false;
+        }
+        scenes.push_back(stats);
+    }
+    return true;
+}
+
+bool writeBaseline(const char* path, const std::vector<FrameStats>& scenes, std::string& error)
+{
+    FILE* file = std::fopen(path, "w");
+    if (!file) {
+        error = std::string("Could not create ") + path;
+        return false;
+    }
+    std::fprintf(file, "# scene p50_ms p95_ms p99_ms draw_calls\n");
+    for (const FrameStats& stats : scenes)
+        std::fprintf(file, "%s %.4f %.4f %.4f %u\n", stats.scene.c_str(), stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.drawCalls);
+    if (std::fclose(file) != 0) {
+        error = std::string("Could not write ") + path;
+        return false;
+    }
+    return true;
+}
+
+bool withinBaseline(const FrameStats& current, const FrameStats& baseline, const BaselineTolerance& tolerance, std::string& reason)
+{
+    const struct {
+        const char* name;
+        double current, baseline;
+    } times[] = {
+        { "p50", current.p50Ms, baseline.p50Ms },
+        { "p95", current.p95Ms, baseline.p95Ms },
+        { "p99", current.p99Ms, baseline.p99Ms },
+    };
+    char buffer[128];
+    for (const auto& time : times) {
+        double limit = time.baseline * (1.0 + tolerance.timePercent / 100.0) + tolerance.slackMs;
+        if (time.current > limit) {
+            std::snprintf(buffer, sizeof(buffer), "%s %.3f ms > %.3f ms", time.name, time.current, limit);
+            reason = buffer;
+            return false;
+        }
+    }
+    double drawLimit = baseline.drawCalls * (1.0 + tolerance.drawPercent / 100.0);
+    if (current.drawCalls > drawLimit) {
+        std::snprintf(buffer, sizeof(buffer), "%u draw calls > %.0f", current.drawCalls, drawLimit);
+        reason = buffer;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+#include "FrustumCulling.h"
+#include "Simd.h"
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProjection)
+{
+    // Rows of the matrix; each plane is the last row plus or minus another
+    glm::mat4 m = glm::transpose(viewProjection);
+    Frustum frustum;
+    frustum.planes[0] = m[3] + m[0];  // left
+    frustum.planes[1] = m[3] - m[0];  // right
+    frustum.planes[2] = m[3] + m[1];  // bottom
+    frustum.planes[3] = m[3] - m[1];  // top
+    frustum.planes[4] = m[3] + m[2];  // near
+    frustum.planes[5] = m[3] - m[2];  // far
+    for (glm::vec4& plane : frustum.planes)
+        plane /= glm::length(glm::vec3(plane));
+    return frustum;
+}
+
+bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const
+{
+    for (const glm::vec4& plane : planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+            return false;
+    }
+    return true;
+}
+
+void BoundingSpheres::clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+void BoundingSpheres::add(const glm::vec3& center, float r)
+{
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(r);
+}
+
+size_t cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, uint32_t* visible)
+{
+    size_t count = spheres.size();
+    size_t visibleCount = 0;
+    size_t i = 0;
+
+#ifdef BLOCH_SSE
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; ++p) {
+        planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(&spheres.x[i]);
+        __m128 y = _mm_loadu_ps(&spheres.y[i]);
+        __m128 z = _mm_loadu_ps(&spheres.z[i]);
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+        // A lane stays set while its sphere is not wholly outside any plane
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, planeX[p]), _mm_mul_ps(y, planeY[p])),
+                                         _mm_add_ps(_mm_mul_ps(z, planeZ[p]), planeW[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; ++lane) {
+            if (mask & (1 << lane))
+                visible[visibleCount++] = (uint32_t)(i + lane);
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        if (frustum.intersectsSphere(glm::vec3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]))
+            visible[visibleCount++] = (uint32_t)i;
+    }
+    return visibleCount;
+}
+
+bool occludedBySphere(const glm::vec3& eye, const glm::vec3& point, const glm::vec3& center, float radius)
+{
+    glm::vec3 toPoint = point - eye;
+    glm::vec3 fromCenter = point - center;
+    // On or inside the sphere: hidden when on the half facing away
+    if (glm::dot(fromCenter, fromCenter) <= radius * radius)
+        return glm::dot(fromCenter, toPoint) > 0.0f;
+    // Outside: hidden when the segment from the eye passes through the sphere
+    float lengthSquared = glm::dot(toPoint, toPoint);
+    if (lengthSquared == 0.0f)
+        return false;
+    float t = glm::clamp(glm::dot(center - eye, toPoint) / lengthSquared, 0.0f, 1.0f);
+    glm::vec3 closest = eye + t * toPoint - center;
+    return glm::dot(closest, closest) < radius * radius;
+}
@@ -0,0 +1,131 @@
+#include "GateScript.h"
+#include "BlochMath.h"
+#include <cctype>
+#include <charconv>
+
+namespace {
+
+const int kMaxArguments = 5;
+
+struct GateSpec {
+    const char* name;
+    int arguments;
+    BlochChannel (*make)(const float* args);
+};
+
+const GateSpec kGates[] = {
+    { "i", 0, [](const float*) { return BlochChannel(); } },
+    { "x", 0, [](const float*) { return pauliX(); } },
+    { "y", 0, [](const float*) { return pauliY(); } },
+    { "z", 0, [](const float*) { return pauliZ(); } },
+    { "h", 0, [](const float*) { return hadamard(); } },
+    { "s", 0, [](const float*) { return phaseS(); } },
+    { "sdg", 0, [](const float*) { return phaseSdg(); } },
+    { "t", 0, [](const float*) { return phaseT(); } },
+    { "tdg", 0, [](const float*) { return phaseTdg(); } },
+    { "rx", 1, [](const float* a) { return rotationGate(glm::vec3(1, 0, 0), a[0]); } },
+    { "ry", 1, [](const float* a) { return rotationGate(glm::vec3(0, 1, 0), a[0]); } },
+    { "rz", 1, [](const float* a) { return rotationGate(glm::vec3(0, 0, 1), a[0]); } },
+    { "reset", 0, [](const float*) { return resetTo(glm::vec3(0, 0, 1)); } },
+    { "init", 2, [](const float* a) { return resetTo(blochFromAngles(a[0], a[1])); } },
+    { "depol", 1, [](const float* a) { return depolarizing(a[0]); } },
+    { "dephase", 1, [](const float* a) { return dephasing(a[0]); } },
+    { "ampdamp", 1, [](const float* a) { return amplitudeDamping(a[0]); } },
+    { "evolve", 5, [](const float* a) { return blochEquationChannel({ a[0], a[1], a[2], a[3] }, a[4], 256); } },
+};
+
+bool isSeparator(char c)
+{
+    return c == ' ' || c == '\t' || c == ';' || c == '\r' || c == '\n';
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+bool nameEquals(const char* name, size_t length, const char* expected)
+{
+    size_t i = 0;
+    for (; i < length && expected[i]; ++i) {
+        if (std::tolower((unsigned char)name[i]) != expected[i])
+            return false;
+    }
+    return i == length && expected[i] == '\0';
+}
+
+}
+
+bool parseCircuit(const char* begin, const char* end, std::vector<BlochChannel>& ops, std::string& error)
+{
+    ops.clear();
+
+    const char* p = begin;
+    while (p < end) {
+        while (p < end && isSeparator(*p))
+            ++p;
+        if (p == end || *p == '#')
+            break;
+
+        const char* name = p;
+        while (p < end && (std::isalnum((unsigned char)*p) || *p == '_'))
+            ++p;
+        size_t nameLength = p - name;
+
+        float args[kMaxArguments];
+        int argCount = 0;
+        if (p < end && *p == '(') {
+            ++p;
+            for (;;) {
+                while (p < end && isSpace(*p))
+                    ++p;
+                if (argCount == kMaxArguments) {
+                    error = "too many arguments to '" + std::string(name, nameLength) + "'";
+                    return false;
+                }
+                std::from_chars_result result = std::from_chars(p, end, args[argCount]);
+                if (result.ec != std::errc()) {
+                    error = "bad number in '" + std::string(name, nameLength) + "'";
+                    return false;
+                }
+                ++argCount;
+                p = result.ptr;
+                while (p < end && isSpace(*p))
+                    ++p;
+                if (p < end && *p == ',') {
+                    ++p;
+                    continue;
+                }
+                if (p < end && *p == ')') {
+                    ++p;
+                    break;
+                }
+                error = "expected ',' or ')' after argument of '" + std::string(name, nameLength) + "'";
+                return false;
+            }
+        }
+
+        if (nameLength == 0 || (p < end && !isSeparator(*p) && *p != '#')) {
+            error = "unexpected character '" + std::string(1, p < end ? *p : ' ') + "'";
+            return false;
+        }
+
+        const GateSpec* spec = nullptr;
+        for (const GateSpec& candidate : kGates) {
+            if (nameEquals(name, nameLength, candidate.name)) {
+                spec = &candidate;
+                break;
+            }
+        }
+        if (!spec) {
+            error = "unknown gate '" + std::string(name, nameLength) + "'";
+            return false;
+        }
+        if (spec->arguments != argCount) {
+            error = "'" + std::string(name, nameLength) + "' takes " + std::to_string(spec->arguments) + " argument(s)";
+            return false;
+        }
+        ops.push_back(spec->make(args));
+    }
+    return true;
+}
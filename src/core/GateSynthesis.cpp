@@ -0,0 +1,460 @@
+#include "GateSynthesis.h"
+#include "Endian.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unordered_set>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const unsigned char kMagic[4] = { 'C', 'T', 'N', 'T' };
+const uint32_t kVersion = 1;
+const size_t kHeaderSize = 16;
+// Unitaries whose canonical quaternions round to the same grid point at this
+// scale are the same gate; Clifford+T entries are sums of 1/sqrt(2) powers,
+// so distinct ones differ by far more
+const double kDedupScale = 1e8;
+
+// Picks the sign of q so that its first clearly nonzero component is positive
+glm::dquat canonical(const glm::dquat& q)
+{
+    const double components[4] = { q.w, q.x, q.y, q.z };
+    for (double c : components) {
+        if (std::fabs(c) > 1e-9)
+            return c < 0.0 ? -q : q;
+    }
+    return q;
+}
+
+struct QuaternionKey {
+    int64_t c[4];
+    bool operator==(const QuaternionKey& other) const { return std::memcmp(c, other.c, sizeof(c)) == 0; }
+};
+
+struct QuaternionKeyHash {
+    size_t operator()(const QuaternionKey& key) const
+    {
+        uint64_t h = 1469598103934665603ull;
+        for (int64_t c : key.c)
+            h = (h ^ (uint64_t)c) * 1099511628211ull;
+        return (size_t)h;
+    }
+};
+
+QuaternionKey keyOf(const glm::dquat& q)
+{
+    glm::dquat c = canonical(q);
+    return { { std::llround(c.w * kDedupScale), std::llround(c.x * kDedupScale), std::llround(c.y * kDedupScale),
+               std::llround(c.z * kDedupScale) } };
+}
+
+glm::dquat axisAngle(const glm::dvec3& axis, double angle)
+{
+    double s = std::sin(0.5 * angle);
+    return glm::dquat(std::cos(0.5 * angle), s * axis.x, s * axis.y, s * axis.z);
+}
+
+// Rotation angle in [0, pi] and unit axis of q up to sign
+void toAxisAngle(const glm::dquat& q, glm::dvec3& axis, double& angle)
+{
+    glm::dquat c = q.w < 0.0 ? -q : q;
+    glm::dvec3 v(c.x, c.y, c.z);
+    double s = glm::length(v);
+    angle = 2.0 * std::atan2(s, c.w);
+    axis = s > 0.0 ? v / s : glm::dvec3(0.0, 0.0, 1.0);
+}
+
+// Balanced group commutator: V and W with V W V^-1 W^-1 = delta, each a
+// rotation by about the square root of delta's angle (Dawson and Nielsen)
+void groupCommutator(const glm::dquat& delta, glm::dquat& v, glm::dquat& w)
+{
+    glm::dvec3 axis;
+    double theta;
+    toAxisAngle(delta, axis, theta);
+    double phi = 2.0 * std::asin(std::sqrt(std::sin(0.25 * theta)));
+    glm::dquat vx = axisAngle(glm::dvec3(1.0, 0.0, 0.0), phi);
+    glm::dquat wy = axisAngle(glm::dvec3(0.0, 1.0, 0.0), phi);
+    glm::dquat commutator = vx * wy * glm::conjugate(vx) * glm::conjugate(wy);
+
+    // Same angle as delta; turn its axis onto delta's
+    glm::dvec3 commutatorAxis;
+    double commutatorAngle;
+    toAxisAngle(commutator, commutatorAxis, commutatorAngle);
+    glm::dvec3 cross = glm::cross(commutatorAxis, axis);
+    double crossLength = glm::length(cross);
+    glm::dquat turn(1.0, 0.0, 0.0, 0.0);
+    if (crossLength > 1e-12)
+        turn = axisAngle(cross / crossLength, std::atan2(crossLength, glm::dot(commutatorAxis, axis)));
+    else if (glm::dot(commutatorAxis, axis) < 0.0)
+        turn = axisAngle(glm::abs(commutatorAxis.x) < 0.9 ? glm::normalize(glm::cross(commutatorAxis, glm::dvec3(1, 0, 0)))
+                                                         : glm::normalize(glm::cross(commutatorAxis, glm::dvec3(0, 1, 0))), kPi);
+    v = turn * vx * glm::conjugate(turn);
+    w = turn * wy * glm::conjugate(turn);
+}
+
+void appendInverse(const std::vector<CliffordTGate>& gates, std::vector<CliffordTGate>& out)
+{
+    // H^-1 = H, S^-1 = S^3 and T^-1 = T S^3, up to phase
+    for (size_t i = gates.size(); i-- > 0;) {
+        switch (gates[i]) {
+        case CliffordTGate::H:
+            out.push_back(CliffordTGate::H);
+            break;
+        case CliffordTGate::S:
+            out.insert(out.end(), 3, CliffordTGate::S);
+            break;
+        case CliffordTGate::T:
+            out.push_back(CliffordTGate::T);
+            out.insert(out.end(), 3, CliffordTGate::S);
+            break;
+        }
+    }
+}
+
+std::vector<CliffordTGate> solovayKitaev(const CliffordTNet& net, const glm::dquat& target, unsigned int depth)
+{
+    std::vector<CliffordTGate> gates;
+    if (depth == 0) {
+        double distance;
+        net.word(net.nearest(target, distance), gates);
+        return gates;
+    }
+    std::vector<CliffordTGate> previous = solovayKitaev(net, target, depth - 1);
+    glm::dquat delta = target * glm::conjugate(sequenceQuaternion(previous));
+    glm::dquat v, w;
+    groupCommutator(delta, v, w);
+    std::vector<CliffordTGate> vGates = solovayKitaev(net, v, depth - 1);
+    std::vector<CliffordTGate> wGates = solovayKitaev(net, w, depth - 1);
+    simplifyCliffordT(vGates);
+    simplifyCliffordT(wGates);
+
+    // V W V^-1 W^-1 U_previous, applied right to left
+    gates.swap(previous);
+    appendInverse(wGates, gates);
+    appendInverse(vGates, gates);
+    gates.insert(gates.end(), wGates.begin(), wGates.end());
+    gates.insert(gates.end(), vGates.begin(), vGates.end());
+    simplifyCliffordT(gates);
+    return gates;
+}
+
+}
+
+glm::dquat cliffordTQuaternion(CliffordTGate gate)
+{
+    switch (gate) {
+    case CliffordTGate::H:
+        return glm::dquat(0.0, std::sqrt(0.5), 0.0, std::sqrt(0.5));
+    case CliffordTGate::S:
+        return axisAngle(glm::dvec3(0.0, 0.0, 1.0), 0.5 * kPi);
+    case CliffordTGate::T:
+        return axisAngle(glm::dvec3(0.0, 0.0, 1.0), 0.25 * kPi);
+    }
+    return glm::dquat(1.0, 0.0, 0.0, 0.0);
+}
+
+glm::dquat sequenceQuaternion(const std::vector<CliffordTGate>& gates)
+{
+    glm::dquat q(1.0, 0.0, 0.0, 0.0);
+    for (CliffordTGate gate : gates)
+        q = cliffordTQuaternion(gate) * q;
+    return q;
+}
+
+double gateDistance(const glm::dquat& a, const glm::dquat& b)
+{
+    double overlap = glm::dot(a, b);
+    return std::sqrt(std::max(0.0, 1.0 - overlap * overlap));
+}
+
+void simplifyCliffordT(std::vector<CliffordTGate>& gates)
+{
+    std::vector<CliffordTGate> out;
+    out.reserve(gates.size());
+    size_t i = 0;
+    while (i < gates.size()) {
+        if (gates[i] == CliffordTGate::H) {
+            if (!out.empty() && out.back() == CliffordTGate::H)
+                out.pop_back();
+            else
+                out.push_back(CliffordTGate::H);
+            ++i;
+            continue;
+        }
+        // A run of diagonal gates is T^k
+        unsigned int k = 0;
+        for (; i < gates.size() && gates[i] != CliffordTGate::H; ++i)
+            k += gates[i] == CliffordTGate::S ? 2 : 1;
+        // Fold in a run the previous H cancellation exposed
+        while (!out.empty() && out.back() != CliffordTGate::H) {
+            k += out.back() == CliffordTGate::S ? 2 : 1;
+            out.pop_back();
+        }
+        k %= 8;
+        out.insert(out.end(), k / 2, CliffordTGate::S);
+        if (k % 2)
+            out.push_back(CliffordTGate::T);
+    }
+    gates.swap(out);
+}
+
+std::string formatCliffordT(const std::vector<CliffordTGate>& gates)
+{
+    if (gates.empty())
+        return "I";
+    static const char kNames[] = { 'H', 'S', 'T' };
+    std::string text;
+    text.reserve(gates.size() * 2);
+    for (CliffordTGate gate : gates) {
+        if (!text.empty())
+            text += ' ';
+        text += kNames[(int)gate];
+    }
+    return text;
+}
+
+unsigned int tCount(const std::vector<CliffordTGate>& gates)
+{
+    return (unsigned int)std::count(gates.begin(), gates.end(), CliffordTGate::T);
+}
+
+void CliffordTNet::build(unsigned int maxLength, size_t maxEntries)
+{
+    maxLength = std::min(maxLength, kMaxWordLength);
+    m_words.clear();
+    m_maxLength = 0;
+
+    struct Pending {
+        uint64_t word;
+        glm::dquat q;
+    };
+    std::unordered_set<QuaternionKey, QuaternionKeyHash> seen;
+    std::vector<Pending> frontier = { { 0, glm::dquat(1.0, 0.0, 0.0, 0.0) } }, next;
+    std::vector<glm::dquat> unitaries = { frontier[0].q };
+    seen.insert(keyOf(frontier[0].q));
+    m_words.push_back(0);
+
+    const CliffordTGate kGates[] = { CliffordTGate::H, CliffordTGate::S, CliffordTGate::T };
+    for (unsigned int length = 1; length <= maxLength && m_words.size() < maxEntries; ++length) {
+        next.clear();
+        for (const Pending& pending : frontier) {
+            for (CliffordTGate gate : kGates) {
+                glm::dquat q = cliffordTQuaternion(gate) * pending.q;
+                if (!seen.insert(keyOf(q)).second)
+                    continue;
+                uint64_t word = (pending.word & ~uint64_t(31)) | (uint64_t)gate << (5 + 2 * (length - 1)) | length;
+                next.push_back({ word, q });
+                m_words.push_back(word);
+                unitaries.push_back(q);
+                if (m_words.size() >= maxEntries)
+                    break;
+            }
+            if (m_words.size() >= maxEntries)
+                break;
+        }
+        frontier.swap(next);
+        m_maxLength = length;
+    }
+
+    m_points.resize(m_words.size());
+    for (size_t i = 0; i < unitaries.size(); ++i) {
+        glm::dquat q = unitaries[i].w < 0.0 ? -unitaries[i] : unitaries[i];
+        m_points[i] = glm::vec4((float)q.x, (float)q.y, (float)q.z, (float)q.w);
+    }
+    buildIndex();
+}
+
+void CliffordTNet::buildIndex()
+{
+    // Arrange an index permutation, then apply it to points and words at once
+    std::vector<uint32_t> order(m_words.size());
+    for (uint32_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    m_axes.assign(m_words.size(), 0);
+    buildNode(order, 0, (uint32_t)order.size());
+
+    std::vector<glm::vec4> points(order.size());
+    std::vector<uint64_t> words(order.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        points[i] = m_points[order[i]];
+        words[i] = m_words[order[i]];
+    }
+    m_points.swap(points);
+    m_words.swap(words);
+}
+
+void CliffordTNet::buildNode(std::vector<uint32_t>& order, uint32_t begin, uint32_t end)
+{
+    if (end - begin <= 1)
+        return;
+    glm::vec4 lower(INFINITY), upper(-INFINITY);
+    for (uint32_t i = begin; i < end; ++i) {
+        lower = glm::min(lower, m_points[order[i]]);
+        upper = glm::max(upper, m_points[order[i]]);
+    }
+    glm::vec4 extent = upper - lower;
+    uint8_t axis = 0;
+    for (uint8_t a = 1; a < 4; ++a) {
+        if (extent[a] > extent[axis])
+            axis = a;
+    }
+
+    uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                     [&](uint32_t a, uint32_t b) { return m_points[a][axis] < m_points[b][axis]; });
+    m_axes[middle] = axis;
+    buildNode(order, begin, middle);
+    buildNode(order, middle + 1, end);
+}
+
+void CliffordTNet::search(const glm::vec4& query, uint32_t begin, uint32_t end, float& best, uint32_t& bestEntry) const
+{
+    while (begin < end) {
+        uint32_t middle = begin + (end - begin) / 2;
+        glm::vec4 offset = m_points[middle] - query;
+        float distance = glm::dot(offset, offset);
+        if (distance < best) {
+            best = distance;
+            bestEntry = middle;
+        }
+        if (end - begin == 1)
+            return;
+        uint8_t axis = m_axes[middle];
+        float split = query[axis] - m_points[middle][axis];
+        // Near side first, the far side only if the splitting plane is closer than the best
+        if (split < 0.0f) {
+            search(query, begin, middle, best, bestEntry);
+            if (split * split >= best)
+                return;
+            begin = middle + 1;
+        } else {
+            search(query, middle + 1, end, best, bestEntry);
+            if (split * split >= best)
+                return;
+            end = middle;
+        }
+    }
+}
+
+uint32_t CliffordTNet::nearest(const glm::dquat& target, double& distance) const
+{
+    uint32_t entry = 0;
+    distance = 1.0;
+    if (m_words.empty())
+        return entry;
+    glm::vec4 query((float)target.x, (float)target.y, (float)target.z, (float)target.w);
+    float best = INFINITY;
+    search(query, 0, (uint32_t)m_words.size(), best, entry);
+    search(-query, 0, (uint32_t)m_words.size(), best, entry);
+
+    std::vector<CliffordTGate> gates;
+    word(entry, gates);
+    distance = gateDistance(sequenceQuaternion(gates), target);
+    return entry;
+}
+
+void CliffordTNet::word(uint32_t entry, std::vector<CliffordTGate>& gates) const
+{
+    uint64_t packed = m_words[entry];
+    unsigned int length = packed & 31;
+    gates.resize(length);
+    for (unsigned int i = 0; i < length; ++i)
+        gates[i] = (CliffordTGate)((packed >> (5 + 2 * i)) & 3);
+}
+
+size_t CliffordTNet::memoryBytes() const
+{
+    return m_words.size() * sizeof(uint64_t) + m_points.size() * sizeof(glm::vec4) + m_axes.size();
+}
+
+size_t CliffordTNet::fileBytes() const
+{
+    return kHeaderSize + m_words.size() * sizeof(uint64_t);
+}
+
+bool CliffordTNet::save(const char* path, std::string& error) const
+{
+    FILE* file = std::fopen(path, "wb");
+    if (!file) {
+        error = std::string("Could not create ") + path;
+        return false;
+    }
+    unsigned char header[kHeaderSize];
+    std::memcpy(header, kMagic, 4);
+    unsigned char* out = storeLE(header + 4, kVersion);
+    out = storeLE(out, (uint32_t)m_words.size());
+    storeLE(out, (uint32_t)m_maxLength);
+    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+    // Tree order is as good as any, and loading rebuilds the tree anyway
+    std::vector<unsigned char> words(m_words.size() * sizeof(uint64_t));
+    for (size_t i = 0; i < m_words.size(); ++i)
+        storeLE(&words[i * sizeof(uint64_t)], m_words[i]);
+    ok = ok && std::fwrite(words.data(), 1, words.size(), file) == words.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok)
+        error = std::string("Could not write ") + path;
+    return ok;
+}
+
+bool CliffordTNet::load(const char* path, std::string& error)
+{
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        error = std::string("Could not open ") + path;
+        return false;
+    }
+    unsigned char header[kHeaderSize];
+    if (std::fread(header, 1, sizeof(header), file) != sizeof(header) || std::memcmp(header, kMagic, 4) != 0) {
+        std::fclose(file);
+        error = std::string(path) + " is not a Clifford+T net";
+        return false;
+    }
+    if (loadLE32(header + 4) != kVersion) {
+        std::fclose(file);
+        error = std::string(path) + " has an unsupported version";
+        return false;
+    }
+    uint32_t count = loadLE32(header + 8);
+    uint32_t maxLength = loadLE32(header + 12);
+    std::vector<unsigned char> words((size_t)count * sizeof(uint64_t));
+    bool ok = std::fread(words.data(), 1, words.size(), file) == words.size();
+    std::fclose(file);
+    if (!ok || maxLength > kMaxWordLength) {
+        error = std::string(path) + " is truncated or corrupt";
+        return false;
+    }
+
+    m_words.resize(count);
+    m_points.resize(count);
+    std::vector<CliffordTGate> gates;
+    for (uint32_t i = 0; i < count; ++i) {
+        m_words[i] = loadLE64(&words[(size_t)i * sizeof(uint64_t)]);
+        if ((m_words[i] & 31) > maxLength) {
+            m_words.clear();
+            m_points.clear();
+            error = std::string(path) + " is truncated or corrupt";
+            return false;
+        }
+        word(i, gates);
+        glm::dquat q = sequenceQuaternion(gates);
+        if (q.w < 0.0)
+            q = -q;
+        m_points[i] = glm::vec4((float)q.x, (float)q.y, (float)q.z, (float)q.w);
+    }
+    m_maxLength = maxLength;
+    buildIndex();
+    return true;
+}
+
+SynthesisResult synthesizeCliffordT(const CliffordTNet& net, const glm::dquat& target, unsigned int depth)
+{
+    SynthesisResult result;
+    result.gates = solovayKitaev(net, target, depth);
+    simplifyCliffordT(result.gates);
+    result.unitary = sequenceQuaternion(result.gates);
+    result.distance = gateDistance(result.unitary, target);
+    return result;
+}
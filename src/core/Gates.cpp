@@ -0,0 +1,102 @@
+#include "Gates.h"
+#include <cmath>
+
+namespace {
+
+const float kPi = 3.14159265358979323846f;
+
+}
+
+BlochChannel compose(const BlochChannel& first, const BlochChannel& second)
+{
+    return { second.matrix * first.matrix, second.matrix * first.offset + second.offset };
+}
+
+BlochChannel rotationGate(const glm::vec3& axis, float angle)
+{
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    float t = 1.0f - c;
+    // Rodrigues' formula; glm matrices are column-major
+    glm::mat3 matrix(
+        t * axis.x * axis.x + c,          t * axis.x * axis.y + s * axis.z, t * axis.x * axis.z - s * axis.y,
+        t * axis.x * axis.y - s * axis.z, t * axis.y * axis.y + c,          t * axis.y * axis.z + s * axis.x,
+        t * axis.x * axis.z + s * axis.y, t * axis.y * axis.z - s * axis.x, t * axis.z * axis.z + c);
+    return { matrix, glm::vec3(0.0f) };
+}
+
+BlochChannel pauliX()
+{
+    return { glm::mat3(glm::vec3(1, 0, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, -1)), glm::vec3(0.0f) };
+}
+
+BlochChannel pauliY()
+{
+    return { glm::mat3(glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, -1)), glm::vec3(0.0f) };
+}
+
+BlochChannel pauliZ()
+{
+    return { glm::mat3(glm::vec3(-1, 0, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1)), glm::vec3(0.0f) };
+}
+
+BlochChannel hadamard()
+{
+    // Swaps x and z, negates y
+    return { glm::mat3(glm::vec3(0, 0, 1), glm::vec3(0, -1, 0), glm::vec3(1, 0, 0)), glm::vec3(0.0f) };
+}
+
+BlochChannel phaseS()
+{
+    // Quarter turn about z: x -> y, y -> -x
+    return { glm::mat3(glm::vec3(0, 1, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 0, 1)), glm::vec3(0.0f) };
+}
+
+BlochChannel phaseSdg()
+{
+    return { glm::mat3(glm::vec3(0, -1, 0), glm::vec3(1, 0, 0), glm::vec3(0, 0, 1)), glm::vec3(0.0f) };
+}
+
+BlochChannel phaseT()
+{
+    return rotationGate(glm::vec3(0.0f, 0.0f, 1.0f), kPi / 4.0f);
+}
+
+BlochChannel phaseTdg()
+{
+    return rotationGate(glm::vec3(0.0f, 0.0f, 1.0f), -kPi / 4.0f);
+}
+
+BlochChannel resetTo(const glm::vec3& bloch)
+{
+    return { glm::mat3(0.0f), bloch };
+}
+
+BlochChannel depolarizing(float p)
+{
+    return { glm::mat3(1.0f - p), glm::vec3(0.0f) };
+}
+
+BlochChannel dephasing(float p)
+{
+    float transverse = 1.0f - 2.0f * p;
+    return { glm::mat3(glm::vec3(transverse, 0, 0), glm::vec3(0, transverse, 0), glm::vec3(0, 0, 1)), glm::vec3(0.0f) };
+}
+
+BlochChannel amplitudeDamping(float gamma)
+{
+    float transverse = std::sqrt(1.0f - gamma);
+    return { glm::mat3(glm::vec3(transverse, 0, 0), glm::vec3(0, transverse, 0), glm::vec3(0, 0, 1.0f - gamma)), glm::vec3(0.0f, 0.0f, gamma) };
+}
+
+BlochChannel blochEquationChannel(const BlochEquationParams& params, float duration, unsigned int steps)
+{
+    BlochChannel channel;
+    channel.offset = evolveBloch(glm::vec3(0.0f), params, duration, steps);
+    for (int axis = 0; axis < 3; ++axis) {
+        glm::vec3 basis(0.0f);
+        basis[axis] = 1.0f;
+        channel.matrix[axis] = evolveBloch(basis, params, duration, steps) - channel.offset;
+    }
+    return channel;
+}
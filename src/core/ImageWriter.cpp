@@ -0,0 +1,38 @@
+#include "ImageWriter.h"
+#include <cstdio>
+#include <vector>
+
+bool writeTga(const char* path, int width, int height, const unsigned char* rgba)
+{
+    if (width <= 0 || height <= 0 || width > 0xFFFF || height > 0xFFFF)
+        return false;
+
+    FILE* file = std::fopen(path, "wb");
+    if (!file)
+        return false;
+
+    unsigned char header[18] = {};
+    header[2] = 2; // uncompressed true-color
+    header[12] = width & 0xFF;
+    header[13] = (width >> 8) & 0xFF;
+    header[14] = height & 0xFF;
+    header[15] = (height >> 8) & 0xFF;
+    header[16] = 32;
+    header[17] = 8; // 8 alpha bits, bottom-left origin
+    bool ok = std::fwrite(header, sizeof(header), 1, file) == 1;
+
+    // TGA stores BGRA, so swizzle one row at a time
+    std::vector<unsigned char> row(static_cast<size_t>(width) * 4);
+    for (int y = 0; y < height && ok; ++y) {
+        const unsigned char* src = rgba + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; ++x) {
+            row[x * 4 + 0] = src[x * 4 + 2];
+            row[x * 4 + 1] = src[x * 4 + 1];
+            row[x * 4 + 2] = src[x * 4 + 0];
+            row[x * 4 + 3] = src[x * 4 + 3];
+        }
+        ok = std::fwrite(row.data(), row.size(), 1, file) == 1;
+    }
+
+    return std::fclose(file) == 0 && ok;
+}
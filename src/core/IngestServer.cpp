@@ -0,0 +1,274 @@
+#include "IngestServer.h"
+#include "StatePacket.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+#else
+using NativeSocket = int;
+#endif
+
+const intptr_t kNoSocket = -1;
+// Datagrams taken per receive call
+const int kReceiveBatch = 64;
+const uint32_t kQueueMagic = 0x42494E51; // "BINQ"
+
+NativeSocket native(intptr_t socket)
+{
+    return static_cast<NativeSocket>(socket);
+}
+
+void closeSocket(intptr_t socket)
+{
+#ifdef _WIN32
+    closesocket(native(socket));
+#else
+    ::close(native(socket));
+#endif
+}
+
+#ifdef _WIN32
+// Undoes WSAStartup when start() gives up before the receive thread owns it
+struct WinsockGuard {
+    bool armed = true;
+    ~WinsockGuard()
+    {
+        if (armed)
+            WSACleanup();
+    }
+};
+#endif
+
+}
+
+IngestServer::IngestServer(uint32_t queueCapacity)
+    : m_running(false), m_socket(kNoSocket), m_haveSequence(false), m_nextSequence(0),
+      m_packets(0), m_samples(0), m_lostPackets(0), m_malformed(0), m_latencyMs(0.0), m_maxLatencyMs(0.0)
+{
+    uint32_t capacity = 1;
+    while (capacity < queueCapacity)
+        capacity <<= 1;
+    m_queueMemory.reset(new unsigned char[SpscRing<StateSample>::bytesFor(capacity) + 64]);
+    // The control block wants cache-line alignment
+    void* aligned = reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(m_queueMemory.get()) + 63) & ~uintptr_t(63));
+    SpscRing<StateSample>::initialize(aligned, capacity, kQueueMagic, 1);
+    m_queue.attach(aligned);
+}
+
+IngestServer::~IngestServer()
+{
+    stop();
+}
+
+bool IngestServer::start(Transport transport, const char* address, std::string& error)
+{
+    stop();
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        error = "WSAStartup failed";
+        return false;
+    }
+    WinsockGuard winsock;
+    if (transport == Transport::Unix) {
+        error = "Unix sockets are not supported on this platform";
+        return false;
+    }
+#endif
+
+    intptr_t fd = kNoSocket;
+    if (transport == Transport::Udp) {
+        int port = std::atoi(address);
+        if (port <= 0 || port > 65535) {
+            error = "invalid port '" + std::string(address) + "'";
+            return false;
+        }
+        NativeSocket created = ::socket(AF_INET, SOCK_DGRAM, 0);
+        fd = created == static_cast<NativeSocket>(-1) ? kNoSocket : static_cast<intptr_t>(created);
+        sockaddr_in local = {};
+        local.sin_family = AF_INET;
+        local.sin_port = htons(static_cast<unsigned short>(port));
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd != kNoSocket && ::bind(native(fd), reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            closeSocket(fd);
+            fd = kNoSocket;
+        }
+    }
+#ifndef _WIN32
+    else {
+        sockaddr_un local = {};
+        local.sun_family = AF_UNIX;
+        if (std::strlen(address) >= sizeof(local.sun_path)) {
+            error = "socket path too long";
+            return false;
+        }
+        std::strcpy(local.sun_path, address);
+        // A stale socket file from a previous run would make bind fail, but
+        // anything else at that path belongs to someone else
+        struct stat existing;
+        if (::lstat(address, &existing) == 0) {
+            if (!S_ISSOCK(existing.st_mode)) {
+                error = "'" + std::string(address) + "' exists and is not a socket";
+                return false;
+            }
+            ::unlink(address);
+        }
+        fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (fd != kNoSocket && ::bind(native(fd), reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            closeSocket(fd);
+            fd = kNoSocket;
+        }
+        if (fd != kNoSocket)
+            m_unixPath = address;
+    }
+#endif
+    if (fd == kNoSocket) {
+        error = "cannot bind to '" + std::string(address) + "'";
+        return false;
+    }
+
+    // Wake up periodically so stop() doesn't have to interrupt a blocked receive
+#ifdef _WIN32
+    DWORD timeoutMs = 100;
+    setsockopt(native(fd), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeoutMs), sizeof(timeoutMs));
+#else
+    timeval timeout = { 0, 100000 };
+    setsockopt(native(fd), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+    int bufferSize = 4 << 20;
+    setsockopt(native(fd), SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+
+#ifdef _WIN32
+    winsock.armed = false;  // stop() cleans up from here on
+#endif
+    m_socket = fd;
+    m_haveSequence = false;
+    m_running.store(true);
+    m_thread = std::thread(&IngestServer::run, this);
+    return true;
+}
+
+void IngestServer::stop()
+{
+    if (!m_thread.joinable())
+        return;
+    m_running.store(false);
+    m_thread.join();
+    closeSocket(m_socket);
+    m_socket = kNoSocket;
+#ifndef _WIN32
+    if (!m_unixPath.empty())
+        ::unlink(m_unixPath.c_str());
+#else
+    WSACleanup();
+#endif
+    m_unixPath.clear();
+}
+
+IngestServer::Counters IngestServer::counters() const
+{
+    Counters counters;
+    counters.packets = m_packets.load(std::memory_order_relaxed);
+    counters.samples = m_samples.load(std::memory_order_relaxed);
+    counters.lostPackets = m_lostPackets.load(std::memory_order_relaxed);
+    counters.queueDrops = m_queue.dropped();
+    counters.malformed = m_malformed.load(std::memory_order_relaxed);
+    counters.latencyMs = m_latencyMs.load(std::memory_order_relaxed);
+    counters.maxLatencyMs = m_maxLatencyMs.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void IngestServer::run()
+{
+    // One byte of slack so oversized datagrams fail to decode where the
+    // platform truncates them without saying so
+    const size_t bufferSize = kMaxStatePacketSize + 1;
+    std::vector<unsigned char> storage(kReceiveBatch * bufferSize);
+
+#ifdef __linux__
+    mmsghdr messages[kReceiveBatch];
+    iovec vectors[kReceiveBatch];
+    for (int i = 0; i < kReceiveBatch; ++i) {
+        vectors[i] = { storage.data() + i * bufferSize, bufferSize };
+        messages[i] = {};
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+
+    while (m_running.load(std::memory_order_relaxed)) {
+#ifdef __linux__
+        // Blocks for the first datagram, then takes whatever else is queued
+        int received = recvmmsg(native(m_socket), messages, kReceiveBatch, MSG_WAITFORONE, nullptr);
+        for (int i = 0; i < received; ++i) {
+            if (messages[i].msg_hdr.msg_flags & MSG_TRUNC)
+                m_malformed.fetch_add(1, std::memory_order_relaxed);
+            else
+                handleDatagram(storage.data() + i * bufferSize, messages[i].msg_len);
+        }
+#else
+        int size = recvfrom(native(m_socket), reinterpret_cast<char*>(storage.data()), static_cast<int>(bufferSize), 0, nullptr, nullptr);
+        if (size > 0)
+            handleDatagram(storage.data(), static_cast<size_t>(size));
+#ifdef _WIN32
+        // Windows drops the rest of an oversized datagram and fails the call
+        else if (size < 0 && WSAGetLastError() == WSAEMSGSIZE)
+            m_malformed.fetch_add(1, std::memory_order_relaxed);
+#endif
+#endif
+    }
+}
+
+void IngestServer::handleDatagram(const unsigned char* data, size_t size)
+{
+    StateSample samples[kMaxSamplesPerPacket];
+    uint32_t sequence = 0;
+    size_t count = 0;
+    if (!decodeStatePacket(data, size, sequence, samples, count)) {
+        m_malformed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // A sequence number behind the expected one means the sender restarted
+    if (m_haveSequence && static_cast<int32_t>(sequence - m_nextSequence) > 0)
+        m_lostPackets.fetch_add(sequence - m_nextSequence, std::memory_order_relaxed);
+    m_nextSequence = sequence + 1;
+    m_haveSequence = true;
+
+    double now = steadySeconds();
+    double worst = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        m_queue.tryPush(samples[i]);
+        worst = std::max(worst, (now - samples[i].timestamp) * 1000.0);
+    }
+
+    m_packets.fetch_add(1, std::memory_order_relaxed);
+    m_samples.fetch_add(count, std::memory_order_relaxed);
+    if (count > 0) {
+        double newest = (now - samples[count - 1].timestamp) * 1000.0;
+        m_latencyMs.store(0.95 * m_latencyMs.load(std::memory_order_relaxed) + 0.05 * newest, std::memory_order_relaxed);
+        if (worst > m_maxLatencyMs.load(std::memory_order_relaxed))
+            m_maxLatencyMs.store(worst, std::memory_order_relaxed);
+    }
+}
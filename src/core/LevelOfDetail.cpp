@@ -0,0 +1,63 @@
+#include "LevelOfDetail.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+float projectedRadiusPixels(float radius, float distance, float fovY, float viewportHeight)
+{
+    // Inside the sphere it covers the screen
+    if (distance <= radius)
+        return viewportHeight;
+    // Angular radius of the sphere's silhouette, projected to pixels
+    float angle = std::asin(radius / distance);
+    return std::tan(angle) / std::tan(0.5f * fovY) * 0.5f * viewportHeight;
+}
+
+LodSelector::LodSelector(std::vector<float> minPixels, std::vector<uint32_t> triangles, float hysteresis)
+    : m_minPixels(std::move(minPixels)), m_triangles(std::move(triangles)), m_hysteresis(hysteresis)
+{
+    // The coarsest level takes everything that is left
+    if (!m_minPixels.empty())
+        m_minPixels.back() = 0.0f;
+}
+
+unsigned int LodSelector::choose(float pixels, unsigned int current) const
+{
+    unsigned int level = std::min<unsigned int>(current, (unsigned int)m_minPixels.size() - 1);
+    while (level > 0 && pixels >= m_minPixels[level - 1] * (1.0f + m_hysteresis))
+        --level;
+    while (level + 1 < m_minPixels.size() && pixels < m_minPixels[level] * (1.0f - m_hysteresis))
+        ++level;
+    return level;
+}
+
+uint64_t LodSelector::select(const float* pixels, unsigned int* levels, size_t count, uint64_t budget)
+{
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        levels[i] = choose(pixels[i], levels[i]);
+        total += m_triangles[levels[i]];
+    }
+    if (total <= budget)
+        return total;
+
+    m_order.resize(count);
+    std::iota(m_order.begin(), m_order.end(), 0u);
+    std::sort(m_order.begin(), m_order.end(), [pixels](uint32_t a, uint32_t b) { return pixels[a] < pixels[b]; });
+    unsigned int coarsest = (unsigned int)m_minPixels.size() - 1;
+    bool coarsened = true;
+    while (total > budget && coarsened) {
+        coarsened = false;
+        for (uint32_t i : m_order) {
+            if (levels[i] == coarsest)
+                continue;
+            total -= m_triangles[levels[i]];
+            ++levels[i];
+            total += m_triangles[levels[i]];
+            coarsened = true;
+            if (total <= budget)
+                break;
+        }
+    }
+    return total;
+}
@@ -0,0 +1,338 @@
+#include "MajoranaStars.h"
+#include <algorithm>
+#include <cmath>
+#include "Simd.h"
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const unsigned int kMaxIterations = 200;
+// Converged once every step is this small relative to its root
+const double kTolerance = 1e-12;
+// Coefficients this small relative to the largest count as zero
+const double kZeroCoefficient = 1e-14;
+// Rounding error of one Horner step, relative to the sum of the terms' moduli
+const double kRounding = 2.2e-16;
+// A state this close to coherent has all its stars at its own direction; the
+// 2j-fold root is too ill-conditioned to find as such
+const double kCoherentTolerance = 1e-10;
+
+double binomial(unsigned int n, unsigned int k)
+{
+    double value = 1.0;
+    for (unsigned int i = 1; i <= k; ++i)
+        value = value * (n - k + i) / i;
+    return value;
+}
+
+glm::vec3 starFromRoot(double re, double im)
+{
+    // Inverse stereographic projection from the south pole
+    double r2 = re * re + im * im;
+    double scale = 1.0 / (1.0 + r2);
+    return glm::vec3((float)(2.0 * re * scale), (float)(2.0 * im * scale), (float)((1.0 - r2) * scale));
+}
+
+// p(z) / p'(z) for a monic polynomial of degree n at one root. Large roots
+// use the reversed polynomial in 1/z, which keeps Horner's rule in range.
+// Returns true when |p(z)| is down to the rounding error of evaluating it,
+// past which further steps only chase noise.
+bool newtonRatio(const double* coefRe, const double* coefIm, const double* coefAbs, unsigned int n,
+                 double zr, double zi, double& outRe, double& outIm)
+{
+    bool reversed = zr * zr + zi * zi > 1.0;
+    double xr = zr, xi = zi;
+    if (reversed) {
+        double d = zr * zr + zi * zi;
+        xr = zr / d;
+        xi = -zi / d;
+    }
+    double xAbs = std::hypot(xr, xi);
+    double sr = 0.0, si = 0.0, dr = 0.0, di = 0.0, bound = 0.0;
+    for (unsigned int i = 0; i <= n; ++i) {
+        unsigned int k = reversed ? i : n - i;
+        // d = d x + s, then s = s x + c_k
+        double tr = dr * xr - di * xi + sr;
+        di = dr * xi + di * xr + si;
+        dr = tr;
+        tr = sr * xr - si * xi + coefRe[k];
+        si = sr * xi + si * xr + coefIm[k];
+        sr = tr;
+        bound = bound * xAbs + coefAbs[k];
+    }
+    bool settled = std::hypot(sr, si) <= kRounding * (n + 1) * bound;
+    if (!reversed) {
+        double d = dr * dr + di * di;
+        outRe = (sr * dr + si * di) / d;
+        outIm = (si * dr - sr * di) / d;
+        return settled;
+    }
+    // p(z) = z^n q(w), so p / p' = z / (n - w q'(w) / q(w)) with w = 1/z
+    double q = sr * sr + si * si;
+    double ur = (dr * sr + di * si) / q, ui = (di * sr - dr * si) / q;  // q' / q
+    double denomRe = n - (xr * ur - xi * ui), denomIm = -(xr * ui + xi * ur);
+    double d = denomRe * denomRe + denomIm * denomIm;
+    outRe = (zr * denomRe + zi * denomIm) / d;
+    outIm = (zi * denomRe - zr * denomIm) / d;
+    return settled;
+}
+
+#ifdef BLOCH_SSE
+// newtonRatio for the two roots at z, each lane picking its own direction
+__m128d newtonRatio2(const double* coefRe, const double* coefIm, const double* coefAbs, unsigned int n,
+                     __m128d zr, __m128d zi, __m128d& outRe, __m128d& outIm)
+{
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d z2 = _mm_add_pd(_mm_mul_pd(zr, zr), _mm_mul_pd(zi, zi));
+    __m128d reversed = _mm_cmpgt_pd(z2, one);
+    __m128d inv = _mm_div_pd(one, z2);
+    __m128d xr = _mm_or_pd(_mm_and_pd(reversed, _mm_mul_pd(zr, inv)), _mm_andnot_pd(reversed, zr));
+    __m128d xi = _mm_or_pd(_mm_and_pd(reversed, _mm_sub_pd(_mm_setzero_pd(), _mm_mul_pd(zi, inv))), _mm_andnot_pd(reversed, zi));
+    __m128d xAbs = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(xr, xr), _mm_mul_pd(xi, xi)));
+
+    __m128d sr = _mm_setzero_pd(), si = _mm_setzero_pd(), dr = _mm_setzero_pd(), di = _mm_setzero_pd();
+    __m128d bound = _mm_setzero_pd();
+    for (unsigned int i = 0; i <= n; ++i) {
+        unsigned int k = n - i;
+        __m128d cr = _mm_or_pd(_mm_and_pd(reversed, _mm_set1_pd(coefRe[i])), _mm_andnot_pd(reversed, _mm_set1_pd(coefRe[k])));
+        __m128d ci = _mm_or_pd(_mm_and_pd(reversed, _mm_set1_pd(coefIm[i])), _mm_andnot_pd(reversed, _mm_set1_pd(coefIm[k])));
+        __m128d ca = _mm_or_pd(_mm_and_pd(reversed, _mm_set1_pd(coefAbs[i])), _mm_andnot_pd(reversed, _mm_set1_pd(coefAbs[k])));
+        __m128d tr = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(dr, xr), _mm_mul_pd(di, xi)), sr);
+        di = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dr, xi), _mm_mul_pd(di, xr)), si);
+        dr = tr;
+        tr = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(sr, xr), _mm_mul_pd(si, xi)), cr);
+        si = _mm_add_pd(_mm_add_pd(_mm_mul_pd(sr, xi), _mm_mul_pd(si, xr)), ci);
+        sr = tr;
+        bound = _mm_add_pd(_mm_mul_pd(bound, xAbs), ca);
+    }
+    __m128d s2 = _mm_add_pd(_mm_mul_pd(sr, sr), _mm_mul_pd(si, si));
+    __m128d limit = _mm_mul_pd(_mm_set1_pd(kRounding * (n + 1)), bound);
+    __m128d settled = _mm_cmple_pd(s2, _mm_mul_pd(limit, limit));
+
+    // Forward lanes: s / d
+    __m128d d2 = _mm_add_pd(_mm_mul_pd(dr, dr), _mm_mul_pd(di, di));
+    __m128d forwardRe = _mm_div_pd(_mm_add_pd(_mm_mul_pd(sr, dr), _mm_mul_pd(si, di)), d2);
+    __m128d forwardIm = _mm_div_pd(_mm_sub_pd(_mm_mul_pd(si, dr), _mm_mul_pd(sr, di)), d2);
+    // Reversed lanes: z / (n - w q' / q)
+    __m128d ur = _mm_div_pd(_mm_add_pd(_mm_mul_pd(dr, sr), _mm_mul_pd(di, si)), s2);
+    __m128d ui = _mm_div_pd(_mm_sub_pd(_mm_mul_pd(di, sr), _mm_mul_pd(dr, si)), s2);
+    __m128d denomRe = _mm_sub_pd(_mm_set1_pd((double)n), _mm_sub_pd(_mm_mul_pd(xr, ur), _mm_mul_pd(xi, ui)));
+    __m128d denomIm = _mm_sub_pd(_mm_setzero_pd(), _mm_add_pd(_mm_mul_pd(xr, ui), _mm_mul_pd(xi, ur)));
+    __m128d denom2 = _mm_add_pd(_mm_mul_pd(denomRe, denomRe), _mm_mul_pd(denomIm, denomIm));
+    __m128d backRe = _mm_div_pd(_mm_add_pd(_mm_mul_pd(zr, denomRe), _mm_mul_pd(zi, denomIm)), denom2);
+    __m128d backIm = _mm_div_pd(_mm_sub_pd(_mm_mul_pd(zi, denomRe), _mm_mul_pd(zr, denomIm)), denom2);
+
+    outRe = _mm_or_pd(_mm_and_pd(reversed, backRe), _mm_andnot_pd(reversed, forwardRe));
+    outIm = _mm_or_pd(_mm_and_pd(reversed, backIm), _mm_andnot_pd(reversed, forwardIm));
+    return settled;
+}
+#endif
+
+}
+
+void coherentSpinState(unsigned int twoJ, double theta, double phi, SpinAmplitudes& state)
+{
+    state.resize(twoJ + 1);
+    double c = std::cos(0.5 * theta), s = std::sin(0.5 * theta);
+    for (unsigned int i = 0; i <= twoJ; ++i) {
+        // i = j - m spins down
+        double magnitude = std::sqrt(binomial(twoJ, i)) * std::pow(c, twoJ - i) * std::pow(s, i);
+        state[i] = std::polar(magnitude, i * phi);
+    }
+}
+
+void twistSpinState(SpinAmplitudes& state, double mu)
+{
+    double j = 0.5 * (state.size() - 1);
+    for (size_t i = 0; i < state.size(); ++i) {
+        double m = j - i;
+        state[i] *= std::polar(1.0, -mu * m * m);
+    }
+}
+
+void MajoranaSolver::reset()
+{
+    m_rootRe.clear();
+    m_rootIm.clear();
+}
+
+void MajoranaSolver::solve(const SpinAmplitudes& state, std::vector<glm::vec3>& stars)
+{
+    unsigned int n = (unsigned int)state.size() - 1;
+    stars.clear();
+    m_stats = Stats();
+    if (state.empty())
+        return;
+
+    // <J> reaches length j only for a coherent state
+    double j = 0.5 * n, norm = 0.0, jz = 0.0;
+    std::complex<double> jPlus = 0.0;
+    for (unsigned int i = 0; i <= n; ++i) {
+        double m = j - i;
+        norm += std::norm(state[i]);
+        jz += m * std::norm(state[i]);
+        if (i > 0)
+            jPlus += std::sqrt(j * (j + 1.0) - m * (m + 1.0)) * std::conj(state[i - 1]) * state[i];
+    }
+    glm::dvec3 spin(jPlus.real(), jPlus.imag(), jz);
+    if (norm > 0.0 && glm::length(spin) >= (1.0 - kCoherentTolerance) * j * norm) {
+        stars.assign(n, glm::vec3(glm::normalize(spin)));
+        m_stats.converged = true;
+        reset();
+        return;
+    }
+
+    // Coefficient of z^k comes from m = k - j, at index i = 2j - k
+    m_coefRe.resize(n + 1);
+    m_coefIm.resize(n + 1);
+    double largest = 0.0;
+    for (unsigned int k = 0; k <= n; ++k) {
+        std::complex<double> c = state[n - k] * std::sqrt(binomial(n, k)) * ((n - k) % 2 ? -1.0 : 1.0);
+        m_coefRe[k] = c.real();
+        m_coefIm[k] = c.imag();
+        largest = std::max(largest, std::abs(c));
+    }
+    auto isZero = [&](unsigned int k) { return std::hypot(m_coefRe[k], m_coefIm[k]) <= kZeroCoefficient * largest; };
+    unsigned int top = n, bottom = 0;
+    while (top > 0 && isZero(top))
+        --top;
+    while (bottom < top && isZero(bottom))
+        ++bottom;
+    // Missing top terms are roots at infinity, missing bottom terms roots at zero
+    unsigned int infinite = n - top;
+    m_zeros = bottom;
+    unsigned int degree = top - bottom;
+
+    if (degree > 0) {
+        // Deflate the zero roots and make the rest monic
+        std::complex<double> lead(m_coefRe[top], m_coefIm[top]);
+        for (unsigned int k = 0; k <= degree; ++k) {
+            std::complex<double> c = std::complex<double>(m_coefRe[k + bottom], m_coefIm[k + bottom]) / lead;
+            m_coefRe[k] = c.real();
+            m_coefIm[k] = c.imag();
+        }
+        m_coefRe.resize(degree + 1);
+        m_coefIm.resize(degree + 1);
+        m_coefAbs.resize(degree + 1);
+        for (unsigned int k = 0; k <= degree; ++k)
+            m_coefAbs[k] = std::hypot(m_coefRe[k], m_coefIm[k]);
+
+        m_stats.warmStart = m_rootRe.size() == degree;
+        if (!m_stats.warmStart) {
+            // On a circle of the roots' geometric mean radius, off the real axis
+            double radius = std::pow(std::hypot(m_coefRe[0], m_coefIm[0]), 1.0 / degree);
+            m_rootRe.resize(degree);
+            m_rootIm.resize(degree);
+            for (unsigned int i = 0; i < degree; ++i) {
+                double angle = 2.0 * kPi * i / degree + 0.4;
+                m_rootRe[i] = radius * std::cos(angle);
+                m_rootIm[i] = radius * std::sin(angle);
+            }
+        }
+        iterate();
+    } else {
+        m_rootRe.clear();
+        m_rootIm.clear();
+        m_stats.converged = true;
+    }
+
+    for (unsigned int i = 0; i < m_zeros; ++i)
+        stars.push_back(glm::vec3(0.0f, 0.0f, 1.0f));
+    for (size_t i = 0; i < m_rootRe.size(); ++i)
+        stars.push_back(starFromRoot(m_rootRe[i], m_rootIm[i]));
+    for (unsigned int i = 0; i < infinite; ++i)
+        stars.push_back(glm::vec3(0.0f, 0.0f, -1.0f));
+}
+
+void MajoranaSolver::iterate()
+{
+    unsigned int n = (unsigned int)m_rootRe.size();
+    m_ratioRe.resize(n);
+    m_ratioIm.resize(n);
+    m_stepRe.resize(n);
+    m_stepIm.resize(n);
+    m_settled.resize(n);
+    const double* coefRe = m_coefRe.data();
+    const double* coefIm = m_coefIm.data();
+    const double* coefAbs = m_coefAbs.data();
+    double* zr = m_rootRe.data();
+    double* zi = m_rootIm.data();
+
+    for (unsigned int iteration = 0; iteration < kMaxIterations; ++iteration) {
+        ++m_stats.iterations;
+        unsigned int i = 0;
+#ifdef BLOCH_SSE
+        for (; i + 2 <= n; i += 2) {
+            __m128d ratioRe, ratioIm;
+            __m128d settled = newtonRatio2(coefRe, coefIm, coefAbs, n, _mm_loadu_pd(zr + i), _mm_loadu_pd(zi + i), ratioRe, ratioIm);
+            _mm_storeu_pd(&m_ratioRe[i], ratioRe);
+            _mm_storeu_pd(&m_ratioIm[i], ratioIm);
+            int mask = _mm_movemask_pd(settled);
+            m_settled[i] = mask & 1;
+            m_settled[i + 1] = (mask >> 1) & 1;
+        }
+#endif
+        for (; i < n; ++i)
+            m_settled[i] = newtonRatio(coefRe, coefIm, coefAbs, n, zr[i], zi[i], m_ratioRe[i], m_ratioIm[i]);
+
+        // Aberth step: w = r / (1 - r sum_j 1 / (z_i - z_j)) for every root at once
+        i = 0;
+#ifdef BLOCH_SSE
+        for (; i + 2 <= n; i += 2) {
+            __m128d xr = _mm_loadu_pd(zr + i), xi = _mm_loadu_pd(zi + i);
+            __m128d sumRe = _mm_setzero_pd(), sumIm = _mm_setzero_pd();
+            for (unsigned int j = 0; j < n; ++j) {
+                __m128d dr = _mm_sub_pd(xr, _mm_set1_pd(zr[j]));
+                __m128d di = _mm_sub_pd(xi, _mm_set1_pd(zi[j]));
+                __m128d d = _mm_add_pd(_mm_mul_pd(dr, dr), _mm_mul_pd(di, di));
+                // The lane whose own root this is has d = 0 and adds nothing
+                __m128d valid = _mm_cmpneq_pd(d, _mm_setzero_pd());
+                __m128d inv = _mm_and_pd(valid, _mm_div_pd(_mm_set1_pd(1.0), d));
+                sumRe = _mm_add_pd(sumRe, _mm_and_pd(valid, _mm_mul_pd(dr, inv)));
+                sumIm = _mm_sub_pd(sumIm, _mm_and_pd(valid, _mm_mul_pd(di, inv)));
+            }
+            __m128d rr = _mm_loadu_pd(&m_ratioRe[i]), ri = _mm_loadu_pd(&m_ratioIm[i]);
+            // 1 - r * sum
+            __m128d denRe = _mm_sub_pd(_mm_set1_pd(1.0), _mm_sub_pd(_mm_mul_pd(rr, sumRe), _mm_mul_pd(ri, sumIm)));
+            __m128d denIm = _mm_sub_pd(_mm_setzero_pd(), _mm_add_pd(_mm_mul_pd(rr, sumIm), _mm_mul_pd(ri, sumRe)));
+            __m128d den = _mm_add_pd(_mm_mul_pd(denRe, denRe), _mm_mul_pd(denIm, denIm));
+            _mm_storeu_pd(&m_stepRe[i], _mm_div_pd(_mm_add_pd(_mm_mul_pd(rr, denRe), _mm_mul_pd(ri, denIm)), den));
+            _mm_storeu_pd(&m_stepIm[i], _mm_div_pd(_mm_sub_pd(_mm_mul_pd(ri, denRe), _mm_mul_pd(rr, denIm)), den));
+        }
+#endif
+        for (; i < n; ++i) {
+            double sumRe = 0.0, sumIm = 0.0;
+            for (unsigned int j = 0; j < n; ++j) {
+                if (j == i)
+                    continue;
+                double dr = zr[i] - zr[j], di = zi[i] - zi[j];
+                double d = dr * dr + di * di;
+                sumRe += dr / d;
+                sumIm -= di / d;
+            }
+            double rr = m_ratioRe[i], ri = m_ratioIm[i];
+            double denRe = 1.0 - (rr * sumRe - ri * sumIm), denIm = -(rr * sumIm + ri * sumRe);
+            double den = denRe * denRe + denIm * denIm;
+            m_stepRe[i] = (rr * denRe + ri * denIm) / den;
+            m_stepIm[i] = (ri * denRe - rr * denIm) / den;
+        }
+
+        // Jacobi update; roots already at the noise floor stay put
+        bool converged = true;
+        for (unsigned int k = 0; k < n; ++k) {
+            if (m_settled[k])
+                continue;
+            double step = std::hypot(m_stepRe[k], m_stepIm[k]);
+            if (!std::isfinite(step))
+                continue;
+            zr[k] -= m_stepRe[k];
+            zi[k] -= m_stepIm[k];
+            if (step > kTolerance * std::max(1.0, std::hypot(zr[k], zi[k])))
+                converged = false;
+        }
+        if (converged) {
+            m_stats.converged = true;
+            return;
+        }
+    }
+}
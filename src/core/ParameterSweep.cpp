@@ -0,0 +1,71 @@
+#include "ParameterSweep.h"
+#include "BlochMath.h"
+#include "Parallel.h"
+#include <chrono>
+
+namespace {
+
+void applyParameter(SweepParameter parameter, float value, float& theta, float& phi, BlochEquationParams& dynamics)
+{
+    switch (parameter) {
+    case SweepParameter::Theta:
+        theta = value;
+        break;
+    case SweepParameter::Phi:
+        phi = value;
+        break;
+    case SweepParameter::Detuning:
+        dynamics.detuning = value;
+        break;
+    case SweepParameter::Noise:
+        dynamics.t2 = value > 0.0f ? 1.0f / value : 0.0f;
+        break;
+    default:
+        break;
+    }
+}
+
+}
+
+const char* sweepParameterName(SweepParameter parameter)
+{
+    switch (parameter) {
+    case SweepParameter::Theta: return "Theta (deg)";
+    case SweepParameter::Phi: return "Phi (deg)";
+    case SweepParameter::Detuning: return "Detuning";
+    case SweepParameter::Noise: return "Noise (1/T2)";
+    default: return "";
+    }
+}
+
+float SweepAxis::valueAt(unsigned int index) const
+{
+    if (count <= 1)
+        return min;
+    return min + (max - min) * index / (count - 1);
+}
+
+void ParameterSweep::run(const SweepSettings& settings)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    m_columns = settings.columns.count;
+    m_rows = settings.rows.count;
+    m_cells.resize(static_cast<size_t>(m_columns) * m_rows);
+
+    parallelFor(m_cells.size(), 64, [&](size_t begin, size_t end, unsigned int) {
+        for (size_t i = begin; i < end; ++i) {
+            float theta = settings.theta;
+            float phi = settings.phi;
+            BlochEquationParams dynamics = settings.dynamics;
+            applyParameter(settings.columns.parameter, settings.columns.valueAt(static_cast<unsigned int>(i % m_columns)), theta, phi, dynamics);
+            applyParameter(settings.rows.parameter, settings.rows.valueAt(static_cast<unsigned int>(i / m_columns)), theta, phi, dynamics);
+
+            glm::vec3 bloch = blochFromAngles(glm::radians(theta), glm::radians(phi));
+            bloch = evolveBloch(bloch, dynamics, settings.duration, settings.steps);
+            m_cells[i] = { bloch, purity(bloch) };
+        }
+    });
+
+    m_elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
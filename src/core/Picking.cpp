@@ -0,0 +1,155 @@
+#include "Picking.h"
+#include "FrustumCulling.h"
+#include <algorithm>
+#include <cmath>
+
+Ray rayFromScreen(const glm::mat4& viewProjection, const glm::vec2& pixel, const glm::vec2& viewport)
+{
+    glm::vec2 ndc(2.0f * pixel.x / viewport.x - 1.0f, 1.0f - 2.0f * pixel.y / viewport.y);
+    glm::mat4 inverse = glm::inverse(viewProjection);
+    glm::vec4 nearPoint = inverse * glm::vec4(ndc, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+    Ray ray;
+    ray.origin = glm::vec3(nearPoint) / nearPoint.w;
+    ray.direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - ray.origin);
+    return ray;
+}
+
+bool intersectSphere(const Ray& ray, const glm::vec3& center, float radius, float& distance)
+{
+    glm::vec3 offset = ray.origin - center;
+    float b = glm::dot(offset, ray.direction);
+    float c = glm::dot(offset, offset) - radius * radius;
+    float discriminant = b * b - c;
+    if (discriminant < 0.0f)
+        return false;
+    float root = std::sqrt(discriminant);
+    distance = -b - root;
+    if (distance < 0.0f)
+        distance = -b + root;  // starting inside
+    return distance >= 0.0f;
+}
+
+namespace {
+
+const uint32_t kLeafSpheres = 4;
+
+// Distance at which the ray enters the box, or a negative value on a miss
+float enterBox(const glm::vec3& origin, const glm::vec3& inverse, const glm::vec3& lower, const glm::vec3& upper, float limit)
+{
+    glm::vec3 t0 = (lower - origin) * inverse;
+    glm::vec3 t1 = (upper - origin) * inverse;
+    glm::vec3 near = glm::min(t0, t1), far = glm::max(t0, t1);
+    float enter = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+    float exit = std::min(std::min(far.x, far.y), std::min(far.z, limit));
+    return enter <= exit ? enter : -1.0f;
+}
+
+}
+
+void SphereBvh::clear()
+{
+    m_nodes.clear();
+    m_spheres.clear();
+}
+
+void SphereBvh::build(const BoundingSpheres& spheres)
+{
+    clear();
+    m_spheres.resize(spheres.size());
+    for (size_t i = 0; i < spheres.size(); ++i)
+        m_spheres[i] = { glm::vec3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i], (uint32_t)i };
+    if (!m_spheres.empty()) {
+        m_nodes.reserve(2 * m_spheres.size() / kLeafSpheres + 1);
+        buildNode(0, (uint32_t)m_spheres.size());
+    }
+}
+
+uint32_t SphereBvh::buildNode(uint32_t begin, uint32_t end)
+{
+    uint32_t index = (uint32_t)m_nodes.size();
+    m_nodes.emplace_back();
+    glm::vec3 lower(INFINITY), upper(-INFINITY);
+    glm::vec3 centerLower(INFINITY), centerUpper(-INFINITY);
+    for (uint32_t i = begin; i < end; ++i) {
+        const Sphere& sphere = m_spheres[i];
+        lower = glm::min(lower, sphere.center - sphere.radius);
+        upper = glm::max(upper, sphere.center + sphere.radius);
+        centerLower = glm::min(centerLower, sphere.center);
+        centerUpper = glm::max(centerUpper, sphere.center);
+    }
+    m_nodes[index].lower = lower;
+    m_nodes[index].upper = upper;
+    if (end - begin <= kLeafSpheres) {
+        m_nodes[index].first = begin;
+        m_nodes[index].count = end - begin;
+        return index;
+    }
+
+    glm::vec3 extent = centerUpper - centerLower;
+    int axis = extent.x >= extent.y ? (extent.x >= extent.z ? 0 : 2) : (extent.y >= extent.z ? 1 : 2);
+    uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(m_spheres.begin() + begin, m_spheres.begin() + middle, m_spheres.begin() + end,
+                     [axis](const Sphere& a, const Sphere& b) { return a.center[axis] < b.center[axis]; });
+    buildNode(begin, middle);
+    uint32_t second = buildNode(middle, end);
+    m_nodes[index].first = second;
+    m_nodes[index].count = 0;
+    return index;
+}
+
+bool SphereBvh::intersect(const Ray& ray, uint32_t& index, float& distance) const
+{
+    m_lastTests = 0;
+    if (m_nodes.empty())
+        return false;
+    glm::vec3 inverse = 1.0f / ray.direction;
+    float best = INFINITY;
+    bool hit = false;
+
+    // Nodes still to visit with the distance at which the ray enters them
+    struct Entry {
+        uint32_t node;
+        float enter;
+    };
+    Entry stack[64];
+    int depth = 0;
+    stack[depth++] = { 0, 0.0f };
+    while (depth > 0) {
+        Entry entry = stack[--depth];
+        if (entry.enter > best)
+            continue;
+        const Node& node = m_nodes[entry.node];
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                ++m_lastTests;
+                float t;
+                if (intersectSphere(ray, m_spheres[i].center, m_spheres[i].radius, t) && t < best) {
+                    best = t;
+                    index = m_spheres[i].index;
+                    hit = true;
+                }
+            }
+            continue;
+        }
+        // Push the farther child first so the nearer one is popped next
+        uint32_t firstChild = entry.node + 1;
+        const Node& a = m_nodes[firstChild];
+        const Node& b = m_nodes[node.first];
+        m_lastTests += 2;
+        float ta = enterBox(ray.origin, inverse, a.lower, a.upper, best);
+        float tb = enterBox(ray.origin, inverse, b.lower, b.upper, best);
+        if (ta >= 0.0f && tb >= 0.0f) {
+            bool aFirst = ta <= tb;
+            stack[depth++] = aFirst ? Entry{ node.first, tb } : Entry{ firstChild, ta };
+            stack[depth++] = aFirst ? Entry{ firstChild, ta } : Entry{ node.first, tb };
+        } else if (ta >= 0.0f) {
+            stack[depth++] = { firstChild, ta };
+        } else if (tb >= 0.0f) {
+            stack[depth++] = { node.first, tb };
+        }
+    }
+    if (hit)
+        distance = best;
+    return hit;
+}
@@ -0,0 +1,227 @@
+#include "PulseEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+// Half-angles below this use the series in rotationQuaternion
+const double kSeriesLimit = 0.01;  // |v|^2
+// Direct exponentials between steps of the Gaussian recurrence
+const unsigned int kResyncInterval = 256;
+// Offsets of the two Gauss-Legendre points within a sample, as a fraction
+const double kGaussOffset = 0.28867513459481288225;  // sqrt(3) / 6
+const double kMagnusCommutator = 0.14433756729740644113;  // sqrt(3) / 12
+
+// Unit in-phase envelope g and its derivative at t0, t0 + h, ..., written to
+// out[0], out[stride], ...
+void unitEnvelope(const PulseSettings& settings, double t0, double h, size_t count, glm::dvec2* out, size_t stride)
+{
+    if (settings.shape == PulseShape::Square) {
+        for (size_t j = 0; j < count; ++j)
+            out[j * stride] = glm::dvec2(1.0, 0.0);
+        return;
+    }
+
+    // exp(-u^2 / 2) at consecutive points is a ratio away from the previous
+    // one, and the ratio itself changes by a constant factor, so the series
+    // costs two multiplies per point between direct evaluations
+    double center = 0.5 * settings.duration;
+    double width = std::max(settings.sigma, 1e-6) * settings.duration;
+    double inverseVariance = 1.0 / (width * width);
+    double edge = std::exp(-0.5 * center * center * inverseVariance);
+    double ratioStep = std::exp(-h * h * inverseVariance);
+    double gaussian = 0.0, ratio = 0.0;
+    for (size_t j = 0; j < count; ++j) {
+        double offset = t0 + j * h - center;
+        if (j % kResyncInterval == 0) {
+            gaussian = std::exp(-0.5 * offset * offset * inverseVariance);
+            ratio = std::exp(-(offset * h + 0.5 * h * h) * inverseVariance);
+        }
+        out[j * stride] = glm::dvec2(std::max(gaussian - edge, 0.0), -offset * inverseVariance * gaussian);
+        gaussian *= ratio;
+        ratio *= ratioStep;
+    }
+}
+
+// Scales unit envelopes to the pulse's area and turns them into drives
+// along its phase; `weight` is the quadrature weight of each value
+void scaleEnvelope(const PulseSettings& settings, std::vector<glm::dvec2>& drive, double weight)
+{
+    double area = 0.0;
+    for (const glm::dvec2& value : drive)
+        area += value.x;
+    area *= weight;
+    double amplitude = area > 0.0 ? settings.angle / area : 0.0;
+    double beta = settings.shape == PulseShape::Drag ? settings.dragBeta : 0.0;
+    double c = std::cos(settings.phase), s = std::sin(settings.phase);
+    for (glm::dvec2& value : drive) {
+        double in = amplitude * value.x, quadrature = amplitude * beta * value.y;
+        value = glm::dvec2(c * in - s * quadrature, s * in + c * quadrature);
+    }
+}
+
+glm::dquat power(glm::dquat q, unsigned int n)
+{
+    glm::dquat result(1.0, 0.0, 0.0, 0.0);
+    for (; n > 0; n >>= 1) {
+        if (n & 1)
+            result = q * result;
+        q = q * q;
+    }
+    return result;
+}
+
+glm::vec3 rotate(const glm::dquat& q, const glm::vec3& bloch)
+{
+    return glm::vec3(q * glm::dvec3(bloch));
+}
+
+}
+
+const char* pulseShapeName(PulseShape shape)
+{
+    switch (shape) {
+    case PulseShape::Square: return "Square";
+    case PulseShape::Gaussian: return "Gaussian";
+    case PulseShape::Drag: return "DRAG";
+    default: return "";
+    }
+}
+
+const char* pulseIntegratorName(PulseIntegrator integrator)
+{
+    switch (integrator) {
+    case PulseIntegrator::PiecewiseConstant: return "Piecewise Constant";
+    case PulseIntegrator::Magnus4: return "Magnus (4th order)";
+    default: return "";
+    }
+}
+
+bool PulseSettings::operator==(const PulseSettings& other) const
+{
+    return shape == other.shape && integrator == other.integrator && samples == other.samples &&
+           duration == other.duration && angle == other.angle && phase == other.phase && sigma == other.sigma &&
+           dragBeta == other.dragBeta && detuning == other.detuning;
+}
+
+glm::dquat rotationQuaternion(const glm::dvec3& v)
+{
+    double x = glm::dot(v, v);
+    double c, s;  // cos(|v|/2) and sin(|v|/2) / |v|
+    if (x < kSeriesLimit) {
+        double y = 0.25 * x;
+        c = 1.0 - y * (1.0 / 2 - y * (1.0 / 24 - y * (1.0 / 720 - y * (1.0 / 40320 - y * (1.0 / 3628800)))));
+        s = 0.5 * (1.0 - y * (1.0 / 6 - y * (1.0 / 120 - y * (1.0 / 5040 - y * (1.0 / 362880)))));
+    } else {
+        double angle = std::sqrt(x);
+        c = std::cos(0.5 * angle);
+        s = std::sin(0.5 * angle) / angle;
+    }
+    return glm::dquat(c, s * v.x, s * v.y, s * v.z);
+}
+
+bool PulseEngine::prepare(const PulseSettings& settings)
+{
+    if (m_built && settings == m_settings) {
+        ++m_stats.reuses;
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    m_settings = settings;
+    m_built = true;
+    size_t count = std::max(settings.samples, 1u);
+    double dt = settings.duration / count;
+    if (settings.integrator == PulseIntegrator::Magnus4 && settings.shape != PulseShape::Square) {
+        m_dt = dt;
+        buildMagnus(settings);
+    } else {
+        // Square pulses are constant, so the exponential is already exact
+        m_drive.resize(count);
+        unitEnvelope(settings, 0.5 * dt, dt, count, m_drive.data(), 1);
+        scaleEnvelope(settings, m_drive, dt);
+        build(m_drive.data(), count, dt, settings.detuning);
+    }
+    ++m_stats.builds;
+    m_stats.buildMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void PulseEngine::build(const glm::dvec2* samples, size_t count, double dt, double detuning)
+{
+    m_dt = dt;
+    m_steps.resize(count);
+    for (size_t k = 0; k < count; ++k)
+        m_steps[k] = rotationQuaternion(glm::dvec3(samples[k], detuning) * dt);
+    accumulate();
+}
+
+void PulseEngine::buildMagnus(const PulseSettings& settings)
+{
+    size_t count = std::max(settings.samples, 1u);
+    double dt = m_dt;
+    m_drive.resize(2 * count);
+    unitEnvelope(settings, (0.5 - kGaussOffset) * dt, dt, count, m_drive.data(), 2);
+    unitEnvelope(settings, (0.5 + kGaussOffset) * dt, dt, count, m_drive.data() + 1, 2);
+    scaleEnvelope(settings, m_drive, 0.5 * dt);
+
+    // Omega = dt/2 (w1 + w2) + sqrt(3)/12 dt^2 (w2 x w1), where the cross
+    // product is the commutator of the two precession generators
+    m_steps.resize(count);
+    for (size_t k = 0; k < count; ++k) {
+        glm::dvec3 first(m_drive[2 * k], settings.detuning);
+        glm::dvec3 second(m_drive[2 * k + 1], settings.detuning);
+        glm::dvec3 omega = 0.5 * dt * (first + second) + kMagnusCommutator * dt * dt * glm::cross(second, first);
+        m_steps[k] = rotationQuaternion(omega);
+    }
+    accumulate();
+}
+
+void PulseEngine::accumulate()
+{
+    m_prefix.resize(m_steps.size() + 1);
+    m_prefix[0] = glm::dquat(1.0, 0.0, 0.0, 0.0);
+    for (size_t k = 0; k < m_steps.size(); ++k)
+        m_prefix[k + 1] = m_steps[k] * m_prefix[k];
+    // Rounding drifts off the unit sphere by about 1e-16 per product
+    m_prefix.back() = glm::normalize(m_prefix.back());
+}
+
+glm::vec3 PulseEngine::apply(const glm::vec3& bloch, unsigned int repeats) const
+{
+    if (m_prefix.empty())
+        return bloch;
+    return rotate(power(total(), repeats), bloch);
+}
+
+glm::vec3 PulseEngine::stateAt(const glm::vec3& bloch, unsigned int repeat, size_t k) const
+{
+    if (m_prefix.empty())
+        return bloch;
+    return rotate(m_prefix[std::min(k, samples())] * power(total(), repeat), bloch);
+}
+
+void PulseEngine::trajectory(const glm::vec3& bloch, unsigned int repeats, size_t stride, std::vector<glm::vec3>& points) const
+{
+    points.clear();
+    if (m_prefix.empty() || repeats == 0) {
+        points.push_back(bloch);
+        return;
+    }
+    stride = std::max<size_t>(stride, 1);
+    size_t count = samples();
+    size_t end = count * repeats;
+    points.reserve(end / stride + 2);
+
+    glm::dvec3 start(bloch);
+    size_t repeat = 0;
+    for (size_t i = 0; i < end; i += stride) {
+        while (i >= (repeat + 1) * count) {
+            start = total() * start;
+            ++repeat;
+        }
+        points.push_back(glm::vec3(m_prefix[i - repeat * count] * start));
+    }
+    points.push_back(apply(bloch, repeats));
+}
@@ -0,0 +1,248 @@
+#include "QuasiProbability.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include "Parallel.h"
+#include "Simd.h"
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+// Rows per worker; a row is a few hundred series evaluations
+const size_t kMinRowsPerWorker = 8;
+// Samples of r.n used to find the range of a series
+const int kRangeSamples = 1024;
+
+double factorial(int n)
+{
+    // 170! is the largest that fits in a double
+    static const std::array<double, 171> table = [] {
+        std::array<double, 171> values;
+        values[0] = 1.0;
+        for (size_t i = 1; i < values.size(); ++i)
+            values[i] = values[i - 1] * i;
+        return values;
+    }();
+    assert(n >= 0 && (size_t)n < table.size());
+    return table[n];
+}
+
+// Sum of a_k P_k(x) by the three-term recurrence
+float legendreSeries(const float* a, size_t count, float x)
+{
+    float previous = 1.0f, current = x;
+    float sum = a[0];
+    if (count > 1)
+        sum += a[1] * x;
+    for (size_t k = 1; k + 1 < count; ++k) {
+        float next = ((2 * k + 1) * x * current - k * previous) / (k + 1);
+        sum += a[k + 1] * next;
+        previous = current;
+        current = next;
+    }
+    return sum;
+}
+
+}
+
+double wigner3j(int twoJ1, int twoJ2, int twoJ3, int twoM1, int twoM2, int twoM3)
+{
+    // Selection rules
+    if (twoM1 + twoM2 + twoM3 != 0)
+        return 0.0;
+    if (twoJ3 > twoJ1 + twoJ2 || twoJ3 < std::abs(twoJ1 - twoJ2))
+        return 0.0;
+    if (std::abs(twoM1) > twoJ1 || std::abs(twoM2) > twoJ2 || std::abs(twoM3) > twoJ3)
+        return 0.0;
+    if ((twoJ1 + twoM1) % 2 || (twoJ2 + twoM2) % 2 || (twoJ3 + twoM3) % 2 || (twoJ1 + twoJ2 + twoJ3) % 2)
+        return 0.0;
+
+    // Past the factorial table
+    if ((twoJ1 + twoJ2 + twoJ3) / 2 + 1 > 170)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    // Racah's formula; every term below is a whole number
+    int a = (twoJ1 + twoJ2 - twoJ3) / 2;
+    int b = (twoJ1 - twoJ2 + twoJ3) / 2;
+    int c = (-twoJ1 + twoJ2 + twoJ3) / 2;
+    double triangle = factorial(a) * factorial(b) * factorial(c) / factorial((twoJ1 + twoJ2 + twoJ3) / 2 + 1);
+    double norm = std::sqrt(triangle * factorial((twoJ1 + twoM1) / 2) * factorial((twoJ1 - twoM1) / 2) *
+                            factorial((twoJ2 + twoM2) / 2) * factorial((twoJ2 - twoM2) / 2) *
+                            factorial((twoJ3 + twoM3) / 2) * factorial((twoJ3 - twoM3) / 2));
+    int d = (twoJ3 - twoJ2 + twoM1) / 2;
+    int e = (twoJ3 - twoJ1 - twoM2) / 2;
+    int f = (twoJ1 - twoM1) / 2;
+    int g = (twoJ2 + twoM2) / 2;
+    double sum = 0.0;
+    for (int t = std::max(0, std::max(-d, -e)); t <= std::min(a, std::min(f, g)); ++t) {
+        double term = 1.0 / (factorial(t) * factorial(d + t) * factorial(e + t) * factorial(a - t) * factorial(f - t) *
+                             factorial(g - t));
+        sum += t % 2 ? -term : term;
+    }
+    int phase = (twoJ1 - twoJ2 - twoM3) / 2;
+    return (phase % 2 ? -1.0 : 1.0) * norm * sum;
+}
+
+QuasiProbabilitySeries quasiProbabilitySeries(QuasiProbabilityKind kind, const glm::vec3& bloch, unsigned int twoJ)
+{
+    int n = (int)std::min(std::max(1u, twoJ), kMaxQuasiTwoJ);
+    double length = std::min(1.0, (double)glm::length(bloch));
+    QuasiProbabilitySeries series;
+    if (length > 0.0)
+        series.axis = bloch / (float)length;
+
+    // Along the axis the state is diagonal in |j m>, with weight p^(j+m) q^(j-m)
+    double p = 0.5 * (1.0 + length), q = 1.0 - p;
+    std::vector<double> weights(n + 1);
+    double total = 0.0;
+    for (int up = 0; up <= n; ++up) {
+        weights[up] = std::pow(p, up) * std::pow(q, n - up);
+        total += weights[up];
+    }
+
+    // Multipoles rho_k0 = Tr(rho T_k0), and from them the series; the Husimi
+    // function smooths multipole k by the coherent state's own, sqrt(2j+1) (j k j; -j 0 j)
+    series.coefficients.resize(n + 1);
+    for (int k = 0; k <= n; ++k) {
+        double multipole = 0.0;
+        for (int up = 0; up <= n; ++up) {
+            int twoM = 2 * up - n;
+            double sign = (n - up) % 2 ? -1.0 : 1.0;
+            multipole += weights[up] / total * sign * std::sqrt(2.0 * k + 1.0) * wigner3j(n, 2 * k, n, -twoM, 0, twoM);
+        }
+        double coefficient = std::sqrt((n + 1.0) * (2.0 * k + 1.0)) / (4.0 * kPi) * multipole;
+        if (kind == QuasiProbabilityKind::Husimi)
+            coefficient *= std::sqrt(n + 1.0) * wigner3j(n, 2 * k, n, -n, 0, n);
+        series.coefficients[k] = (float)coefficient;
+    }
+    return series;
+}
+
+float QuasiProbabilitySeries::evaluate(const glm::vec3& direction) const
+{
+    return legendreSeries(coefficients.data(), coefficients.size(), glm::dot(axis, glm::normalize(direction)));
+}
+
+void QuasiProbabilitySeries::range(float& low, float& high) const
+{
+    low = high = legendreSeries(coefficients.data(), coefficients.size(), -1.0f);
+    for (int i = 1; i <= kRangeSamples; ++i) {
+        float value = legendreSeries(coefficients.data(), coefficients.size(), -1.0f + 2.0f * i / kRangeSamples);
+        low = std::min(low, value);
+        high = std::max(high, value);
+    }
+}
+
+QuasiProbabilityGrid::QuasiProbabilityGrid(unsigned int width, unsigned int height)
+    : m_width(0), m_height(0), m_version(1), m_dirtyFirst(0), m_dirtyEnd(0)
+{
+    m_series.coefficients.assign(1, (float)(1.0 / (4.0 * kPi)));
+    resize(width, height);
+}
+
+void QuasiProbabilityGrid::resize(unsigned int width, unsigned int height)
+{
+    m_width = width;
+    m_height = height;
+    m_values.assign((size_t)width * height, 0.0f);
+    m_rowVersions.assign(height, 0);
+    m_cosPhi.resize(width);
+    m_sinPhi.resize(width);
+    for (unsigned int column = 0; column < width; ++column) {
+        double phi = 2.0 * kPi * (column + 0.5) / width;
+        m_cosPhi[column] = (float)std::cos(phi);
+        m_sinPhi[column] = (float)std::sin(phi);
+    }
+}
+
+void QuasiProbabilityGrid::setSeries(const QuasiProbabilitySeries& series)
+{
+    if (series.axis == m_series.axis && series.coefficients == m_series.coefficients)
+        return;
+    m_series = series;
+    ++m_version;
+}
+
+unsigned int QuasiProbabilityGrid::staleRows() const
+{
+    return (unsigned int)std::count_if(m_rowVersions.begin(), m_rowVersions.end(),
+        [this](uint64_t version) { return version != m_version; });
+}
+
+unsigned int QuasiProbabilityGrid::update(unsigned int maxRows)
+{
+    m_stale.clear();
+    for (unsigned int row = 0; row < m_height && m_stale.size() < maxRows; ++row) {
+        if (m_rowVersions[row] != m_version)
+            m_stale.push_back(row);
+    }
+    if (m_stale.empty())
+        return 0;
+
+    parallelFor(m_stale.size(), kMinRowsPerWorker, [this](size_t begin, size_t end, unsigned int) {
+        for (size_t i = begin; i < end; ++i)
+            computeRow(m_stale[i]);
+    });
+
+    for (unsigned int row : m_stale)
+        m_rowVersions[row] = m_version;
+    unsigned int first = m_stale.front(), end = m_stale.back() + 1;
+    if (m_dirtyFirst >= m_dirtyEnd) {
+        m_dirtyFirst = first;
+        m_dirtyEnd = end;
+    } else {
+        m_dirtyFirst = std::min(m_dirtyFirst, first);
+        m_dirtyEnd = std::max(m_dirtyEnd, end);
+    }
+    return (unsigned int)m_stale.size();
+}
+
+bool QuasiProbabilityGrid::takeDirtyRows(unsigned int& first, unsigned int& end)
+{
+    if (m_dirtyFirst >= m_dirtyEnd)
+        return false;
+    first = m_dirtyFirst;
+    end = m_dirtyEnd;
+    m_dirtyFirst = m_dirtyEnd = 0;
+    return true;
+}
+
+void QuasiProbabilityGrid::computeRow(unsigned int row)
+{
+    double theta = kPi * (row + 0.5) / m_height;
+    float cosTheta = (float)std::cos(theta), sinTheta = (float)std::sin(theta);
+    const glm::vec3& axis = m_series.axis;
+    const float* a = m_series.coefficients.data();
+    size_t count = m_series.coefficients.size();
+    float* out = m_values.data() + (size_t)row * m_width;
+
+    // r.n = axis.z cos(theta) + sin(theta) (axis.x cos(phi) + axis.y sin(phi))
+    float base = axis.z * cosTheta;
+    float ax = axis.x * sinTheta, ay = axis.y * sinTheta;
+    unsigned int column = 0;
+#ifdef BLOCH_SSE
+    __m128 baseV = _mm_set1_ps(base), axV = _mm_set1_ps(ax), ayV = _mm_set1_ps(ay);
+    for (; column + 4 <= m_width; column += 4) {
+        __m128 x = _mm_add_ps(baseV, _mm_add_ps(_mm_mul_ps(axV, _mm_loadu_ps(&m_cosPhi[column])),
+                                                _mm_mul_ps(ayV, _mm_loadu_ps(&m_sinPhi[column]))));
+        __m128 previous = _mm_set1_ps(1.0f), current = x;
+        __m128 sum = _mm_set1_ps(a[0]);
+        if (count > 1)
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a[1]), x));
+        for (size_t k = 1; k + 1 < count; ++k) {
+            // P_k+1 = ((2k+1) x P_k - k P_k-1) / (k+1)
+            __m128 next = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(2.0f * k + 1.0f), _mm_mul_ps(x, current)),
+                                                _mm_mul_ps(_mm_set1_ps((float)k), previous)),
+                                     _mm_set1_ps(1.0f / (k + 1)));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a[k + 1]), next));
+            previous = current;
+            current = next;
+        }
+        _mm_storeu_ps(out + column, sum);
+    }
+#endif
+    for (; column < m_width; ++column)
+        out[column] = legendreSeries(a, count, base + ax * m_cosPhi[column] + ay * m_sinPhi[column]);
+}
@@ -0,0 +1,203 @@
+#include "RandomizedBenchmarking.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+const unsigned int kMinSequencesPerChunk = 16;
+const unsigned int kFitIterations = 100;
+
+uint64_t splitMix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Seed of sequence `sequence` at length index `lengthIndex` of a run
+uint64_t sequenceSeed(uint64_t seed, unsigned int lengthIndex, unsigned int sequence)
+{
+    uint64_t state = seed ^ ((uint64_t)lengthIndex << 32 | sequence);
+    return splitMix64(state);
+}
+
+// Lengths log-spaced from 1 to maxLength, rounded and without repeats
+std::vector<unsigned int> sequenceLengths(unsigned int maxLength, unsigned int count)
+{
+    std::vector<unsigned int> lengths;
+    maxLength = std::max(maxLength, 1u);
+    count = std::max(count, 1u);
+    for (unsigned int i = 0; i < count; ++i) {
+        double t = count > 1 ? (double)i / (count - 1) : 1.0;
+        unsigned int length = (unsigned int)std::lround(std::pow((double)maxLength, t));
+        if (lengths.empty() || length > lengths.back())
+            lengths.push_back(length);
+    }
+    return lengths;
+}
+
+// Squared residual of the best amplitude * decay^m + offset for a fixed decay
+double fitResidual(const std::vector<RbPoint>& points, double decay, double& amplitude, double& offset)
+{
+    double su = 0.0, suu = 0.0, sf = 0.0, suf = 0.0;
+    double n = (double)points.size();
+    for (const RbPoint& point : points) {
+        double u = std::pow(decay, (double)point.length);
+        su += u;
+        suu += u * u;
+        sf += point.survival;
+        suf += u * point.survival;
+    }
+    double determinant = n * suu - su * su;
+    if (std::abs(determinant) < 1e-12 * n * n) {
+        amplitude = 0.0;
+        offset = sf / n;
+    } else {
+        amplitude = (n * suf - su * sf) / determinant;
+        offset = (sf - amplitude * su) / n;
+    }
+
+    double residual = 0.0;
+    for (const RbPoint& point : points) {
+        double error = amplitude * std::pow(decay, (double)point.length) + offset - point.survival;
+        residual += error * error;
+    }
+    return residual;
+}
+
+}
+
+BlochChannel CliffordRotation::channel() const
+{
+    BlochChannel result;
+    result.matrix = glm::mat3(0.0f);
+    // glm matrices are column-major: row i has sign[i] in column axis[i]
+    for (int i = 0; i < 3; ++i)
+        result.matrix[axis[i]][i] = sign[i];
+    return result;
+}
+
+void randomCliffordSequence(uint64_t seed, unsigned int length, std::vector<uint8_t>& sequence)
+{
+    sequence.resize(length + 1);
+    uint64_t state = seed;
+    uint8_t net = 0;
+    for (unsigned int i = 0; i < length; ++i) {
+        uint8_t element = (uint8_t)(((splitMix64(state) >> 32) * CliffordTable::kCount) >> 32);
+        sequence[i] = element;
+        net = kCliffords.product[net][element];
+    }
+    sequence[length] = kCliffords.inverse[net];
+}
+
+BlochChannel RbSettings::noise() const
+{
+    BlochChannel channel = compose(::depolarizing(depolarizing), ::dephasing(dephasing));
+    channel = compose(channel, ::amplitudeDamping(amplitudeDamping));
+    if (overRotation != 0.0f)
+        channel = compose(channel, rotationGate(glm::vec3(1.0f, 0.0f, 0.0f), overRotation));
+    return channel;
+}
+
+void RandomizedBenchmark::run(const RbSettings& settings)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<unsigned int> lengths = sequenceLengths(settings.maxLength, settings.lengthCount);
+    unsigned int lengthCount = (unsigned int)lengths.size();
+    unsigned int sequences = std::max(settings.sequences, 1u);
+
+    // Each Clifford followed by the noise, as one channel
+    BlochChannel noise = settings.noise();
+    BlochChannel noisy[CliffordTable::kCount];
+    for (unsigned int i = 0; i < CliffordTable::kCount; ++i)
+        noisy[i] = compose(kCliffords.elements[i].channel(), noise);
+
+    // Sequences are interleaved across lengths so the chunks get equal work,
+    // and every final vector is kept so the sums below run in a fixed order
+    size_t total = (size_t)lengthCount * sequences;
+    std::vector<glm::vec3> finals(total);
+    std::vector<std::vector<uint8_t>> buffers(workerCount());
+    parallelFor(total, kMinSequencesPerChunk, [&](size_t begin, size_t end, unsigned int worker) {
+        std::vector<uint8_t>& sequence = buffers[worker];
+        for (size_t i = begin; i < end; ++i) {
+            unsigned int lengthIndex = (unsigned int)(i % lengthCount);
+            unsigned int index = (unsigned int)(i / lengthCount);
+            randomCliffordSequence(sequenceSeed(settings.seed, lengthIndex, index), lengths[lengthIndex], sequence);
+            glm::vec3 bloch(0.0f, 0.0f, 1.0f);
+            for (uint8_t element : sequence)
+                bloch = noisy[element].apply(bloch);
+            finals[i] = bloch;
+        }
+    });
+
+    m_points.resize(lengthCount);
+    m_cliffords = 0;
+    for (unsigned int l = 0; l < lengthCount; ++l) {
+        double sum = 0.0, sumSquares = 0.0;
+        glm::dvec3 blochSum(0.0);
+        for (unsigned int s = 0; s < sequences; ++s) {
+            const glm::vec3& bloch = finals[(size_t)s * lengthCount + l];
+            double survival = 0.5 * (1.0 + bloch.z);
+            sum += survival;
+            sumSquares += survival * survival;
+            blochSum += glm::dvec3(bloch);
+        }
+        double mean = sum / sequences;
+        RbPoint& point = m_points[l];
+        point.length = lengths[l];
+        point.survival = mean;
+        point.spread = std::sqrt(std::max(sumSquares / sequences - mean * mean, 0.0));
+        point.meanBloch = glm::vec3(blochSum / (double)sequences);
+        m_cliffords += (uint64_t)(lengths[l] + 1) * sequences;
+    }
+    fitDecay();
+
+    m_elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void RandomizedBenchmark::fitDecay()
+{
+    m_fit = RbFit();
+    if (m_points.empty())
+        return;
+    // Without noise every length survives alike and any decay fits
+    auto range = std::minmax_element(m_points.begin(), m_points.end(),
+                                     [](const RbPoint& a, const RbPoint& b) { return a.survival < b.survival; });
+    if (range.second->survival - range.first->survival < 1e-9) {
+        m_fit.decay = 1.0;
+        m_fit.offset = m_points.front().survival;
+        return;
+    }
+
+    // The model is linear in amplitude and offset, so only the decay needs a
+    // search; a golden-section search over [0, 1] finds it
+    const double ratio = 0.5 * (std::sqrt(5.0) - 1.0);
+    double low = 0.0, high = 1.0;
+    double amplitude, offset;
+    double a = high - ratio * (high - low), b = low + ratio * (high - low);
+    double fa = fitResidual(m_points, a, amplitude, offset);
+    double fb = fitResidual(m_points, b, amplitude, offset);
+    for (unsigned int i = 0; i < kFitIterations; ++i) {
+        if (fa < fb) {
+            high = b;
+            b = a;
+            fb = fa;
+            a = high - ratio * (high - low);
+            fa = fitResidual(m_points, a, amplitude, offset);
+        } else {
+            low = a;
+            a = b;
+            fa = fb;
+            b = low + ratio * (high - low);
+            fb = fitResidual(m_points, b, amplitude, offset);
+        }
+    }
+
+    m_fit.decay = 0.5 * (low + high);
+    fitResidual(m_points, m_fit.decay, m_fit.amplitude, m_fit.offset);
+    m_fit.errorPerClifford = 0.5 * (1.0 - m_fit.decay);
+}
@@ -0,0 +1,89 @@
+#include "RecordWriter.h"
+#include "BlochMath.h"
+#include "Endian.h"
+#include <charconv>
+#include <cstring>
+
+BlochRecord makeRecord(uint32_t circuit, uint32_t step, const glm::vec3& bloch)
+{
+    Amplitudes amplitudes = amplitudesFromBloch(bloch);
+    return { circuit, step, bloch.x, bloch.y, bloch.z,
+        amplitudes.alpha.real(), amplitudes.alpha.imag(),
+        amplitudes.beta.real(), amplitudes.beta.imag(),
+        purity(bloch) };
+}
+
+RecordWriter::RecordWriter(FILE* file, Format format)
+    : m_file(file), m_format(format), m_buffer(new char[kBufferSize]), m_used(0), m_records(0), m_failed(false)
+{
+}
+
+RecordWriter::~RecordWriter()
+{
+    flush();
+    delete[] m_buffer;
+}
+
+void RecordWriter::writeHeader()
+{
+    if (m_format != Format::Csv)
+        return;
+    static const char header[] = "circuit,step,x,y,z,alpha_re,alpha_im,beta_re,beta_im,purity\n";
+    if (m_used + sizeof(header) > kBufferSize)
+        flush();
+    std::memcpy(m_buffer + m_used, header, sizeof(header) - 1);
+    m_used += sizeof(header) - 1;
+}
+
+void RecordWriter::write(const BlochRecord& record)
+{
+    if (m_used + kMaxRecordSize > kBufferSize)
+        flush();
+    if (m_format == Format::Csv)
+        writeCsv(record);
+    else
+        writeBinary(record);
+    ++m_records;
+}
+
+void RecordWriter::writeCsv(const BlochRecord& record)
+{
+    // std::to_chars gives the shortest round-trip representation without
+    // going through the locale, which is several times faster than printf
+    char* out = m_buffer + m_used;
+    char* end = m_buffer + kBufferSize;
+    out = std::to_chars(out, end, record.circuit).ptr;
+    *out++ = ',';
+    out = std::to_chars(out, end, record.step).ptr;
+    const float values[] = { record.x, record.y, record.z, record.alphaRe, record.alphaIm, record.betaRe, record.betaIm, record.purity };
+    for (float value : values) {
+        *out++ = ',';
+        out = std::to_chars(out, end, value).ptr;
+    }
+    *out++ = '\n';
+    m_used = out - m_buffer;
+}
+
+void RecordWriter::writeBinary(const BlochRecord& record)
+{
+    unsigned char* out = reinterpret_cast<unsigned char*>(m_buffer + m_used);
+    out = storeLE(out, record.circuit);
+    out = storeLE(out, record.step);
+    out = storeLE(out, record.x);
+    out = storeLE(out, record.y);
+    out = storeLE(out, record.z);
+    out = storeLE(out, record.alphaRe);
+    out = storeLE(out, record.alphaIm);
+    out = storeLE(out, record.betaRe);
+    out = storeLE(out, record.betaIm);
+    out = storeLE(out, record.purity);
+    m_used = reinterpret_cast<char*>(out) - m_buffer;
+}
+
+bool RecordWriter::flush()
+{
+    if (m_used > 0 && !m_failed)
+        m_failed = std::fwrite(m_buffer, 1, m_used, m_file) != m_used;
+    m_used = 0;
+    return !m_failed && std::fflush(m_file) == 0;
+}
@@ -0,0 +1,206 @@
+#include "SessionLog.h"
+#include "Endian.h"
+#include <cstring>
+
+namespace {
+
+const unsigned char kSessionMagic[4] = { 'B', 'S', 'E', 'S' };
+const uint32_t kSessionVersion = 1;
+const size_t kHeaderSize = 8;
+const size_t kFlushSize = 64 * 1024;
+const size_t kMaxRecordSize = 32;
+
+// Payload bytes after the type byte, indexed by SessionEvent::Type
+const size_t kPayloadSize[] = { 8, 8, 3, 8, 10, 4, 1, 1, 8, 28 };
+const size_t kTypeCount = sizeof(kPayloadSize) / sizeof(kPayloadSize[0]);
+
+}
+
+SessionWriter::~SessionWriter()
+{
+    close();
+}
+
+bool SessionWriter::open(const char* path, std::string& error)
+{
+    close();
+    m_file = std::fopen(path, "wb");
+    if (!m_file) {
+        error = std::string("Could not create ") + path;
+        return false;
+    }
+    m_failed = false;
+    m_frames = 0;
+    m_buffer.reserve(kFlushSize + kMaxRecordSize);
+    m_buffer.assign(kSessionMagic, kSessionMagic + sizeof(kSessionMagic));
+    m_buffer.resize(kHeaderSize);
+    storeLE(m_buffer.data() + 4, kSessionVersion);
+    return true;
+}
+
+bool SessionWriter::close()
+{
+    if (!m_file)
+        return true;
+    flush();
+    bool ok = !m_failed && std::fclose(m_file) == 0;
+    m_file = nullptr;
+    return ok;
+}
+
+bool SessionWriter::flush()
+{
+    if (!m_buffer.empty() && !m_failed)
+        m_failed = std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size();
+    m_buffer.clear();
+    return !m_failed;
+}
+
+void SessionWriter::beginFrame(double time)
+{
+    SessionEvent event;
+    event.type = SessionEvent::Frame;
+    event.x = time;
+    write(event);
+    ++m_frames;
+}
+
+void SessionWriter::write(const SessionEvent& event)
+{
+    if (!m_file)
+        return;
+    size_t start = m_buffer.size();
+    m_buffer.resize(start + 1 + kPayloadSize[event.type]);
+    unsigned char* out = m_buffer.data() + start;
+    *out++ = event.type;
+
+    switch (event.type) {
+    case SessionEvent::Frame:
+        storeLE(out, event.x);
+        break;
+    case SessionEvent::CursorPos:
+    case SessionEvent::Scroll:
+        out = storeLE(out, static_cast<float>(event.x));
+        storeLE(out, static_cast<float>(event.y));
+        break;
+    case SessionEvent::MouseButton:
+        out[0] = static_cast<unsigned char>(event.code);
+        out[1] = static_cast<unsigned char>(event.action);
+        out[2] = static_cast<unsigned char>(event.mods);
+        break;
+    case SessionEvent::Key:
+        out = storeLE(out, static_cast<uint32_t>(event.code));
+        out = storeLE(out, static_cast<uint32_t>(event.scancode));
+        out[0] = static_cast<unsigned char>(event.action);
+        out[1] = static_cast<unsigned char>(event.mods);
+        break;
+    case SessionEvent::Char:
+        storeLE(out, static_cast<uint32_t>(event.code));
+        break;
+    case SessionEvent::CursorEnter:
+    case SessionEvent::WindowFocus:
+        out[0] = event.code ? 1 : 0;
+        break;
+    case SessionEvent::FramebufferSize:
+        out = storeLE(out, static_cast<uint32_t>(event.x));
+        storeLE(out, static_cast<uint32_t>(event.y));
+        break;
+    case SessionEvent::State:
+        out = storeLE(out, event.sample.timestamp);
+        out = storeLE(out, event.sample.kind);
+        for (int v = 0; v < 4; ++v)
+            out = storeLE(out, event.sample.values[v]);
+        break;
+    }
+
+    if (m_buffer.size() >= kFlushSize)
+        flush();
+}
+
+bool SessionReader::open(const char* path, std::string& error)
+{
+    close();
+    if (!m_file.open(path, error))
+        return false;
+    if (m_file.size() < kHeaderSize || std::memcmp(m_file.data(), kSessionMagic, sizeof(kSessionMagic)) != 0) {
+        error = std::string(path) + " is not a session log";
+        close();
+        return false;
+    }
+    if (loadLE32(m_file.data() + 4) != kSessionVersion) {
+        error = std::string(path) + " has an unsupported session log version";
+        close();
+        return false;
+    }
+    m_offset = kHeaderSize;
+    return true;
+}
+
+void SessionReader::close()
+{
+    m_file.close();
+    m_offset = 0;
+}
+
+bool SessionReader::readFrame(double& time, std::vector<SessionEvent>& events)
+{
+    events.clear();
+    const unsigned char* data = m_file.data();
+    size_t size = m_file.size();
+    if (m_offset + 1 + kPayloadSize[SessionEvent::Frame] > size || data[m_offset] != SessionEvent::Frame)
+        return false;
+    time = loadLEDouble(data + m_offset + 1);
+    m_offset += 1 + kPayloadSize[SessionEvent::Frame];
+
+    while (m_offset < size && data[m_offset] != SessionEvent::Frame) {
+        unsigned char type = data[m_offset];
+        if (type >= kTypeCount || m_offset + 1 + kPayloadSize[type] > size) {
+            m_offset = size;
+            return false;
+        }
+        const unsigned char* in = data + m_offset + 1;
+        m_offset += 1 + kPayloadSize[type];
+
+        SessionEvent event;
+        event.type = static_cast<SessionEvent::Type>(type);
+        switch (event.type) {
+        case SessionEvent::Frame:
+            break;
+        case SessionEvent::CursorPos:
+        case SessionEvent::Scroll:
+            event.x = loadLEFloat(in);
+            event.y = loadLEFloat(in + 4);
+            break;
+        case SessionEvent::MouseButton:
+            event.code = in[0];
+            event.action = in[1];
+            event.mods = in[2];
+            break;
+        case SessionEvent::Key:
+            event.code = static_cast<int32_t>(loadLE32(in));
+            event.scancode = static_cast<int32_t>(loadLE32(in + 4));
+            event.action = in[8];
+            event.mods = in[9];
+            break;
+        case SessionEvent::Char:
+            event.code = static_cast<int>(loadLE32(in));
+            break;
+        case SessionEvent::CursorEnter:
+        case SessionEvent::WindowFocus:
+            event.code = in[0];
+            break;
+        case SessionEvent::FramebufferSize:
+            event.x = loadLE32(in);
+            event.y = loadLE32(in + 4);
+            break;
+        case SessionEvent::State:
+            event.sample.timestamp = loadLEDouble(in);
+            event.sample.kind = loadLE32(in + 8);
+            for (int v = 0; v < 4; ++v)
+                event.sample.values[v] = loadLEFloat(in + 12 + v * 4);
+            break;
+        }
+        events.push_back(event);
+    }
+    return true;
+}
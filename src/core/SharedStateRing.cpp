@@ -0,0 +1,165 @@
+#include "SharedStateRing.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint32_t kRingMagic = 0x42535452; // "BSTR"
+const uint32_t kRingVersion = 1;
+
+uint32_t roundUpToPowerOfTwo(uint32_t value)
+{
+    uint32_t result = 1;
+    while (result < value && result < (1u << 31))
+        result <<= 1;
+    return result;
+}
+
+std::string systemName(const char* name)
+{
+#ifdef _WIN32
+    return std::string("Local\\") + name;
+#else
+    return name[0] == '/' ? std::string(name) : std::string("/") + name;
+#endif
+}
+
+}
+
+SharedStateRing::~SharedStateRing()
+{
+    close();
+}
+
+bool SharedStateRing::create(const char* name, uint32_t capacity, std::string& error)
+{
+    close();
+    capacity = roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity);
+    if (!map(name, SpscRing<StateSample>::bytesFor(capacity), true, error))
+        return false;
+
+    SpscRing<StateSample>::initialize(m_memory, capacity, kRingMagic, kRingVersion);
+    m_ring.attach(m_memory);
+    m_owner = true;
+    return true;
+}
+
+bool SharedStateRing::open(const char* name, std::string& error)
+{
+    close();
+    if (!map(name, 0, false, error))
+        return false;
+
+    const SpscRingHeader* header = static_cast<const SpscRingHeader*>(m_memory);
+    if (m_size < sizeof(SpscRingHeader) || header->magic.load(std::memory_order_acquire) != kRingMagic || header->version != kRingVersion
+        || header->slotSize != sizeof(StateSample) || m_size < SpscRing<StateSample>::bytesFor(header->capacity)) {
+        error = "shared memory '" + std::string(name) + "' is not a state ring";
+        close();
+        return false;
+    }
+    m_ring.attach(m_memory);
+    return true;
+}
+
+#ifdef _WIN32
+
+bool SharedStateRing::map(const char* name, size_t size, bool create, std::string& error)
+{
+    m_name = systemName(name);
+    HANDLE mapping = create
+        ? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, m_name.c_str())
+        : OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, m_name.c_str());
+    if (!mapping) {
+        error = "cannot " + std::string(create ? "create" : "open") + " shared memory '" + name + "'";
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!view) {
+        CloseHandle(mapping);
+        error = "cannot map shared memory '" + std::string(name) + "'";
+        return false;
+    }
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(view, &info, sizeof(info));
+
+    m_mapping = mapping;
+    m_memory = view;
+    m_size = create ? size : info.RegionSize;
+    return true;
+}
+
+void SharedStateRing::close()
+{
+    // Windows removes the mapping with its last handle
+    if (m_memory)
+        UnmapViewOfFile(m_memory);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    m_mapping = nullptr;
+    m_memory = nullptr;
+    m_size = 0;
+    m_owner = false;
+    m_ring = SpscRing<StateSample>();
+}
+
+#else
+
+bool SharedStateRing::map(const char* name, size_t size, bool create, std::string& error)
+{
+    m_name = systemName(name);
+    int fd = create ? shm_open(m_name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600) : shm_open(m_name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        error = "cannot " + std::string(create ? "create" : "open") + " shared memory '" + name + "'";
+        return false;
+    }
+    if (create && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        shm_unlink(m_name.c_str());
+        error = "cannot size shared memory '" + std::string(name) + "'";
+        return false;
+    }
+    if (!create) {
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            error = "cannot stat shared memory '" + std::string(name) + "'";
+            return false;
+        }
+        size = static_cast<size_t>(info.st_size);
+    }
+    void* memory = size > 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        if (create)
+            shm_unlink(m_name.c_str());
+        error = "cannot map shared memory '" + std::string(name) + "'";
+        return false;
+    }
+
+    m_memory = memory;
+    m_size = size;
+    return true;
+}
+
+void SharedStateRing::close()
+{
+    if (m_memory)
+        munmap(m_memory, m_size);
+    if (m_owner)
+        shm_unlink(m_name.c_str());
+    m_memory = nullptr;
+    m_size = 0;
+    m_owner = false;
+    m_ring = SpscRing<StateSample>();
+}
+
+#endif
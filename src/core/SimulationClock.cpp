@@ -0,0 +1,48 @@
+#include "SimulationClock.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double kMinFixedStep = 1e-9;
+
+}
+
+SimulationClock::SimulationClock(double fixedStep) : m_fixedStep(std::max(fixedStep, kMinFixedStep))
+{
+}
+
+void SimulationClock::setFixedStep(double seconds)
+{
+    // Keep the same fraction of a step accumulated
+    double alpha = this->alpha();
+    m_fixedStep = std::max(seconds, kMinFixedStep);
+    m_accumulator = alpha * m_fixedStep;
+}
+
+void SimulationClock::fastForward(double seconds)
+{
+    if (seconds > 0.0)
+        m_queuedSteps += (uint64_t)std::ceil(seconds / m_fixedStep);
+}
+
+void SimulationClock::advance(double wallSeconds)
+{
+    if (m_paused || wallSeconds <= 0.0)
+        return;
+    m_accumulator = std::min(m_accumulator + wallSeconds * m_timeScale, m_maxLagSteps * m_fixedStep);
+}
+
+bool SimulationClock::consumeStep()
+{
+    if (m_queuedSteps > 0) {
+        --m_queuedSteps;
+    } else if (m_accumulator >= m_fixedStep) {
+        m_accumulator -= m_fixedStep;
+    } else {
+        return false;
+    }
+    m_time += m_fixedStep;
+    ++m_steps;
+    return true;
+}
@@ -0,0 +1,268 @@
+#include "SimulationThread.h"
+#include <algorithm>
+#include <chrono>
+#include "BlochMath.h"
+
+namespace {
+
+const uint32_t kCommandMagic = 0x4253494D; // "BSIM"
+const uint32_t kSampleMagic = 0x42534D50;  // "BSMP"
+const double kRateWindowSeconds = 0.5;
+// A tick stops running steps after this long and publishes what it has, so a
+// long fast-forward still shows progress and keeps reading commands
+const double kTickBudgetSeconds = 0.02;
+// Wall time between ticks beyond this is treated as a stall and not simulated
+const double kMaxTickSeconds = 0.25;
+
+uint32_t powerOfTwoAtLeast(size_t count)
+{
+    uint32_t capacity = 1;
+    while (capacity < count)
+        capacity <<= 1;
+    return capacity;
+}
+
+// Memory for a ring of `capacity` slots with the control block on a cache line
+template <typename T>
+void* allocateRing(std::unique_ptr<unsigned char[]>& memory, uint32_t capacity)
+{
+    memory.reset(new unsigned char[SpscRing<T>::bytesFor(capacity) + 64]);
+    return reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(memory.get()) + 63) & ~uintptr_t(63));
+}
+
+}
+
+glm::vec3 SimulationSnapshot::displayBloch(double now) const
+{
+    double t = alpha;
+    if (!paused)
+        t += (now - publishedAt) * timeScale / fixedStep;
+    return interpolateBloch(previousBloch, bloch, (float)std::min(std::max(t, 0.0), 1.0));
+}
+
+SimulationThread::SimulationThread(size_t maxTrail, uint32_t commandCapacity)
+    : m_maxTrail(maxTrail), m_samplesPushed(0), m_samplesConsumed(0), m_running(false), m_tickHz(1000.0),
+      m_bloch(0.0f, 0.0f, 1.0f), m_previousBloch(0.0f, 0.0f, 1.0f), m_stateVersion(0), m_trailVersion(0),
+      m_evolve(false), m_substeps(1), m_stepRate(0.0), m_rateWindowStart(steadySeconds()), m_rateWindowStep(0)
+{
+    uint32_t capacity = powerOfTwoAtLeast(commandCapacity);
+    void* commands = allocateRing<SimulationCommand>(m_commandMemory, capacity);
+    SpscRing<SimulationCommand>::initialize(commands, capacity, kCommandMagic, 1);
+    m_commands.attach(commands);
+    // Room for a few frames of full batches before the simulation drains them
+    capacity = powerOfTwoAtLeast(std::max<size_t>(4 * m_maxTrail, 64));
+    void* samples = allocateRing<glm::vec3>(m_sampleMemory, capacity);
+    SpscRing<glm::vec3>::initialize(samples, capacity, kSampleMagic, 1);
+    m_samples.attach(samples);
+    m_trail.reserve(2 * m_maxTrail);
+}
+
+SimulationThread::~SimulationThread()
+{
+    stop();
+}
+
+void SimulationThread::start(double tickHz)
+{
+    stop();
+    m_tickHz = std::max(tickHz, 1.0);
+    m_running.store(true, std::memory_order_relaxed);
+    m_thread = std::thread(&SimulationThread::run, this);
+}
+
+void SimulationThread::stop()
+{
+    m_running.store(false, std::memory_order_relaxed);
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+bool SimulationThread::post(const SimulationCommand& command)
+{
+    return m_commands.tryPush(command);
+}
+
+bool SimulationThread::setState(const glm::vec3& bloch)
+{
+    SimulationCommand command;
+    command.type = SimulationCommand::SetState;
+    command.bloch = bloch;
+    return post(command);
+}
+
+bool SimulationThread::inject(const glm::vec3& bloch)
+{
+    return injectBatch(&bloch, 1);
+}
+
+bool SimulationThread::injectBatch(const glm::vec3* samples, size_t count)
+{
+    if (count == 0)
+        return true;
+    size_t queued = std::min(count, std::max<size_t>(m_maxTrail, 1));
+    if (!m_samples.tryPushAll(samples + count - queued, queued))
+        return false;
+    m_samplesPushed += queued;
+
+    SimulationCommand command;
+    command.type = SimulationCommand::Inject;
+    command.sampleEnd = m_samplesPushed;
+    return post(command);
+}
+
+bool SimulationThread::clearTrail()
+{
+    SimulationCommand command;
+    command.type = SimulationCommand::ClearTrail;
+    return post(command);
+}
+
+bool SimulationThread::setClock(bool paused, double timeScale, double fixedStep)
+{
+    SimulationCommand command;
+    command.type = SimulationCommand::SetClock;
+    command.paused = paused;
+    command.timeScale = timeScale;
+    command.seconds = fixedStep;
+    return post(command);
+}
+
+bool SimulationThread::singleStep()
+{
+    SimulationCommand command;
+    command.type = SimulationCommand::SingleStep;
+    return post(command);
+}
+
+bool SimulationThread::fastForward(double seconds)
+{
+    SimulationCommand command;
+    command.type = SimulationCommand::FastForward;
+    command.seconds = seconds;
+    return post(command);
+}
+
+void SimulationThread::run()
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_tickHz));
+    Clock::time_point last = Clock::now();
+    Clock::time_point next = last;
+    while (m_running.load(std::memory_order_relaxed)) {
+        Clock::time_point now = Clock::now();
+        double wall = std::chrono::duration<double>(now - last).count();
+        last = now;
+        tick(std::min(wall, kMaxTickSeconds));
+
+        // The clock carries any lateness, so the schedule only has to avoid
+        // drifting, not catch up
+        next += period;
+        if (next < now)
+            next = now + period;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void SimulationThread::appendTrail(const glm::vec3& bloch)
+{
+    // Keep the newest m_maxTrail points, trimming in bulk
+    if (m_trail.size() >= 2 * m_maxTrail)
+        m_trail.erase(m_trail.begin(), m_trail.end() - (m_maxTrail - 1));
+    m_trail.push_back(bloch);
+    ++m_trailVersion;
+}
+
+void SimulationThread::applyCommand(const SimulationCommand& command)
+{
+    switch (command.type) {
+    case SimulationCommand::SetState:
+        m_bloch = m_previousBloch = command.bloch;
+        break;
+    case SimulationCommand::Inject: {
+        size_t count = (size_t)(command.sampleEnd - m_samplesConsumed);
+        size_t drained = m_samples.drain([this](const glm::vec3& bloch) {
+            appendTrail(bloch);
+            m_bloch = bloch;
+        }, count);
+        m_samplesConsumed += drained;
+        if (drained > 0) {
+            m_previousBloch = m_bloch;
+            ++m_stateVersion;
+        }
+        break;
+    }
+    case SimulationCommand::SetDynamics:
+        m_evolve = command.evolve;
+        m_substeps = std::max(command.substeps, 1u);
+        m_params = command.params;
+        break;
+    case SimulationCommand::ClearTrail:
+        m_trail.clear();
+        ++m_trailVersion;
+        break;
+    case SimulationCommand::SetClock:
+        m_clock.setPaused(command.paused);
+        m_clock.setTimeScale(command.timeScale);
+        m_clock.setFixedStep(command.seconds);
+        break;
+    case SimulationCommand::SingleStep:
+        m_clock.singleStep();
+        break;
+    case SimulationCommand::FastForward:
+        m_clock.fastForward(command.seconds);
+        break;
+    }
+}
+
+void SimulationThread::tick(double wallSeconds)
+{
+    double start = steadySeconds();
+    m_commands.drain([this](const SimulationCommand& command) { applyCommand(command); });
+    m_clock.advance(wallSeconds);
+
+    float dt = (float)m_clock.fixedStep();
+    while (m_clock.consumeStep()) {
+        m_previousBloch = m_bloch;
+        if (m_evolve) {
+            m_bloch = evolveBloch(m_bloch, m_params, dt, m_substeps);
+            ++m_stateVersion;
+            appendTrail(m_bloch);
+        }
+        if ((m_clock.steps() & 255) == 0 && steadySeconds() - start > kTickBudgetSeconds)
+            break;
+    }
+    publish();
+}
+
+void SimulationThread::publish()
+{
+    double now = steadySeconds();
+    if (now - m_rateWindowStart >= kRateWindowSeconds) {
+        m_stepRate = (m_clock.steps() - m_rateWindowStep) / (now - m_rateWindowStart);
+        m_rateWindowStart = now;
+        m_rateWindowStep = m_clock.steps();
+    }
+
+    SimulationSnapshot& snapshot = m_snapshots.writeSlot();
+    snapshot.step = m_clock.steps();
+    snapshot.time = m_clock.time();
+    snapshot.bloch = m_bloch;
+    snapshot.previousBloch = m_previousBloch;
+    snapshot.stateVersion = m_stateVersion;
+    snapshot.alpha = m_clock.alpha();
+    snapshot.publishedAt = now;
+    snapshot.fixedStep = m_clock.fixedStep();
+    snapshot.timeScale = m_clock.timeScale();
+    snapshot.paused = m_clock.isPaused();
+    snapshot.queuedSteps = m_clock.queuedSteps();
+    snapshot.stepRate = m_stepRate;
+    snapshot.commandDrops = m_commands.dropped();
+    snapshot.sampleDrops = m_samples.dropped();
+    // The slot may be two publishes old, so compare against its own version
+    if (snapshot.trailVersion != m_trailVersion) {
+        size_t shown = std::min(m_trail.size(), m_maxTrail);
+        snapshot.trail.assign(m_trail.end() - shown, m_trail.end());
+        snapshot.trailVersion = m_trailVersion;
+    }
+    m_snapshots.publish();
+}
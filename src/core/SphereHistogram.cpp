@@ -0,0 +1,204 @@
+#include "SphereHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include "Parallel.h"
+
+namespace {
+
+// Points per worker
+const size_t kMinPointsPerWorker = 1 << 16;
+
+// Face and position within it, as in HEALPix's ang2pix for the nested scheme
+inline unsigned int texelOf(unsigned int nside, float x, float y, float z)
+{
+    const float kTwoOverPi = 0.63661977236758134f;
+    float length = std::sqrt(x * x + y * y + z * z);
+    float cosTheta = z / length;
+    float za = std::fabs(cosTheta);
+    float tt = std::atan2(y, x) * kTwoOverPi;  // in [-2, 2]
+    if (tt < 0.0f)
+        tt += 4.0f;
+    int n = (int)nside;
+    int face, ix, iy;
+    if (za <= 2.0f / 3.0f) {
+        // Equatorial region
+        float temp1 = n * (0.5f + tt);
+        float temp2 = n * (cosTheta * 0.75f);
+        int jp = (int)(temp1 - temp2);
+        int jm = (int)(temp1 + temp2);
+        int ifp = jp / n;
+        int ifm = jm / n;
+        face = ifp == ifm ? (ifp & 3) | 4 : (ifp < ifm ? ifp & 3 : (ifm & 3) + 8);
+        ix = jm & (n - 1);
+        iy = n - (jp & (n - 1)) - 1;
+    } else {
+        // Polar caps; 1 - |cos| from the sine, which keeps precision near the poles
+        int ntt = std::min(3, (int)tt);
+        float tp = tt - ntt;
+        float sinSquared = (x * x + y * y) / (length * length);
+        float tmp = n * std::sqrt(3.0f * sinSquared / (1.0f + za));
+        int jp = std::min(n - 1, (int)(tp * tmp));
+        int jm = std::min(n - 1, (int)((1.0f - tp) * tmp));
+        if (cosTheta >= 0.0f) {
+            face = ntt;
+            ix = n - jm - 1;
+            iy = n - jp - 1;
+        } else {
+            face = ntt + 8;
+            ix = jp;
+            iy = jm;
+        }
+    }
+    // Directions that round badly (a length that underflows, say) must still
+    // land inside the texture
+    face = std::min(std::max(face, 0), 11);
+    ix = std::min(std::max(ix, 0), n - 1);
+    iy = std::min(std::max(iy, 0), n - 1);
+    unsigned int column = (unsigned int)(face & 3) * nside + (unsigned int)ix;
+    unsigned int row = (unsigned int)(face >> 2) * nside + (unsigned int)iy;
+    return row * 4 * nside + column;
+}
+
+// Zero vectors have no direction, and NaN or infinite ones come from bad input
+inline bool binnable(const glm::vec3& p)
+{
+    return (p.x != 0.0f || p.y != 0.0f || p.z != 0.0f) && std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+}
+
+}
+
+unsigned int healpixTexel(unsigned int nside, const glm::vec3& direction)
+{
+    return texelOf(nside, direction.x, direction.y, direction.z);
+}
+
+SphereHistogram::SphereHistogram(unsigned int nside) : m_dirtyFirst(0), m_dirtyEnd(0)
+{
+    reset(nside);
+}
+
+void SphereHistogram::reset(unsigned int nside)
+{
+    m_nside = nside;
+    m_counts.assign((size_t)width() * height(), 0);
+    m_workers.clear();
+    m_total = 0;
+    m_peak = 0;
+    markRows(0, height());
+}
+
+void SphereHistogram::clear()
+{
+    std::fill(m_counts.begin(), m_counts.end(), 0u);
+    m_total = 0;
+    m_peak = 0;
+    markRows(0, height());
+}
+
+void SphereHistogram::markRows(unsigned int first, unsigned int end)
+{
+    if (first >= end)
+        return;
+    if (m_dirtyFirst >= m_dirtyEnd) {
+        m_dirtyFirst = first;
+        m_dirtyEnd = end;
+    } else {
+        m_dirtyFirst = std::min(m_dirtyFirst, first);
+        m_dirtyEnd = std::max(m_dirtyEnd, end);
+    }
+}
+
+bool SphereHistogram::takeDirtyRows(unsigned int& first, unsigned int& end)
+{
+    if (m_dirtyFirst >= m_dirtyEnd)
+        return false;
+    first = m_dirtyFirst;
+    end = m_dirtyEnd;
+    m_dirtyFirst = m_dirtyEnd = 0;
+    return true;
+}
+
+void SphereHistogram::add(const glm::vec3* points, size_t count)
+{
+    unsigned int rowWidth = width();
+    if (count < 2 * kMinPointsPerWorker) {
+        unsigned int firstRow = height(), endRow = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec3& p = points[i];
+            if (!binnable(p))
+                continue;
+            unsigned int texel = texelOf(m_nside, p.x, p.y, p.z);
+            uint32_t value = ++m_counts[texel];
+            m_peak = std::max(m_peak, value);
+            unsigned int row = texel / rowWidth;
+            firstRow = std::min(firstRow, row);
+            endRow = std::max(endRow, row + 1);
+            ++m_total;
+        }
+        markRows(firstRow, endRow);
+        return;
+    }
+
+    // Each worker bins its share into its own zeroed histogram
+    m_workers.resize(workerCount());
+    for (Worker& worker : m_workers)
+        worker.total = 0;
+    size_t bins = m_counts.size();
+    parallelFor(count, kMinPointsPerWorker, [&](size_t begin, size_t end, unsigned int w) {
+        Worker& worker = m_workers[w];
+        if (worker.counts.size() != bins)
+            worker.counts.assign(bins, 0);
+        worker.firstRow = height();
+        worker.endRow = 0;
+        worker.total = 0;
+        uint32_t* counts = worker.counts.data();
+        unsigned int firstTexel = (unsigned int)bins, lastTexel = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const glm::vec3& p = points[i];
+            if (!binnable(p))
+                continue;
+            unsigned int texel = texelOf(m_nside, p.x, p.y, p.z);
+            ++counts[texel];
+            firstTexel = std::min(firstTexel, texel);
+            lastTexel = std::max(lastTexel, texel);
+            ++worker.total;
+        }
+        if (worker.total > 0) {
+            worker.firstRow = firstTexel / rowWidth;
+            worker.endRow = lastTexel / rowWidth + 1;
+        }
+    });
+
+    // Then the rows any worker touched are summed, split across the workers
+    unsigned int firstRow = height(), endRow = 0;
+    for (Worker& worker : m_workers) {
+        if (worker.total == 0)
+            continue;
+        firstRow = std::min(firstRow, worker.firstRow);
+        endRow = std::max(endRow, worker.endRow);
+        m_total += worker.total;
+    }
+    if (firstRow >= endRow)
+        return;
+    size_t mergeBegin = (size_t)firstRow * rowWidth;
+    size_t mergeCount = (size_t)(endRow - firstRow) * rowWidth;
+    std::vector<uint32_t> peaks(workerCount(), 0);
+    parallelFor(mergeCount, 4096, [&](size_t begin, size_t end, unsigned int w) {
+        uint32_t peak = 0;
+        for (Worker& worker : m_workers) {
+            if (worker.total == 0)
+                continue;
+            uint32_t* counts = worker.counts.data() + mergeBegin;
+            for (size_t i = begin; i < end; ++i) {
+                m_counts[mergeBegin + i] += counts[i];
+                counts[i] = 0;
+            }
+        }
+        for (size_t i = begin; i < end; ++i)
+            peak = std::max(peak, m_counts[mergeBegin + i]);
+        peaks[w] = peak;
+    });
+    for (uint32_t peak : peaks)
+        m_peak = std::max(m_peak, peak);
+    markRows(firstRow, endRow);
+}
@@ -0,0 +1,369 @@
+#include "SphereIndex.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const unsigned int kLevels = 16;
+const uint32_t kCells = 1u << kLevels;  // per face side
+// Nodes with this many points or fewer are scanned rather than split
+const uint32_t kLeafSize = 32;
+// Inserted points are scanned one by one until there are this many
+const size_t kMaxPending = 1024;
+// The recent run is merged into the main one at this size, or 1/8 of it
+const size_t kMinRecent = 16384;
+// Nodes this close to the edge of a cap are tested point by point
+const float kCapMargin = 1e-4f;
+const unsigned int kRadixBits = 12;
+const unsigned int kRadixPasses = 3;  // covers the 35-bit keys
+
+// Spreads the low 16 bits of v to the even bits
+uint32_t spreadBits(uint32_t v)
+{
+    v &= 0xFFFF;
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+// Quadratic warp between the gnomonic coordinate u on the cube face and the
+// face coordinate s, both in [-1, 1]; close to the tangent warp that makes
+// cells equal in area, at the cost of a square root
+float cubeCoordinate(float s)
+{
+    return s >= 0.0f ? ((s + 1.0f) * (s + 1.0f) - 1.0f) / 3.0f : (1.0f - (1.0f - s) * (1.0f - s)) / 3.0f;
+}
+
+float faceCoordinate(float u)
+{
+    return u >= 0.0f ? std::sqrt(1.0f + 3.0f * u) - 1.0f : 1.0f - std::sqrt(1.0f - 3.0f * u);
+}
+
+// Direction through face coordinates (s, t) of `face`
+glm::vec3 faceDirection(unsigned int face, float s, float t)
+{
+    unsigned int axis = face % 3;
+    glm::vec3 p;
+    p[axis] = face < 3 ? 1.0f : -1.0f;
+    p[(axis + 1) % 3] = cubeCoordinate(s);
+    p[(axis + 2) % 3] = cubeCoordinate(t);
+    return glm::normalize(p);
+}
+
+// Accurate for small angles too, unlike acos of the dot product
+float angleBetween(const glm::vec3& a, const glm::vec3& b)
+{
+    return std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b));
+}
+
+glm::vec3 unitDirection(const glm::vec3& v)
+{
+    float length = glm::length(v);
+    return length > 0.0f ? v / length : glm::vec3(0.0f, 0.0f, 1.0f);
+}
+
+// Frontier entry of the nearest-neighbour search
+struct Candidate {
+    float bound;  // largest possible dot product with the query
+    uint32_t node;
+    bool operator<(const Candidate& other) const { return bound < other.bound; }
+};
+
+}
+
+uint64_t SphereIndex::keyOf(const glm::vec3& direction)
+{
+    glm::vec3 a = glm::abs(direction);
+    unsigned int axis = a.x >= a.y ? (a.x >= a.z ? 0 : 2) : (a.y >= a.z ? 1 : 2);
+    unsigned int face = axis + (direction[axis] < 0.0f ? 3 : 0);
+    float major = a[axis];
+    uint32_t cell[2];
+    for (int k = 0; k < 2; ++k) {
+        float u = direction[(axis + 1 + k) % 3] / major;
+        float s = faceCoordinate(u);
+        float scaled = (s + 1.0f) * 0.5f * kCells;
+        cell[k] = (uint32_t)std::min(std::max(scaled, 0.0f), (float)(kCells - 1));
+    }
+    return (uint64_t)face << 32 | (spreadBits(cell[0]) | spreadBits(cell[1]) << 1);
+}
+
+void SphereIndex::nodeCap(const Node& node, glm::vec3& center, float& radius)
+{
+    float size = 2.0f / (float)(1u << node.level);
+    float s0 = -1.0f + node.x * size, t0 = -1.0f + node.y * size;
+    center = faceDirection(node.face, s0 + 0.5f * size, t0 + 0.5f * size);
+    // Cell edges are great circles, so the farthest point is a corner
+    radius = 0.0f;
+    for (int corner = 0; corner < 4; ++corner) {
+        glm::vec3 p = faceDirection(node.face, s0 + (corner & 1) * size, t0 + (corner >> 1) * size);
+        radius = std::max(radius, angleBetween(center, p));
+    }
+    radius += 1e-5f;  // float slack
+}
+
+int SphereIndex::faces(const Run& run, Node* out)
+{
+    int count = 0;
+    uint32_t begin = 0, size = (uint32_t)run.keys.size();
+    for (unsigned int face = 0; face < 6 && begin < size; ++face) {
+        uint64_t next = (uint64_t)(face + 1) << 32;
+        uint32_t end = (uint32_t)(std::lower_bound(run.keys.begin() + begin, run.keys.end(), next) - run.keys.begin());
+        if (end > begin)
+            out[count++] = { face, 0, 0, 0, begin, end };
+        begin = end;
+    }
+    return count;
+}
+
+int SphereIndex::children(const Run& run, const Node& node, Node* out)
+{
+    unsigned int shift = 2 * (kLevels - node.level - 1);
+    uint64_t prefix = (uint64_t)(spreadBits(node.x) | spreadBits(node.y) << 1) << 2;
+    uint64_t base = (uint64_t)node.face << 32;
+    const uint64_t* keys = run.keys.data();
+    int count = 0;
+    uint32_t begin = node.begin;
+    for (uint32_t c = 0; c < 4; ++c) {
+        uint32_t end = node.end;
+        if (c < 3) {
+            uint64_t next = base | (prefix + c + 1) << shift;
+            end = (uint32_t)(std::lower_bound(keys + begin, keys + node.end, next) - keys);
+        }
+        if (end > begin) {
+            Node& child = out[count++];
+            child.face = node.face;
+            child.level = node.level + 1;
+            child.x = 2 * node.x + (c & 1);
+            child.y = 2 * node.y + (c >> 1);
+            child.begin = begin;
+            child.end = end;
+        }
+        begin = end;
+    }
+    return count;
+}
+
+void SphereIndex::clear()
+{
+    m_points.clear();
+    m_main = Run();
+    m_recent = Run();
+    m_pending.clear();
+}
+
+void SphereIndex::build(const glm::vec3* points, size_t count)
+{
+    clear();
+    m_points.assign(points, points + count);
+    indexPoints();
+}
+
+void SphereIndex::indexPoints()
+{
+    size_t count = m_points.size();
+    std::vector<uint64_t> keys(count), keysTmp(count);
+    std::vector<uint32_t> ids(count), idsTmp(count);
+    parallelFor(count, 16384, [&](size_t begin, size_t end, unsigned int) {
+        for (size_t i = begin; i < end; ++i) {
+            m_points[i] = unitDirection(m_points[i]);
+            keys[i] = keyOf(m_points[i]);
+            ids[i] = (uint32_t)i;
+        }
+    });
+
+    // LSD radix sort of (key, id); stable, so equal keys keep id order
+    const size_t kBuckets = size_t(1) << kRadixBits;
+    std::vector<size_t> offsets(kBuckets);
+    for (unsigned int pass = 0; pass < kRadixPasses; ++pass) {
+        unsigned int shift = pass * kRadixBits;
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (size_t i = 0; i < count; ++i)
+            ++offsets[(keys[i] >> shift) & (kBuckets - 1)];
+        size_t sum = 0;
+        for (size_t& offset : offsets) {
+            size_t n = offset;
+            offset = sum;
+            sum += n;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            size_t slot = offsets[(keys[i] >> shift) & (kBuckets - 1)]++;
+            keysTmp[slot] = keys[i];
+            idsTmp[slot] = ids[i];
+        }
+        keys.swap(keysTmp);
+        ids.swap(idsTmp);
+    }
+
+    m_main.keys.swap(keys);
+    m_main.ids.swap(ids);
+    m_main.points.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        m_main.points[i] = m_points[m_main.ids[i]];
+}
+
+uint32_t SphereIndex::insert(const glm::vec3& point)
+{
+    uint32_t id = (uint32_t)m_points.size();
+    m_points.push_back(unitDirection(point));
+    m_pending.push_back(id);
+    if (m_pending.size() >= kMaxPending)
+        mergePending();
+    return id;
+}
+
+void SphereIndex::merge(Run& run, const std::vector<std::pair<uint64_t, uint32_t>>& added)
+{
+    size_t total = run.keys.size() + added.size();
+    Run merged;
+    merged.keys.reserve(total);
+    merged.ids.reserve(total);
+    merged.points.reserve(total);
+    size_t a = 0, b = 0;
+    while (a < run.keys.size() || b < added.size()) {
+        if (b == added.size() || (a < run.keys.size() && run.keys[a] <= added[b].first)) {
+            merged.keys.push_back(run.keys[a]);
+            merged.ids.push_back(run.ids[a]);
+            merged.points.push_back(run.points[a++]);
+        } else {
+            merged.keys.push_back(added[b].first);
+            merged.ids.push_back(added[b].second);
+            merged.points.push_back(m_points[added[b++].second]);
+        }
+    }
+    run = std::move(merged);
+}
+
+void SphereIndex::mergePending()
+{
+    m_added.resize(m_pending.size());
+    for (size_t i = 0; i < m_pending.size(); ++i)
+        m_added[i] = std::make_pair(keyOf(m_points[m_pending[i]]), m_pending[i]);
+    std::sort(m_added.begin(), m_added.end());
+    m_pending.clear();
+    merge(m_recent, m_added);
+
+    if (m_recent.keys.size() >= std::max(kMinRecent, m_main.keys.size() / 8)) {
+        m_added.resize(m_recent.keys.size());
+        for (size_t i = 0; i < m_added.size(); ++i)
+            m_added[i] = std::make_pair(m_recent.keys[i], m_recent.ids[i]);
+        merge(m_main, m_added);
+        m_recent = Run();
+    }
+}
+
+void SphereIndex::nearest(const glm::vec3& direction, size_t k, std::vector<Neighbor>& out) const
+{
+    out.clear();
+    if (k == 0 || m_points.empty())
+        return;
+    glm::vec3 q = unitDirection(direction);
+
+    // Best k so far as a min-heap on the dot product, worst at the front
+    struct Best {
+        float dot;
+        uint32_t id;
+        bool operator<(const Best& other) const { return dot > other.dot; }
+    };
+    std::vector<Best> best;
+    best.reserve(k + 1);
+    auto consider = [&](float dot, uint32_t id) {
+        if (best.size() == k && dot <= best.front().dot)
+            return;
+        best.push_back({ dot, id });
+        std::push_heap(best.begin(), best.end());
+        if (best.size() > k) {
+            std::pop_heap(best.begin(), best.end());
+            best.pop_back();
+        }
+    };
+    for (uint32_t id : m_pending)
+        consider(glm::dot(q, m_points[id]), id);
+
+    std::vector<Node> nodes;
+    std::vector<Candidate> frontier;
+    for (const Run* run : { &m_main, &m_recent }) {
+        auto push = [&](const Node& node) {
+            glm::vec3 center;
+            float radius;
+            nodeCap(node, center, radius);
+            float bound = std::cos(std::max(0.0f, angleBetween(q, center) - radius));
+            if (best.size() == k && bound <= best.front().dot)
+                return;
+            nodes.push_back(node);
+            frontier.push_back({ bound, (uint32_t)nodes.size() - 1 });
+            std::push_heap(frontier.begin(), frontier.end());
+        };
+
+        nodes.clear();
+        frontier.clear();
+        Node split[6];
+        int count = faces(*run, split);
+        for (int c = 0; c < count; ++c)
+            push(split[c]);
+        while (!frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end());
+            Candidate candidate = frontier.back();
+            frontier.pop_back();
+            if (best.size() == k && candidate.bound <= best.front().dot)
+                break;
+            Node node = nodes[candidate.node];
+            if (node.end - node.begin <= kLeafSize || node.level == kLevels) {
+                for (uint32_t i = node.begin; i < node.end; ++i)
+                    consider(glm::dot(q, run->points[i]), run->ids[i]);
+                continue;
+            }
+            count = children(*run, node, split);
+            for (int c = 0; c < count; ++c)
+                push(split[c]);
+        }
+    }
+
+    std::sort_heap(best.begin(), best.end());
+    out.reserve(best.size());
+    for (const Best& entry : best)
+        out.push_back({ entry.id, angleBetween(q, m_points[entry.id]) });
+}
+
+void SphereIndex::withinCap(const glm::vec3& direction, float angle, std::vector<uint32_t>& out) const
+{
+    out.clear();
+    glm::vec3 q = unitDirection(direction);
+    float minDot = std::cos(angle);
+    for (uint32_t id : m_pending) {
+        if (glm::dot(q, m_points[id]) >= minDot)
+            out.push_back(id);
+    }
+
+    std::vector<Node> stack;
+    for (const Run* run : { &m_main, &m_recent }) {
+        Node split[6];
+        int count = faces(*run, split);
+        stack.assign(split, split + count);
+        while (!stack.empty()) {
+            Node node = stack.back();
+            stack.pop_back();
+            glm::vec3 center;
+            float radius;
+            nodeCap(node, center, radius);
+            float distance = angleBetween(q, center);
+            if (distance - radius - kCapMargin > angle)
+                continue;
+            if (distance + radius + kCapMargin <= angle) {
+                out.insert(out.end(), run->ids.begin() + node.begin, run->ids.begin() + node.end);
+                continue;
+            }
+            if (node.end - node.begin <= kLeafSize || node.level == kLevels) {
+                for (uint32_t i = node.begin; i < node.end; ++i) {
+                    if (glm::dot(q, run->points[i]) >= minDot)
+                        out.push_back(run->ids[i]);
+                }
+                continue;
+            }
+            count = children(*run, node, split);
+            stack.insert(stack.end(), split, split + count);
+        }
+    }
+}
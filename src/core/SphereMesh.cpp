@@ -0,0 +1,145 @@
+#include "SphereMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include "Parallel.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+// Vertices per worker
+const size_t kMinVerticesPerWorker = 1 << 16;
+
+}
+
+void generateUvSphere(float radius, unsigned int rings, unsigned int sectors, MeshData& mesh)
+{
+    size_t columns = sectors + 1;
+    mesh.positions.resize((rings + 1) * columns);
+    mesh.indices.resize((size_t)rings * sectors * 6);
+
+    // One sin/cos per sector, shared by every ring
+    std::vector<float> sectorCos(columns), sectorSin(columns);
+    for (unsigned int s = 0; s <= sectors; ++s) {
+        double phi = s * 2 * M_PI / sectors;
+        sectorCos[s] = (float)std::cos(phi);
+        sectorSin[s] = (float)std::sin(phi);
+    }
+
+    glm::vec3* positions = mesh.positions.data();
+    unsigned int* indices = mesh.indices.data();
+    size_t minRings = std::max<size_t>(1, kMinVerticesPerWorker / columns);
+    parallelFor(rings + 1, minRings, [&](size_t begin, size_t end, unsigned int) {
+        for (size_t r = begin; r < end; ++r) {
+            double theta = r * M_PI / rings;
+            float ringRadius = radius * (float)std::sin(theta);
+            float y = radius * (float)std::cos(theta);
+            glm::vec3* row = positions + r * columns;
+            for (size_t s = 0; s < columns; ++s)
+                row[s] = glm::vec3(ringRadius * sectorCos[s], y, ringRadius * sectorSin[s]);
+
+            // The band of triangles below this ring
+            if (r == rings)
+                continue;
+            unsigned int* out = indices + r * sectors * 6;
+            unsigned int top = (unsigned int)(r * columns);
+            unsigned int bottom = top + (unsigned int)columns;
+            for (unsigned int s = 0; s < sectors; ++s) {
+                out[0] = top + s;
+                out[1] = bottom + s;
+                out[2] = top + s + 1;
+                out[3] = top + s + 1;
+                out[4] = bottom + s;
+                out[5] = bottom + s + 1;
+                out += 6;
+            }
+        }
+    });
+}
+
+void generateEdgeIndices(const std::vector<unsigned int>& indices, std::vector<unsigned int>& lines)
+{
+    // Every edge as (low, high), sorted so shared edges sit next to each other
+    std::vector<uint64_t> edges(indices.size());
+    for (size_t f = 0; f + 2 < indices.size(); f += 3) {
+        for (unsigned int e = 0; e < 3; ++e) {
+            uint64_t a = indices[f + e], b = indices[f + (e + 1) % 3];
+            edges[f + e] = a < b ? a << 32 | b : b << 32 | a;
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    lines.resize(edges.size() * 2);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        lines[2 * i] = (unsigned int)(edges[i] >> 32);
+        lines[2 * i + 1] = (unsigned int)edges[i];
+    }
+}
+
+size_t icosphereVertexCount(unsigned int subdivisions)
+{
+    return 10 * ((size_t)1 << (2 * subdivisions)) + 2;
+}
+
+size_t icosphereTriangleCount(unsigned int subdivisions)
+{
+    return 20 * ((size_t)1 << (2 * subdivisions));
+}
+
+void generateIcosphere(float radius, unsigned int subdivisions, MeshData& mesh)
+{
+    const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+    const glm::vec3 corners[12] = {
+        { -1, t, 0 }, { 1, t, 0 }, { -1, -t, 0 }, { 1, -t, 0 },
+        { 0, -1, t }, { 0, 1, t }, { 0, -1, -t }, { 0, 1, -t },
+        { t, 0, -1 }, { t, 0, 1 }, { -t, 0, -1 }, { -t, 0, 1 }
+    };
+    const unsigned int faces[60] = {
+        0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+        1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+        3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+        4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1
+    };
+
+    // Work on the unit sphere and scale at the end
+    mesh.positions.clear();
+    mesh.positions.reserve(icosphereVertexCount(subdivisions));
+    for (const glm::vec3& corner : corners)
+        mesh.positions.push_back(glm::normalize(corner));
+    mesh.indices.assign(faces, faces + 60);
+    mesh.indices.reserve(3 * icosphereTriangleCount(subdivisions));
+
+    std::vector<unsigned int> next;
+    std::unordered_map<uint64_t, unsigned int> midpoints;
+    for (unsigned int level = 0; level < subdivisions; ++level) {
+        // Each edge is shared by two faces; its midpoint is made once
+        midpoints.clear();
+        midpoints.reserve(mesh.indices.size() / 2);
+        auto midpoint = [&](unsigned int a, unsigned int b) {
+            uint64_t key = a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+            auto inserted = midpoints.emplace(key, (unsigned int)mesh.positions.size());
+            if (inserted.second)
+                mesh.positions.push_back(glm::normalize(mesh.positions[a] + mesh.positions[b]));
+            return inserted.first->second;
+        };
+
+        next.resize(mesh.indices.size() * 4);
+        unsigned int* out = next.data();
+        for (size_t f = 0; f < mesh.indices.size(); f += 3) {
+            unsigned int a = mesh.indices[f], b = mesh.indices[f + 1], c = mesh.indices[f + 2];
+            unsigned int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+            const unsigned int split[12] = { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca };
+            std::copy(split, split + 12, out);
+            out += 12;
+        }
+        mesh.indices.swap(next);
+    }
+
+    for (glm::vec3& position : mesh.positions)
+        position *= radius;
+}
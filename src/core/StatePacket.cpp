@@ -0,0 +1,54 @@
+#include "StatePacket.h"
+#include "Endian.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const unsigned char kPacketMagic[4] = { 'B', 'S', 'P', 'K' };
+
+}
+
+size_t encodeStatePacket(uint32_t sequence, const StateSample* samples, size_t count, unsigned char* out)
+{
+    count = std::min(count, kMaxSamplesPerPacket);
+    std::memcpy(out, kPacketMagic, sizeof(kPacketMagic));
+    storeLE(out + 4, sequence);
+    storeLE(out + 8, static_cast<uint32_t>(count));
+
+    unsigned char* record = out + kStatePacketHeaderSize;
+    for (size_t i = 0; i < count; ++i) {
+        const StateSample& sample = samples[i];
+        storeLE(record, sample.timestamp);
+        storeLE(record + 8, sample.kind);
+        for (int v = 0; v < 4; ++v)
+            storeLE(record + 12 + v * 4, sample.values[v]);
+        storeLE(record + 28, uint32_t(0));
+        record += kStatePacketSampleSize;
+    }
+    return kStatePacketHeaderSize + count * kStatePacketSampleSize;
+}
+
+bool decodeStatePacket(const unsigned char* data, size_t size, uint32_t& sequence, StateSample* out, size_t& count)
+{
+    if (size < kStatePacketHeaderSize || std::memcmp(data, kPacketMagic, sizeof(kPacketMagic)) != 0)
+        return false;
+    sequence = loadLE32(data + 4);
+    count = loadLE32(data + 8) & 0xFFFF;
+    if (count > kMaxSamplesPerPacket || size != kStatePacketHeaderSize + count * kStatePacketSampleSize)
+        return false;
+
+    const unsigned char* record = data + kStatePacketHeaderSize;
+    for (size_t i = 0; i < count; ++i) {
+        StateSample& sample = out[i];
+        sample.timestamp = loadLEDouble(record);
+        sample.kind = loadLE32(record + 8);
+        for (int v = 0; v < 4; ++v)
+            sample.values[v] = loadLEFloat(record + 12 + v * 4);
+        sample.reserved = 0;
+        if (sample.kind != StateSample::Bloch && sample.kind != StateSample::Amplitudes)
+            return false;
+        record += kStatePacketSampleSize;
+    }
+    return true;
+}
@@ -0,0 +1,316 @@
+#include "TrajectoryFile.h"
+#include "Endian.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const unsigned char kHeaderMagic[4] = { 'B', 'T', 'R', 'J' };
+const unsigned char kTrailerMagic[8] = { 'B', 'T', 'R', 'J', 'E', 'N', 'D', '\0' };
+const uint32_t kVersion = 1;
+const size_t kHeaderSize = 16;
+const size_t kIndexEntrySize = 32;
+const size_t kTrailerSize = 32;
+
+uint64_t chunkBytes(uint64_t count)
+{
+    uint64_t bytes = count * (sizeof(double) + 3 * sizeof(float));
+    return (bytes + 7) & ~static_cast<uint64_t>(7);
+}
+
+}
+
+TrajectoryWriter::TrajectoryWriter(unsigned int chunkCapacity) : m_chunkCapacity(std::max(1u, chunkCapacity))
+{
+    m_times.reserve(m_chunkCapacity);
+    m_blochs.reserve(m_chunkCapacity);
+}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    if (m_file)
+        close();
+}
+
+bool TrajectoryWriter::open(const char* path)
+{
+    FILE* file = std::fopen(path, "wb");
+    if (!file)
+        return false;
+    if (!open(file)) {
+        std::fclose(file);
+        return false;
+    }
+    m_ownsFile = true;
+    return true;
+}
+
+bool TrajectoryWriter::open(FILE* file)
+{
+    m_file = file;
+    m_ownsFile = false;
+    m_failed = false;
+    m_offset = 0;
+    m_samples = 0;
+    m_times.clear();
+    m_blochs.clear();
+    m_index.clear();
+
+    unsigned char header[kHeaderSize] = {};
+    std::memcpy(header, kHeaderMagic, sizeof(kHeaderMagic));
+    storeLE(header + 4, kVersion);
+    storeLE(header + 8, static_cast<uint32_t>(m_chunkCapacity));
+    return writeBytes(header, sizeof(header));
+}
+
+bool TrajectoryWriter::append(double time, const glm::vec3& bloch)
+{
+    double previous = !m_times.empty() ? m_times.back() : !m_index.empty() ? m_index.back().lastTime : time;
+    if (!m_file || m_failed || time < previous)
+        return false;
+
+    m_times.push_back(time);
+    m_blochs.push_back(bloch);
+    ++m_samples;
+    if (m_times.size() == m_chunkCapacity)
+        return flushChunk();
+    return true;
+}
+
+bool TrajectoryWriter::flushChunk()
+{
+    size_t count = m_times.size();
+    if (count == 0)
+        return !m_failed;
+
+    m_encoded.assign(static_cast<size_t>(chunkBytes(count)), 0);
+    unsigned char* times = m_encoded.data();
+    unsigned char* xs = times + count * sizeof(double);
+    unsigned char* ys = xs + count * sizeof(float);
+    unsigned char* zs = ys + count * sizeof(float);
+    for (size_t i = 0; i < count; ++i) {
+        storeLE(times + i * sizeof(double), m_times[i]);
+        storeLE(xs + i * sizeof(float), m_blochs[i].x);
+        storeLE(ys + i * sizeof(float), m_blochs[i].y);
+        storeLE(zs + i * sizeof(float), m_blochs[i].z);
+    }
+
+    m_index.push_back({ m_times.front(), m_times.back(), m_offset, static_cast<uint32_t>(count) });
+    m_times.clear();
+    m_blochs.clear();
+    return writeBytes(m_encoded.data(), m_encoded.size());
+}
+
+bool TrajectoryWriter::close()
+{
+    if (!m_file)
+        return false;
+
+    flushChunk();
+
+    uint64_t indexOffset = m_offset;
+    m_encoded.assign(m_index.size() * kIndexEntrySize + kTrailerSize, 0);
+    unsigned char* out = m_encoded.data();
+    for (const ChunkEntry& entry : m_index) {
+        storeLE(out, entry.firstTime);
+        storeLE(out + 8, entry.lastTime);
+        storeLE(out + 16, entry.offset);
+        storeLE(out + 24, entry.count);
+        out += kIndexEntrySize;
+    }
+    storeLE(out, indexOffset);
+    storeLE(out + 8, static_cast<uint64_t>(m_index.size()));
+    storeLE(out + 16, m_samples);
+    std::memcpy(out + 24, kTrailerMagic, sizeof(kTrailerMagic));
+    writeBytes(m_encoded.data(), m_encoded.size());
+
+    bool ok = !m_failed && std::fflush(m_file) == 0;
+    if (m_ownsFile)
+        ok = std::fclose(m_file) == 0 && ok;
+    m_file = nullptr;
+    return ok;
+}
+
+bool TrajectoryWriter::writeBytes(const void* data, size_t size)
+{
+    if (!m_failed && std::fwrite(data, 1, size, m_file) != size)
+        m_failed = true;
+    m_offset += size;
+    return !m_failed;
+}
+
+bool TrajectoryReader::open(const char* path, std::string& error)
+{
+    close();
+    if (!m_file.open(path, error))
+        return false;
+
+    const unsigned char* data = m_file.data();
+    size_t size = m_file.size();
+    if (size < kHeaderSize + kTrailerSize || std::memcmp(data, kHeaderMagic, sizeof(kHeaderMagic)) != 0) {
+        error = "not a trajectory file";
+        close();
+        return false;
+    }
+    if (loadLE32(data + 4) != kVersion) {
+        error = "unsupported trajectory version";
+        close();
+        return false;
+    }
+
+    const unsigned char* trailer = data + size - kTrailerSize;
+    uint64_t indexOffset = loadLE64(trailer);
+    uint64_t chunkCount = loadLE64(trailer + 8);
+    uint64_t sampleCount = loadLE64(trailer + 16);
+    if (std::memcmp(trailer + 24, kTrailerMagic, sizeof(kTrailerMagic)) != 0
+        || indexOffset < kHeaderSize || indexOffset > size - kTrailerSize
+        || chunkCount > (size - kTrailerSize - indexOffset) / kIndexEntrySize
+        || indexOffset + chunkCount * kIndexEntrySize + kTrailerSize != size) {
+        error = "trajectory index is missing or truncated";
+        close();
+        return false;
+    }
+
+    m_chunks.reserve(static_cast<size_t>(chunkCount));
+    uint64_t firstSample = 0;
+    for (uint64_t i = 0; i < chunkCount; ++i) {
+        const unsigned char* entry = data + indexOffset + i * kIndexEntrySize;
+        uint64_t offset = loadLE64(entry + 16);
+        uint32_t count = loadLE32(entry + 24);
+        if (count == 0 || offset < kHeaderSize || offset > indexOffset || chunkBytes(count) > indexOffset - offset) {
+            error = "corrupt trajectory index";
+            close();
+            return false;
+        }
+        // seek() searches the chunks by time, so they must be in order (and
+        // the negated comparisons turn away NaN times too)
+        double firstTime = loadLEDouble(entry), lastTime = loadLEDouble(entry + 8);
+        if (!(firstTime <= lastTime) || (!m_chunks.empty() && !(m_chunks.back().lastTime <= firstTime))) {
+            error = "trajectory chunks are out of time order";
+            close();
+            return false;
+        }
+        m_chunks.push_back({ firstTime, lastTime, data + offset, count, firstSample });
+        firstSample += count;
+    }
+    if (firstSample != sampleCount) {
+        error = "trajectory sample count does not match its index";
+        close();
+        return false;
+    }
+    m_samples = sampleCount;
+    return true;
+}
+
+void TrajectoryReader::close()
+{
+    m_file.close();
+    m_chunks.clear();
+    m_samples = 0;
+}
+
+double TrajectoryReader::startTime() const
+{
+    return m_chunks.empty() ? 0.0 : m_chunks.front().firstTime;
+}
+
+double TrajectoryReader::endTime() const
+{
+    return m_chunks.empty() ? 0.0 : m_chunks.back().lastTime;
+}
+
+uint64_t TrajectoryReader::seek(double time) const
+{
+    auto chunk = std::partition_point(m_chunks.begin(), m_chunks.end(),
+        [time](const Chunk& c) { return c.lastTime < time; });
+    if (chunk == m_chunks.end())
+        return m_samples;
+
+    uint32_t low = 0;
+    uint32_t high = chunk->count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (loadLEDouble(chunk->data + mid * sizeof(double)) < time)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return chunk->firstSample + low;
+}
+
+const TrajectoryReader::Chunk& TrajectoryReader::chunkFor(uint64_t index) const
+{
+    auto chunk = std::partition_point(m_chunks.begin(), m_chunks.end(),
+        [index](const Chunk& c) { return c.firstSample + c.count <= index; });
+    return *chunk;
+}
+
+double TrajectoryReader::timeAt(uint64_t index) const
+{
+    const Chunk& chunk = chunkFor(index);
+    return loadLEDouble(chunk.data + (index - chunk.firstSample) * sizeof(double));
+}
+
+glm::vec3 TrajectoryReader::blochAt(uint64_t index) const
+{
+    const Chunk& chunk = chunkFor(index);
+    uint64_t i = index - chunk.firstSample;
+    const unsigned char* xs = chunk.data + chunk.count * sizeof(double);
+    const unsigned char* ys = xs + chunk.count * sizeof(float);
+    const unsigned char* zs = ys + chunk.count * sizeof(float);
+    return glm::vec3(loadLEFloat(xs + i * sizeof(float)), loadLEFloat(ys + i * sizeof(float)), loadLEFloat(zs + i * sizeof(float)));
+}
+
+void TrajectoryReader::readSamples(uint64_t first, size_t count, glm::vec3* blochs, double* times) const
+{
+    if (count == 0)
+        return;
+    size_t chunk = &chunkFor(first) - m_chunks.data();
+    uint64_t index = first, end = first + count;
+    while (index < end) {
+        const Chunk& c = m_chunks[chunk++];
+        uint64_t begin = index - c.firstSample;
+        uint64_t n = std::min<uint64_t>(c.count - begin, end - index);
+        const unsigned char* xs = c.data + c.count * sizeof(double);
+        const unsigned char* ys = xs + c.count * sizeof(float);
+        const unsigned char* zs = ys + c.count * sizeof(float);
+        for (uint64_t i = begin; i < begin + n; ++i) {
+            *blochs++ = glm::vec3(loadLEFloat(xs + i * sizeof(float)), loadLEFloat(ys + i * sizeof(float)), loadLEFloat(zs + i * sizeof(float)));
+            if (times)
+                *times++ = loadLEDouble(c.data + i * sizeof(double));
+        }
+        index += n;
+    }
+}
+
+void TrajectoryReader::readWindow(double from, double to, size_t maxSamples, std::vector<glm::vec3>& out) const
+{
+    out.clear();
+    if (m_samples == 0 || maxSamples == 0 || to < from)
+        return;
+
+    uint64_t first = seek(from);
+    // First sample strictly after `to`
+    uint64_t last = seek(std::nextafter(to, std::numeric_limits<double>::infinity()));
+    if (first >= last)
+        return;
+
+    uint64_t count = last - first;
+    uint64_t stride = (count + maxSamples - 1) / maxSamples;
+    out.reserve(static_cast<size_t>((count + stride - 1) / stride));
+
+    // Walk the chunks alongside the samples instead of searching for each one
+    size_t chunk = &chunkFor(first) - m_chunks.data();
+    for (uint64_t index = first; index < last; index += stride) {
+        while (index >= m_chunks[chunk].firstSample + m_chunks[chunk].count)
+            ++chunk;
+        const Chunk& c = m_chunks[chunk];
+        uint64_t i = index - c.firstSample;
+        const unsigned char* xs = c.data + c.count * sizeof(double);
+        const unsigned char* ys = xs + c.count * sizeof(float);
+        const unsigned char* zs = ys + c.count * sizeof(float);
+        out.emplace_back(loadLEFloat(xs + i * sizeof(float)), loadLEFloat(ys + i * sizeof(float)), loadLEFloat(zs + i * sizeof(float)));
+    }
+}
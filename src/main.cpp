@@ -1,8 +1,12 @@
-#define M_PI 3.14159265358979323846
-
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <numeric>
+#include <thread>
 #define NOMINMAX           // Exclude <windows.h> min/max macros
 #define WIN32_LEAN_AND_MEAN // Exclude rarely-used services from Windows headers
 #include <windows.h> // Required for AllocConsole and freopen
@@ -13,22 +17,64 @@
 
 #include "Shader.h"
 #include "Sphere.h"
+#include "SphereLod.h"
 #include "Axes.h"
 #include "Camera.h"
 #include "StateVector.h"
+#include "ParameterSweep.h"
+#include "SweepRenderer.h"
+#include "TrajectoryFile.h"
+#include "SharedStateRing.h"
+#include "IngestServer.h"
+#include "BlochMath.h"
+#include "Gates.h"
+#include "GateSynthesis.h"
+#include "Profiler.h"
+#include "QuasiProbabilityMap.h"
+#include "RenderQueue.h"
+#include "SessionLog.h"
+#include "SceneLabels.h"
+#include "DensityMap.h"
+#include "DrawStats.h"
+#include "FrameArena.h"
+#include "FrameBenchmark.h"
+#include "FrustumCulling.h"
+#include "MajoranaConstellation.h"
+#include "MajoranaStars.h"
+#include "Picking.h"
+#include "PulseEngine.h"
+#include "RandomizedBenchmarking.h"
+#include "GeometryCache.h"
+#include "GpuResources.h"
+#include "SimulationThread.h"
+#include "SphereIndex.h"
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void char_callback(GLFWwindow* window, unsigned int codepoint);
+void cursor_enter_callback(GLFWwindow* window, int entered);
+void window_focus_callback(GLFWwindow* window, int focused);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void resize_viewport(int width, int height);
 void processInput(GLFWwindow *window);
 void glfw_error_callback(int error, const char* description);
 void GLAPIENTRY glDebugOutput(GLenum source, GLenum type, unsigned int id, GLenum severity, GLsizei length, const char *message, const void *userParam);
 
-// Helper function to convert Cartesian to Spherical coordinates
-void cartesianToSpherical(glm::vec3 cartesian, float& theta, float& phi);
+// Points theta/phi along a Bloch vector given in physics coordinates
+void setStateFromBloch(const glm::vec3& bloch);
+
+// Records a live window event if a session is being recorded and handles it,
+// unless a replay is driving the window instead
+void windowEvent(GLFWwindow* window, const SessionEvent& event);
+// Feeds a window event to ImGui and the application
+void dispatchEvent(GLFWwindow* window, const SessionEvent& event);
 
 // Settings
 unsigned int SCR_WIDTH = 800;
@@ -41,17 +87,267 @@ float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
 float mouseSensitivity = 0.25f;
 
+// Input state tracked from events rather than polled, so replays see the same
+bool keysDown[GLFW_KEY_LAST + 1] = {};
+bool leftMouseDown = false;
+bool rightMouseDown = false;  // held over the scene, the state follows the cursor
+
 // Bloch Sphere State
 float theta = 0.0f; // Polar angle (0 to PI)
 float phi = 0.0f;   // Azimuthal angle (0 to 2*PI)
 float line_thickness = 1.0f;
 
-int main()
+// Parameter sweep
+SweepSettings sweepSettings;
+int sweepCellSize = 64;
+
+// Trajectory playback
+TrajectoryReader trajectory;
+char trajectoryPath[260] = "trajectory.btraj";
+std::string trajectoryStatus;
+double trajectoryTime = 0.0;
+float trajectoryWindow = 1000.0f;
+std::vector<glm::vec3> trajectorySamples;
+const size_t maxTrailSamples = 20000;
+
+// Live state feed from another process, over shared memory or datagrams
+SharedStateRing stateFeed;
+IngestServer ingestServer;
+int ingestTransport = 0;
+char ingestAddress[108] = "47000";
+std::string ingestStatus;
+char stateFeedName[64] = "bloch_feed";
+std::string stateFeedStatus;
+uint64_t feedReceived = 0;
+double feedLatencyMs = 0.0;
+double feedRate = 0.0;
+
+// Simulation thread; the render loop only picks up its latest snapshot
+bool simEvolve = false;
+BlochEquationParams simParams;
+int simSubsteps = 10;
+float simTickHz = 1000.0f;
+bool simPaused = false;
+float simTimeScale = 1.0f;
+float simFixedStepMs = 1.0f;
+float simFastForward = 1.0f;
+// The angles last sent to or taken from the simulation, to spot UI edits
+float simTheta = 0.0f;
+float simPhi = 0.0f;
+uint64_t simStateVersion = 0;
+// Whether the shown state follows the simulation; cleared by UI edits
+bool simFollowing = false;
+uint64_t simTrailVersion = 0;
+std::vector<glm::vec3> simTrail;
+
+// Render queue; the grid repeats the sphere to show what sorting saves
+int sceneGrid = 1;
+bool queueSorting = true;
+int sphereMesh = 0;
+const char* kSphereMeshes[] = { "UV 8x8", "UV 32x32", "Icosphere 1", "Icosphere 3", "Icosphere 5" };
+const float kGridSpacing = 3.5f;
+const float kFovY = glm::radians(45.0f);
+
+// Level of detail for the grid: each sphere's icosphere level follows its size
+// on screen, within a triangle budget per frame
+bool sphereLodEnabled = false;
+int lodTriangleBudget = 250000;
+uint64_t lodTriangles = 0;
+std::vector<glm::vec3> gridCenters;
+std::vector<unsigned int> gridLevels;  // kept between frames for hysteresis
+
+// Culling: grid cells outside the view are not submitted, and optionally
+// neither are vectors pointing away behind their sphere
+bool frustumCulling = true;
+bool hideOccludedArrows = false;
+const float kGridBoundRadius = 1.5f;  // the axes reach past the sphere
+BoundingSpheres gridBounds;
+SphereBvh gridPicking;  // the unit spheres, for clicking a state
+int gridLayoutSize = 0;  // sceneGrid the centers, bounds and picking were built for
+std::vector<uint32_t> gridVisible;
+
+// Density heatmap: live feed samples and trajectories counted in equal-area
+// HEALPix bins and shaded on the central sphere
+bool densityEnabled = false;
+bool densityBinFeed = true;
+int densityResolution = 2;
+const unsigned int kDensityNsides[] = { 16, 32, 64, 128 };
+const char* kDensityResolutions[] = { "3072 bins", "12288 bins", "49152 bins", "196608 bins" };
+SphereHistogram densityHistogram(64);
+std::vector<glm::vec3> densityPending;
+// Trajectories are binned this many samples at a time (12 MB)
+const uint64_t kDensityBlock = 1 << 20;
+std::vector<glm::vec3> densityBlock;
+double densityBinMs = 0.0;
+unsigned int densityRowsUploaded = 0;
+
+// Husimi Q or Wigner function of the shown state, as a spin-j state of 2j
+// copies of the qubit, shaded on the central sphere instead of the density
+bool quasiEnabled = false;
+int quasiKind = 0;
+const char* kQuasiKinds[] = { "Husimi Q", "Wigner" };
+int quasiTwoJ = 1;
+float quasiLength = 1.0f;  // Bloch vector length, below 1 for mixed states
+int quasiRowsPerFrame = 128;
+unsigned int quasiRowsComputed = 0;
+QuasiProbabilityGrid quasiGrid(256, 128);
+glm::vec4 quasiInputs(0.0f);  // kind/2j and Bloch vector of the current series
+
+// Majorana stars of the spin-j coherent state along the shown qubit, spread
+// by one-axis twisting; the solver starts each frame from the last roots
+bool majoranaEnabled = false;
+int majoranaTwoJ = 20;
+float majoranaTwist = 0.3f;
+bool majoranaAnimate = false;  // twist swings between 0 and the slider value
+MajoranaSolver majoranaSolver;
+SpinAmplitudes majoranaState;
+std::vector<glm::vec3> majoranaStars;
+double majoranaSolveMs = 0.0;
+
+// Sample search: feed samples and trajectories indexed by direction, for the
+// hover tooltip over the central sphere and nearest-state queries. Feed
+// samples are kept in a bounded window: once the index holds
+// kSearchFeedLimit samples, the newest half is rebuilt into a fresh index,
+// so memory, merge sizes and sample ids stay bounded at any feed rate.
+const size_t kSearchFeedLimit = 1 << 20;
+// Largest trajectory indexed, about 1.4 GB of index; ids are 32-bit, so it
+// must also stay below 2^32
+const uint64_t kSearchTrajectoryLimit = 1 << 25;
+bool searchIndexFeed = false;
+SphereIndex searchIndex;
+std::vector<double> searchTimes;  // by sample id
+std::vector<glm::vec3> searchKept;  // scratch for the rebuild
+std::string searchStatus;
+int searchNearestCount = 5;
+float searchCapDegrees = 5.0f;
+float searchHoverDegrees = 2.0f;
+double searchBuildMs = 0.0;
+std::vector<SphereIndex::Neighbor> searchNeighbors;
+std::vector<uint32_t> searchCap;
+
+// Clifford+T synthesis of the rotation taking |0> to the shown state, or of a
+// chosen rotation, from a net built here or loaded from a clifford-t-net table
+CliffordTNet synthesisNet;
+char synthesisPath[256] = "clifford_t.ctnet";
+int synthesisMaxLength = 20;
+int synthesisTarget = 0;
+const char* kSynthesisTargets[] = { "Shown State", "Rotation" };
+float synthesisAxisTheta = 90.0f, synthesisAxisPhi = 0.0f, synthesisAngle = 45.0f;  // degrees
+int synthesisDepth = 1;
+SynthesisResult synthesisResult;
+glm::dquat synthesisGoal(1.0, 0.0, 0.0, 0.0);
+glm::vec4 synthesisInputs(-1.0f);  // target angles and depth of the current result
+size_t synthesisNetSize = 0;       // net size of the current result
+double synthesisMs = 0.0;
+std::string synthesisStatus = "No net";
+
+// Randomized benchmarking; with Animate on, the vector shows the final state
+// averaged over sequences, moving through the lengths in turn
+RbSettings rbSettings;
+RandomizedBenchmark rbBenchmark;
+std::vector<float> rbCurve;  // survival by length, for the plot
+bool rbAnimate = false;
+float rbSecondsPerLength = 0.5f;
+glm::vec3 rbBloch(0.0f, 0.0f, 1.0f);
+float rbLength = 0.0f;
+float rbSurvival = 1.0f;
+
+// Shaped pulses: Play moves the vector along the pulse from the cached
+// propagators over a few seconds, Apply jumps to the end
+PulseSettings pulseSettings;
+PulseEngine pulseEngine;
+int pulseRepeats = 1;
+float pulsePlaySeconds = 2.0f;
+bool pulsePlaying = false;
+double pulsePlayStart = 0.0;
+glm::vec3 pulseStart(0.0f, 0.0f, 1.0f);
+std::vector<glm::vec3> pulseTrail;  // scene coordinates
+size_t pulseTrailStride = 1;
+const size_t kMaxPulseTrail = 4000;
+
+// GPU resources panel; churning rebuilds spheres every frame to show that
+// dynamic scenes recycle GL objects instead of growing
+bool gpuChurn = false;
+std::vector<Sphere> churnSpheres;
+
+// Session record and replay
+SessionWriter sessionRecorder;
+SessionReader sessionReplay;
+std::vector<SessionEvent> replayEvents;
+
+void printUsage()
+{
+    std::cout << "usage: mygame [--record FILE | --replay FILE [--fast] [--headless] [--trace FILE]]\n"
+                 "       mygame --benchmark [--frames N] [--warmup N] [--scene NAME] [--baseline FILE]\n"
+                 "              [--save-baseline FILE] [--tolerance PCT] [--draw-tolerance PCT]\n"
+                 "              [--no-alloc]\n"
+                 "  --record FILE   record window events and injected states to FILE\n"
+                 "  --replay FILE   replay a recorded session at wall-clock speed\n"
+                 "  --fast          replay as fast as possible, without vsync\n"
+                 "  --headless      replay in a hidden window and exit at the end\n"
+                 "  --trace FILE    export the replay's profile as a Chrome trace at the end\n"
+                 "  --benchmark     render the canned scenes in a hidden window and report frame times\n"
+                 "  --baseline FILE fail if slower than FILE by more than the tolerance (default 10%)\n"
+                 "  --no-alloc      fail if a measured frame allocates on the heap\n";
+}
+
+int main(int argc, char** argv)
 {
     AllocConsole();
     freopen("CONOUT$", "w", stdout);
     std::cout << "Program started." << std::endl << std::flush;
 
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    const char* tracePath = nullptr;
+    bool replayFast = false;
+    bool headless = false;
+    bool benchmark = false;
+    FrameBenchmarkOptions benchmarkOptions;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--benchmark") == 0) {
+            benchmark = true;
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            benchmarkOptions.frames = (unsigned int)std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            benchmarkOptions.warmupFrames = (unsigned int)std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            benchmarkOptions.scene = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            benchmarkOptions.baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--save-baseline") == 0 && i + 1 < argc) {
+            benchmarkOptions.savePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            benchmarkOptions.tolerance.timePercent = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--draw-tolerance") == 0 && i + 1 < argc) {
+            benchmarkOptions.tolerance.drawPercent = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-alloc") == 0) {
+            benchmarkOptions.requireNoAllocations = true;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--fast") == 0) {
+            replayFast = true;
+        } else if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if ((recordPath && replayPath) || ((replayFast || headless || tracePath) && !replayPath) || (benchmark && (recordPath || replayPath))) {
+        printUsage();
+        return 2;
+    }
+    std::string sessionError;
+    if (replayPath && !sessionReplay.open(replayPath, sessionError)) {
+        std::cout << sessionError << std::endl;
+        return 1;
+    }
+
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -60,6 +356,8 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (headless || benchmark)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
@@ -77,7 +375,15 @@ int main()
     std::cout << "GLFW window created." << std::endl;
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetCursorPosCallback(window, cursor_pos_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetCharCallback(window, char_callback);
+    glfwSetCursorEnterCallback(window, cursor_enter_callback);
+    glfwSetWindowFocusCallback(window, window_focus_callback);
+    if (replayFast)
+        glfwSwapInterval(0);
 
     // glad: load all OpenGL function pointers
     // ---------------------------------------
@@ -100,208 +406,976 @@ int main()
     glDebugMessageCallback(glDebugOutput, nullptr);
     glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
 
-    // build and compile our shader programs
-    // -------------------------------------
-    Shader sphereShader("C:/Users/ASD/Desktop/Bloch Sphere/Bloch-Sphere/resources/vertex.vert", "C:/Users/ASD/Desktop/Bloch Sphere/Bloch-Sphere/resources/fragment.frag");
-    Shader axesShader("C:/Users/ASD/Desktop/Bloch Sphere/Bloch-Sphere/resources/axes.vert", "C:/Users/ASD/Desktop/Bloch Sphere/Bloch-Sphere/resources/axes.frag");
-    Shader stateVectorShader("C:/Users/ASD/Desktop/Bloch Sphere/Bloch-Sphere/resources/state_vector.vert", "C:/Users/ASD/Desktop/Bloch Sphere/Bloch-Sphere/resources/state_vector.frag");
-    std::cout << "Shaders compiled." << std::endl;
-
-    // create the objects
-    // ------------------
-    Sphere sphere(1.0f, 8, 8);
-    Axes axes(1.5f);
-    StateVector stateVector;
-    std::cout << "Objects created." << std::endl;
-
-    // Setup Dear ImGui context
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO(); (void)io;
-    std::cout << "ImGui context created." << std::endl;
-    //io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
-    //io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
-
-    // Setup Dear ImGui style
-    ImGui::StyleColorsDark();
-    //ImGui::StyleColorsClassic();
-
-    // Setup Platform/Renderer backends
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 330");
-    std::cout << "ImGui backends initialized." << std::endl << std::flush;
-
-    // render loop
-    // -----------
-    while (!glfwWindowShouldClose(window))
+    int exitCode = 0;
+    // Everything that owns GL objects lives in this scope, so it is destroyed
+    // and its pooled buffers and vertex arrays are back in gpuPool() before
+    // the pool is drained and the context goes away
     {
-        // input
-        // -----
-        processInput(window);
-
-        // render
-        // ------
-        glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // create transformations
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 view = camera.GetViewMatrix();
-        glm::mat4 model = glm::mat4(1.0f);
-
-        glm::mat4 pvMatrix = projection * view;
-
-        // render the sphere
-        sphereShader.use();
-        sphereShader.setMat4("projection", projection);
-        sphereShader.setMat4("view", view);
-        sphereShader.setMat4("model", model);
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        sphere.draw();
-
-        // render the axes
-        axes.draw(axesShader, view, projection, line_thickness);
-
-        // render the state vector
-        stateVector.update(theta, phi);
-        stateVector.draw(stateVectorShader, view, projection);
-
-        // ImGui
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        // Calculate Dirac notation
-        float alpha_real = cos(glm::radians(theta) / 2.0f);
-        float beta_real = sin(glm::radians(theta) / 2.0f) * cos(glm::radians(phi));
-        float beta_imag = sin(glm::radians(theta) / 2.0f) * sin(glm::radians(phi));
-
-        // ImGui State Display
-        ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x * 0.5f, 0), ImGuiCond_Always, ImVec2(0.5f, 0));
-        ImGui::Begin("State Display", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoMove);
-        ImGui::Text("|psi> = (%.2f)|0> + (%.2f + %.2fi)|1>", alpha_real, beta_real, beta_imag);
-        ImGui::End();
-
-        ImGui::Begin("Bloch Sphere Controls");
-        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
-
-        if (ImGui::SliderFloat("Theta (deg)", &theta, 0.0f, 180.0f)) {
-            stateVector.hidePrevious();
+        // build and compile our shader programs
+        // -------------------------------------
+        Shader sphereShader(RESOURCES_PATH "vertex.vert", RESOURCES_PATH "fragment.frag");
+        Shader axesShader(RESOURCES_PATH "axes.vert", RESOURCES_PATH "axes.frag");
+        Shader stateVectorShader(RESOURCES_PATH "state_vector.vert", RESOURCES_PATH "state_vector.frag");
+        Shader sweepSphereShader(RESOURCES_PATH "sweep_sphere.vert", RESOURCES_PATH "fragment.frag");
+        Shader sweepVectorShader(RESOURCES_PATH "sweep_vector.vert", RESOURCES_PATH "sweep_vector.frag");
+        Shader densityShader(RESOURCES_PATH "density.vert", RESOURCES_PATH "density.frag");
+        Shader quasiShader(RESOURCES_PATH "density.vert", RESOURCES_PATH "quasi.frag");
+        std::cout << "Shaders compiled." << std::endl;
+
+        // create the objects
+        // ------------------
+        Sphere sphere(1.0f, 8, 8);
+        SphereLod sphereLod(1.0f);
+        Axes axes(1.5f);
+        StateVector stateVector;
+        ParameterSweep sweep;
+        SweepRenderer sweepRenderer;
+        RenderQueue renderQueue;
+        DensityMap densityMap;
+        QuasiProbabilityMap quasiMap;
+        MajoranaConstellation majoranaConstellation;
+        Profiler profiler;
+        std::cout << "Objects created." << std::endl;
+
+        // Setup Dear ImGui context
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO(); (void)io;
+        std::cout << "ImGui context created." << std::endl;
+        //io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
+        //io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
+
+        // Setup Dear ImGui style
+        ImGui::StyleColorsDark();
+        //ImGui::StyleColorsClassic();
+
+        // A saved layout would make sessions depend on the previous run
+        if (recordPath || replayPath)
+            io.IniFilename = nullptr;
+
+        // Setup Platform/Renderer backends. Window events reach ImGui through
+        // dispatchEvent so that they can be recorded and replayed.
+        ImGui_ImplGlfw_InitForOpenGL(window, false);
+        ImGui_ImplOpenGL3_Init("#version 330");
+        std::cout << "ImGui backends initialized." << std::endl << std::flush;
+
+        if (recordPath && !sessionRecorder.open(recordPath, sessionError))
+            std::cout << sessionError << std::endl;
+        double replayStart = steadySeconds();
+        uint64_t replayFrames = 0;
+        double replayFrameTime = 0.0;
+        double replayFrameDt = 0.0;
+
+        // Replays step the simulation inline, once per recorded frame
+        SimulationThread simulation(2000);
+        if (!replayPath)
+            simulation.start(simTickHz);
+
+        if (benchmark) {
+            exitCode = runFrameBenchmark(window, benchmarkOptions);
+            glfwSetWindowShouldClose(window, true);
         }
-        if (ImGui::SliderFloat("Phi (deg)", &phi, 0.0f, 360.0f)) {
-            stateVector.hidePrevious();
-        }
-
-        ImGui::SliderFloat("Mouse Sensitivity", &mouseSensitivity, 0.01f, 1.0f);
 
-        ImGui::Separator();
-        ImGui::Text("Apply Pauli Gates");
-        if (ImGui::Button("Pauli X"))
-        {
-            stateVector.storePreviousState();
-            // Convert current spherical to Cartesian
-            float currentRadTheta = glm::radians(theta);
-            float currentRadPhi = glm::radians(phi);
-            glm::vec3 currentCartesian;
-            currentCartesian.x = sin(currentRadTheta) * cos(currentRadPhi);
-            currentCartesian.y = cos(currentRadTheta);
-            currentCartesian.z = sin(currentRadTheta) * sin(currentRadPhi);
-
-            // Apply Pauli Z transformation (x, y, z) -> (-x, -y, z)
-            glm::vec3 transformedCartesian = glm::vec3(-currentCartesian.x, -currentCartesian.y, currentCartesian.z);
-
-            // Convert back to spherical
-            cartesianToSpherical(transformedCartesian, theta, phi);
-
-            // Convert back to degrees for display
-            theta = glm::degrees(theta);
-            phi = glm::degrees(phi);
-        }
-        if (ImGui::Button("Pauli Y"))
-        {
-            stateVector.storePreviousState();
-            // Convert current spherical to Cartesian
-            float currentRadTheta = glm::radians(theta);
-            float currentRadPhi = glm::radians(phi);
-            glm::vec3 currentCartesian;
-            currentCartesian.x = sin(currentRadTheta) * cos(currentRadPhi);
-            currentCartesian.y = cos(currentRadTheta);
-            currentCartesian.z = sin(currentRadTheta) * sin(currentRadPhi);
-
-            // Apply Pauli X transformation (x, y, z) -> (x, -y, -z)
-            glm::vec3 transformedCartesian = glm::vec3(currentCartesian.x, -currentCartesian.y, -currentCartesian.z);
-
-            // Convert back to spherical
-            cartesianToSpherical(transformedCartesian, theta, phi);
-
-            // Convert back to degrees for display
-            theta = glm::degrees(theta);
-            phi = glm::degrees(phi);
-        }
-        if (ImGui::Button("Pauli Z"))
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
         {
-            stateVector.storePreviousState();
-            // Convert current spherical to Cartesian
-            float currentRadTheta = glm::radians(theta);
-            float currentRadPhi = glm::radians(phi);
-            glm::vec3 currentCartesian;
-            currentCartesian.x = sin(currentRadTheta) * cos(currentRadPhi);
-            currentCartesian.y = cos(currentRadTheta);
-            currentCartesian.z = sin(currentRadTheta) * sin(currentRadPhi);
-
-            // Apply Pauli Y transformation (x, y, z) -> (-x, y, -z)
-            glm::vec3 transformedCartesian = glm::vec3(-currentCartesian.x, currentCartesian.y, -currentCartesian.z);
-
-            // Convert back to spherical
-            cartesianToSpherical(transformedCartesian, theta, phi);
-
-            // Convert back to degrees for display
-            theta = glm::degrees(theta);
-            phi = glm::degrees(phi);
-        }
+            profiler.beginFrame();
+
+            // session clock: replays run on the recorded frame times
+            // ------------------------------------------------------
+            if (sessionReplay.isOpen()) {
+                double frameTime = 0.0;
+                if (sessionReplay.readFrame(frameTime, replayEvents)) {
+                    ++replayFrames;
+                    if (!replayFast) {
+                        double wait = replayStart + frameTime - steadySeconds();
+                        if (wait > 0.0)
+                            std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+                    }
+                    glfwSetTime(frameTime);
+                    replayFrameDt = frameTime - replayFrameTime;
+                    replayFrameTime = frameTime;
+                } else {
+                    double seconds = steadySeconds() - replayStart;
+                    std::cout << "Replayed " << replayFrames << " frames in " << seconds << " s ("
+                              << seconds * 1000.0 / std::max<uint64_t>(replayFrames, 1) << " ms/frame)" << std::endl;
+                    if (tracePath) {
+                        if (profiler.exportChromeTrace(tracePath, Profiler::kHistory, sessionError))
+                            std::cout << "Wrote " << tracePath << std::endl;
+                        else
+                            std::cout << sessionError << std::endl;
+                    }
+                    sessionReplay.close();
+                    replayEvents.clear();
+                    simulation.start(simTickHz);
+                    if (headless)
+                        glfwSetWindowShouldClose(window, true);
+                }
+            } else if (sessionRecorder.isOpen()) {
+                bool firstFrame = sessionRecorder.frameCount() == 0;
+                sessionRecorder.beginFrame(glfwGetTime());
+                if (firstFrame) {
+                    SessionEvent size;
+                    size.type = SessionEvent::FramebufferSize;
+                    int width, height;
+                    glfwGetFramebufferSize(window, &width, &height);
+                    size.x = width;
+                    size.y = height;
+                    sessionRecorder.write(size);
+                }
+            }
 
-        ImGui::End();
+            // input
+            // -----
+            {
+                ProfileScope scope(profiler, "Input");
+                processInput(window);
+            }
 
-        ImGui::Begin("Axis Controls");
-        ImGui::SliderFloat("Axis Thickness", &line_thickness, 1.0f, 10.0f);
-        static float imgui_scale = 1.0f;
-        if (ImGui::SliderFloat("ImGui Scale", &imgui_scale, 0.5f, 2.0f)) {
-            ImGui::GetIO().FontGlobalScale = imgui_scale;
-        }
-        ImGui::End();
+            // hand the live feeds to the simulation and pick up its latest snapshot;
+            // this only touches lock-free queues, never the kernel
+            // -----------------------------------------------------------------------
+            {
+                ProfileScope scope(profiler, "Simulation");
+                static double rateWindowStart = glfwGetTime();
+                static uint64_t rateWindowCount = 0;
+                StateSample latest = {};
+                // The frame's samples reach the simulation as one batch
+                static std::vector<glm::vec3> feedBatch;
+                auto consume = [&](const StateSample& sample) {
+                    latest = sample;
+                    feedBatch.push_back(sample.bloch());
+                    if (densityEnabled && densityBinFeed)
+                        densityPending.push_back(sample.bloch());
+                    if (searchIndexFeed) {
+                        if (searchIndex.size() >= kSearchFeedLimit) {
+                            size_t first = searchIndex.size() - kSearchFeedLimit / 2;
+                            searchKept.resize(searchIndex.size() - first);
+                            for (size_t i = 0; i < searchKept.size(); ++i)
+                                searchKept[i] = searchIndex.point((uint32_t)(first + i));
+                            searchIndex.build(searchKept.data(), searchKept.size());
+                            searchTimes.erase(searchTimes.begin(), searchTimes.begin() + first);
+                        }
+                        searchIndex.insert(sample.bloch());
+                        searchTimes.push_back(sample.timestamp);
+                    }
+                    if (sessionRecorder.isOpen()) {
+                        SessionEvent event;
+                        event.type = SessionEvent::State;
+                        event.sample = sample;
+                        sessionRecorder.write(event);
+                    }
+                };
+                size_t drained = 0;
+                if (sessionReplay.isOpen()) {
+                    // Replays inject the recorded states instead of reading the feeds
+                    for (const SessionEvent& event : replayEvents) {
+                        if (event.type == SessionEvent::State) {
+                            consume(event.sample);
+                            ++drained;
+                        }
+                    }
+                } else {
+                    if (stateFeed.isOpen())
+                        drained += stateFeed.ring().drain(consume);
+                    if (ingestServer.isRunning())
+                        drained += ingestServer.drain(consume);
+                }
+                if (!feedBatch.empty()) {
+                    simulation.injectBatch(feedBatch.data(), feedBatch.size());
+                    feedBatch.clear();
+                }
+                if (!densityPending.empty()) {
+                    densityHistogram.add(densityPending.data(), densityPending.size());
+                    densityPending.clear();
+                }
+                if (drained > 0) {
+                    feedReceived += drained;
+                    rateWindowCount += drained;
+                    feedLatencyMs = (steadySeconds() - latest.timestamp) * 1000.0;
+                }
+                if (glfwGetTime() - rateWindowStart >= 1.0) {
+                    feedRate = rateWindowCount / (glfwGetTime() - rateWindowStart);
+                    rateWindowStart = glfwGetTime();
+                    rateWindowCount = 0;
+                }
+
+                if (sessionReplay.isOpen())
+                    simulation.tick(replayFrameDt);
+                if (simulation.update()) {
+                    const SimulationSnapshot& snapshot = simulation.snapshot();
+                    if (snapshot.stateVersion != simStateVersion) {
+                        simStateVersion = snapshot.stateVersion;
+                        simFollowing = true;
+                    }
+                    if (snapshot.trailVersion != simTrailVersion) {
+                        simTrailVersion = snapshot.trailVersion;
+                        simTrail.resize(snapshot.trail.size());
+                        for (size_t i = 0; i < simTrail.size(); ++i)
+                            simTrail[i] = toScene(snapshot.trail[i]);
+                        if (simTrail.empty())
+                            stateVector.clearTrail();
+                        else
+                            stateVector.setTrail(simTrail.data(), simTrail.size());
+                    }
+                }
+                // Between simulation steps, show the state part way to the next
+                // one. Replays stop at the published fraction so they depend on
+                // recorded time only.
+                if (simFollowing) {
+                    const SimulationSnapshot& snapshot = simulation.snapshot();
+                    setStateFromBloch(snapshot.displayBloch(sessionReplay.isOpen() ? snapshot.publishedAt : steadySeconds()));
+                    simTheta = theta;
+                    simPhi = phi;
+                }
+            }
+
+            // render
+            // ------
+            glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // create transformations
+            glm::mat4 projection = glm::perspective(kFovY, (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+            glm::mat4 view = camera.GetViewMatrix();
+
+            glm::mat4 pvMatrix = projection * view;
+
+            // grid layout and its picking hierarchy, redone when the grid changes
+            if (gridLayoutSize != sceneGrid) {
+                float gridOffset = 0.5f * (sceneGrid - 1) * kGridSpacing;
+                gridCenters.clear();
+                gridBounds.clear();
+                BoundingSpheres gridSpheres;
+                for (int row = 0; row < sceneGrid; ++row) {
+                    for (int column = 0; column < sceneGrid; ++column) {
+                        gridCenters.emplace_back(column * kGridSpacing - gridOffset, 0.0f, row * kGridSpacing - gridOffset);
+                        gridBounds.add(gridCenters.back(), kGridBoundRadius);
+                        gridSpheres.add(gridCenters.back(), 1.0f);
+                    }
+                }
+                gridPicking.build(gridSpheres);
+                gridLayoutSize = sceneGrid;
+            }
+
+            // holding the right button on a sphere points the state at the cursor
+            if (rightMouseDown && !io.WantCaptureMouse) {
+                ProfileScope scope(profiler, "Picking");
+                Ray ray = rayFromScreen(pvMatrix, glm::vec2(io.MousePos.x, io.MousePos.y), glm::vec2(io.DisplaySize.x, io.DisplaySize.y));
+                uint32_t cell;
+                float distance;
+                if (gridPicking.intersect(ray, cell, distance)) {
+                    stateVector.hidePrevious();
+                    setStateFromBloch(fromScene(ray.origin + distance * ray.direction - gridCenters[cell]));
+                }
+            }
+
+            // a playing pulse streams its state and the path so far
+            if (pulsePlaying) {
+                double fraction = std::min((glfwGetTime() - pulsePlayStart) / std::max(pulsePlaySeconds, 0.01f), 1.0);
+                size_t samples = pulseEngine.samples();
+                size_t position = (size_t)(fraction * samples * pulseRepeats);
+                setStateFromBloch(pulseEngine.stateAt(pulseStart, (unsigned int)(position / samples), position % samples));
+                stateVector.setTrail(pulseTrail.data(), std::min(pulseTrail.size(), position / pulseTrailStride + 1));
+                pulsePlaying = fraction < 1.0;
+            }
 
-        // Render axis labels
-        glm::mat4 identityModel = glm::mat4(1.0f);
-        glm::vec4 viewport = glm::vec4(0.0f, 0.0f, (float)SCR_WIDTH, (float)SCR_HEIGHT);
+            // queue the sphere, axes and state vector, once per grid cell, then
+            // draw them sorted by program and state
+            {
+                ProfileScope scope(profiler, "Submit");
+                renderQueue.begin(view, projection);
+                const std::vector<RbPoint>& rbPoints = rbBenchmark.points();
+                if (rbAnimate && !rbPoints.empty()) {
+                    double position = std::fmod(glfwGetTime() / std::max(rbSecondsPerLength, 0.01f), (double)rbPoints.size());
+                    size_t index = (size_t)position;
+                    size_t next = std::min(index + 1, rbPoints.size() - 1);
+                    float t = (float)(position - index);
+                    rbBloch = glm::mix(rbPoints[index].meanBloch, rbPoints[next].meanBloch, t);
+                    rbLength = glm::mix((float)rbPoints[index].length, (float)rbPoints[next].length, t);
+                    rbSurvival = glm::mix((float)rbPoints[index].survival, (float)rbPoints[next].survival, t);
+                    stateVector.update(rbBloch);
+                } else {
+                    stateVector.update(theta, phi);
+                }
+                gridVisible.resize(gridCenters.size());
+                size_t visibleCount = gridCenters.size();
+                if (frustumCulling)
+                    visibleCount = cullSpheres(Frustum::fromMatrix(pvMatrix), gridBounds, gridVisible.data());
+                else
+                    std::iota(gridVisible.begin(), gridVisible.end(), 0u);
+                drawStats().cullTested += (uint32_t)gridCenters.size();
+                drawStats().culled += (uint32_t)(gridCenters.size() - visibleCount);
+
+                if (sphereLodEnabled) {
+                    gridLevels.resize(gridCenters.size(), sphereLod.coarsest());
+                    lodTriangles = sphereLod.select(gridCenters.data(), gridLevels.data(), gridVisible.data(), visibleCount,
+                                                    camera.Position, kFovY, (float)SCR_HEIGHT, (uint64_t)lodTriangleBudget);
+                }
+                for (size_t k = 0; k < visibleCount; ++k) {
+                    uint32_t i = gridVisible[k];
+                    glm::mat4 model = glm::translate(glm::mat4(1.0f), gridCenters[i]);
+                    const Sphere& mesh = sphereLodEnabled ? sphereLod.level(gridLevels[i]) : sphere;
+                    mesh.submit(renderQueue, sphereShader, model, true);
+                    axes.submit(renderQueue, axesShader, model, line_thickness);
+                    if (hideOccludedArrows && occludedBySphere(camera.Position, gridCenters[i] + stateVector.tip(), gridCenters[i], 1.0f))
+                        ++drawStats().occluded;
+                    else
+                        stateVector.submit(renderQueue, stateVectorShader, model);
+                }
+            }
+            if (majoranaEnabled) {
+                ProfileScope scope(profiler, "Majorana stars");
+                double twist = majoranaTwist;
+                if (majoranaAnimate)
+                    twist *= 0.5 * (1.0 - std::cos(glfwGetTime()));
+                coherentSpinState((unsigned int)majoranaTwoJ, glm::radians(theta), glm::radians(phi), majoranaState);
+                twistSpinState(majoranaState, twist);
+                auto solveStart = std::chrono::steady_clock::now();
+                majoranaSolver.solve(majoranaState, majoranaStars);
+                majoranaSolveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - solveStart).count();
+                majoranaConstellation.update(majoranaStars);
+                majoranaConstellation.submit(renderQueue, stateVectorShader, glm::mat4(1.0f), glm::vec3(1.0f, 0.5f, 0.9f));
+            }
+            {
+                ProfileScope scope(profiler, "RenderQueue::flush", true);
+                renderQueue.setSorting(queueSorting);
+                renderQueue.flush();
+            }
+            if (densityEnabled) {
+                ProfileScope scope(profiler, "Density", true);
+                densityRowsUploaded = densityMap.upload(densityHistogram);
+                densityMap.draw(densityShader, view, projection, glm::mat4(1.0f));
+            }
+            if (quasiEnabled) {
+                ProfileScope scope(profiler, "Quasi-probability", true);
+                // The series only changes with its inputs; the grid then redoes its rows
+                glm::vec3 bloch = quasiLength * blochFromAngles(glm::radians(theta), glm::radians(phi));
+                glm::vec4 inputs(bloch, (float)(quasiTwoJ * 2 + quasiKind));
+                if (inputs != quasiInputs) {
+                    quasiInputs = inputs;
+                    quasiGrid.setSeries(quasiProbabilitySeries((QuasiProbabilityKind)quasiKind, bloch, quasiTwoJ));
+                }
+                quasiRowsComputed = quasiGrid.update((unsigned int)quasiRowsPerFrame);
+                quasiMap.upload(quasiGrid);
+                quasiMap.draw(quasiShader, view, projection, glm::mat4(1.0f));
+            }
+
+            // ImGui
+            int imguiScope = profiler.beginScope("ImGui build", false);
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+
+            // Nearest indexed sample under the cursor, if it is over the central sphere
+            if (!io.WantCaptureMouse && searchIndex.size() > 0) {
+                Ray ray = rayFromScreen(pvMatrix, glm::vec2(io.MousePos.x, io.MousePos.y), glm::vec2(io.DisplaySize.x, io.DisplaySize.y));
+                float distance;
+                if (intersectSphere(ray, glm::vec3(0.0f), 1.0f, distance)) {
+                    glm::vec3 hit = fromScene(ray.origin + distance * ray.direction);
+                    searchIndex.nearest(hit, 1, searchNeighbors);
+                    if (!searchNeighbors.empty() && searchNeighbors[0].angle <= glm::radians(searchHoverDegrees)) {
+                        const SphereIndex::Neighbor& hover = searchNeighbors[0];
+                        float hoverTheta, hoverPhi;
+                        blochToAngles(searchIndex.point(hover.id), hoverTheta, hoverPhi);
+                        ImGui::BeginTooltip();
+                        ImGui::Text("Sample %u at t = %.3f s", hover.id, searchTimes[hover.id]);
+                        ImGui::Text("Theta %.1f, phi %.1f deg", glm::degrees(hoverTheta), glm::degrees(hoverPhi));
+                        ImGui::EndTooltip();
+                    }
+                }
+            }
+
+            // Calculate Dirac notation
+            Amplitudes amplitudes = amplitudesFromBloch(blochFromAngles(glm::radians(theta), glm::radians(phi)));
+
+            // ImGui State Display
+            ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x * 0.5f, 0), ImGuiCond_Always, ImVec2(0.5f, 0));
+            ImGui::Begin("State Display", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoMove);
+            ImGui::Text("|psi> = (%.2f)|0> + (%.2f + %.2fi)|1>", amplitudes.alpha.real(), amplitudes.beta.real(), amplitudes.beta.imag());
+            ImGui::End();
+
+            ImGui::Begin("Bloch Sphere Controls");
+            ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+            if (ImGui::SliderFloat("Theta (deg)", &theta, 0.0f, 180.0f)) {
+                stateVector.hidePrevious();
+            }
+            if (ImGui::SliderFloat("Phi (deg)", &phi, 0.0f, 360.0f)) {
+                stateVector.hidePrevious();
+            }
+            ImGui::TextDisabled("Or hold the right button on a sphere (%u tests last pick)", gridPicking.lastTests());
+
+            ImGui::SliderFloat("Mouse Sensitivity", &mouseSensitivity, 0.01f, 1.0f);
+
+            ImGui::Separator();
+            ImGui::Text("Apply Pauli Gates");
+            auto applyGate = [&](const BlochChannel& gate) {
+                stateVector.storePreviousState();
+                setStateFromBloch(gate.apply(blochFromAngles(glm::radians(theta), glm::radians(phi))));
+            };
+            if (ImGui::Button("Pauli X"))
+                applyGate(pauliX());
+            if (ImGui::Button("Pauli Y"))
+                applyGate(pauliY());
+            if (ImGui::Button("Pauli Z"))
+                applyGate(pauliZ());
+
+            ImGui::End();
+
+            ImGui::Begin("Axis Controls");
+            ImGui::SliderFloat("Axis Thickness", &line_thickness, 1.0f, 10.0f);
+            static float imgui_scale = 1.0f;
+            if (ImGui::SliderFloat("ImGui Scale", &imgui_scale, 0.5f, 2.0f)) {
+                ImGui::GetIO().FontGlobalScale = imgui_scale;
+            }
+            ImGui::End();
+
+            ImGui::Begin("Parameter Sweep");
+            auto sweepAxisControls = [](const char* label, SweepAxis& axis) {
+                ImGui::PushID(label);
+                if (ImGui::BeginCombo(label, sweepParameterName(axis.parameter))) {
+                    for (int i = 0; i < (int)SweepParameter::Count; ++i) {
+                        SweepParameter parameter = (SweepParameter)i;
+                        if (ImGui::Selectable(sweepParameterName(parameter), parameter == axis.parameter))
+                            axis.parameter = parameter;
+                    }
+                    ImGui::EndCombo();
+                }
+                ImGui::DragFloatRange2("Range", &axis.min, &axis.max, 0.1f);
+                int count = (int)axis.count;
+                if (ImGui::SliderInt("Cells", &count, 1, 100))
+                    axis.count = (unsigned int)count;
+                ImGui::PopID();
+            };
+            sweepAxisControls("Columns", sweepSettings.columns);
+            sweepAxisControls("Rows", sweepSettings.rows);
+            ImGui::SliderFloat("Rabi Rate", &sweepSettings.dynamics.rabi, 0.0f, 10.0f);
+            ImGui::SliderFloat("Detuning", &sweepSettings.dynamics.detuning, -10.0f, 10.0f);
+            ImGui::SliderFloat("T1 (0 = off)", &sweepSettings.dynamics.t1, 0.0f, 20.0f);
+            ImGui::SliderFloat("T2 (0 = off)", &sweepSettings.dynamics.t2, 0.0f, 20.0f);
+            ImGui::SliderFloat("Duration", &sweepSettings.duration, 0.0f, 10.0f);
+            ImGui::SliderInt("Cell Size (px)", &sweepCellSize, 16, 256);
+            if (ImGui::Button("Render Sheet"))
+            {
+                // Parameters that are not swept start from the current state
+                sweepSettings.theta = theta;
+                sweepSettings.phi = phi;
+                sweep.run(sweepSettings);
+                sweepRenderer.renderSheet(sweep, sweepCellSize, sweepSphereShader, sweepVectorShader, "sweep_sheet.tga");
+            }
+            ImGui::Text("Simulated %u cells in %.2f ms", (unsigned int)sweep.cells().size(), sweep.elapsedMs());
+            ImGui::TextWrapped("%s", sweepRenderer.status().c_str());
+            ImGui::End();
+
+            ImGui::Begin("Trajectory");
+            ImGui::InputText("File", trajectoryPath, sizeof(trajectoryPath));
+            bool trajectoryChanged = false;
+            if (ImGui::Button("Open"))
+            {
+                if (trajectory.open(trajectoryPath, trajectoryStatus)) {
+                    trajectoryStatus = std::to_string(trajectory.sampleCount()) + " samples";
+                    trajectoryTime = trajectory.startTime();
+                    trajectoryChanged = true;
+                } else {
+                    stateVector.clearTrail();
+                }
+            }
+            ImGui::SameLine();
+            ImGui::TextUnformatted(trajectoryStatus.c_str());
+            if (trajectory.isOpen()) {
+                double start = trajectory.startTime();
+                double end = trajectory.endTime();
+                trajectoryChanged |= ImGui::SliderScalar("Time", ImGuiDataType_Double, &trajectoryTime, &start, &end);
+                trajectoryChanged |= ImGui::SliderFloat("Window", &trajectoryWindow, 0.0f, (float)(end - start), "%.1f", ImGuiSliderFlags_Logarithmic);
+            }
+            if (trajectoryChanged && trajectory.sampleCount() > 0)
+            {
+                // Only the visible window is read from the mapping and uploaded
+                trajectory.readWindow(trajectoryTime - trajectoryWindow, trajectoryTime, maxTrailSamples, trajectorySamples);
+                for (glm::vec3& sample : trajectorySamples)
+                    sample = toScene(sample);
+                stateVector.setTrail(trajectorySamples.data(), trajectorySamples.size());
+
+                uint64_t index = trajectory.seek(trajectoryTime);
+                if (index == trajectory.sampleCount() || (index > 0 && trajectory.timeAt(index) > trajectoryTime))
+                    --index;
+                stateVector.hidePrevious();
+                setStateFromBloch(trajectory.blochAt(index));
+            }
+            ImGui::End();
+
+            ImGui::Begin("Density");
+            if (ImGui::Checkbox("Show Density", &densityEnabled) && densityEnabled)
+                quasiEnabled = false;
+            if (ImGui::Combo("Resolution", &densityResolution, kDensityResolutions, IM_ARRAYSIZE(kDensityResolutions)))
+                densityHistogram.reset(kDensityNsides[densityResolution]);
+            ImGui::Checkbox("Bin Feed Samples", &densityBinFeed);
+            if (trajectory.isOpen() && ImGui::Button("Bin Trajectory")) {
+                // The whole file in bounded blocks, so memory stays flat however
+                // long the trajectory; the trail keeps its own window
+                auto binStart = std::chrono::steady_clock::now();
+                uint64_t sampleCount = trajectory.sampleCount();
+                densityBlock.resize((size_t)std::min<uint64_t>(kDensityBlock, sampleCount));
+                for (uint64_t first = 0; first < sampleCount; first += kDensityBlock) {
+                    size_t count = (size_t)std::min<uint64_t>(kDensityBlock, sampleCount - first);
+                    trajectory.readSamples(first, count, densityBlock.data());
+                    densityHistogram.add(densityBlock.data(), count);
+                }
+                densityBinMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - binStart).count();
+                densityEnabled = true;
+                quasiEnabled = false;
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear"))
+                densityHistogram.clear();
+            ImGui::Text("%llu samples, peak %u per bin", (unsigned long long)densityHistogram.total(), densityHistogram.peak());
+            if (densityBinMs > 0.0)
+                ImGui::Text("Last trajectory binned in %.1f ms", densityBinMs);
+            ImGui::Text("%u texture rows uploaded last frame", densityRowsUploaded);
+            ImGui::End();
+
+            ImGui::Begin("Quasi-Probability");
+            if (ImGui::Checkbox("Show Distribution", &quasiEnabled) && quasiEnabled)
+                densityEnabled = false;
+            ImGui::Combo("Function", &quasiKind, kQuasiKinds, IM_ARRAYSIZE(kQuasiKinds));
+            ImGui::SliderInt("2j", &quasiTwoJ, 1, 20);
+            ImGui::SliderFloat("Bloch Length", &quasiLength, 0.0f, 1.0f);
+            ImGui::SliderInt("Rows per Frame", &quasiRowsPerFrame, 1, (int)quasiGrid.height());
+            float quasiLow, quasiHigh;
+            quasiGrid.series().range(quasiLow, quasiHigh);
+            ImGui::Text("Range %.4f to %.4f", quasiLow, quasiHigh);
+            ImGui::Text("%u rows computed last frame, %u stale", quasiRowsComputed, quasiGrid.staleRows());
+            ImGui::End();
+
+            ImGui::Begin("Sample Search");
+            ImGui::Checkbox("Index Feed Samples", &searchIndexFeed);
+            if (trajectory.isOpen() && ImGui::Button("Index Trajectory")) {
+                // Replaces the index; sample ids are then the file's sample
+                // indices. Samples and times are read straight into the index
+                // and the time table, with no copy of the file in between.
+                uint64_t sampleCount = trajectory.sampleCount();
+                if (sampleCount > kSearchTrajectoryLimit) {
+                    searchStatus = std::to_string(sampleCount) + " samples is more than the " +
+                                   std::to_string(kSearchTrajectoryLimit) + " that can be indexed";
+                } else {
+                    auto buildStart = std::chrono::steady_clock::now();
+                    searchTimes.resize((size_t)sampleCount);
+                    searchIndex.buildInPlace((size_t)sampleCount, [&](glm::vec3* points) {
+                        trajectory.readSamples(0, (size_t)sampleCount, points, searchTimes.data());
+                    });
+                    searchBuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+                    searchStatus.clear();
+                }
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear##search")) {
+                searchIndex.clear();
+                searchTimes.clear();
+            }
+            ImGui::Text("%zu samples indexed (feed keeps the newest %zu)", searchIndex.size(), kSearchFeedLimit);
+            if (!searchStatus.empty())
+                ImGui::TextUnformatted(searchStatus.c_str());
+            if (searchBuildMs > 0.0)
+                ImGui::Text("Last trajectory indexed in %.1f ms", searchBuildMs);
+            ImGui::SliderFloat("Hover Radius (deg)", &searchHoverDegrees, 0.1f, 10.0f);
+            ImGui::SliderInt("Nearest", &searchNearestCount, 1, 32);
+            ImGui::SliderFloat("Cap (deg)", &searchCapDegrees, 0.1f, 90.0f);
+            if (searchIndex.size() > 0) {
+                // Around the shown state; click a result to show that sample
+                glm::vec3 shown = blochFromAngles(glm::radians(theta), glm::radians(phi));
+                auto queryStart = std::chrono::steady_clock::now();
+                searchIndex.nearest(shown, (size_t)searchNearestCount, searchNeighbors);
+                searchIndex.withinCap(shown, glm::radians(searchCapDegrees), searchCap);
+                double queryMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queryStart).count();
+                ImGui::Text("%zu within the cap, queries took %.3f ms", searchCap.size(), queryMs);
+                for (const SphereIndex::Neighbor& neighbor : searchNeighbors) {
+                    const char* label = frameArena().format("#%u  %.2f deg  t = %.3f s", neighbor.id, glm::degrees(neighbor.angle), searchTimes[neighbor.id]);
+                    if (ImGui::Selectable(label)) {
+                        stateVector.hidePrevious();
+                        setStateFromBloch(searchIndex.point(neighbor.id));
+                    }
+                }
+            }
+            ImGui::End();
+
+            ImGui::Begin("Randomized Benchmarking");
+            {
+                int maxLength = (int)rbSettings.maxLength, lengthCount = (int)rbSettings.lengthCount, sequences = (int)rbSettings.sequences;
+                if (ImGui::SliderInt("Max Length", &maxLength, 1, 5000, "%d", ImGuiSliderFlags_Logarithmic))
+                    rbSettings.maxLength = (unsigned int)maxLength;
+                if (ImGui::SliderInt("Lengths", &lengthCount, 2, 40))
+                    rbSettings.lengthCount = (unsigned int)lengthCount;
+                if (ImGui::SliderInt("Sequences", &sequences, 10, 10000, "%d", ImGuiSliderFlags_Logarithmic))
+                    rbSettings.sequences = (unsigned int)sequences;
+            }
+            ImGui::SliderFloat("Depolarizing", &rbSettings.depolarizing, 0.0f, 0.1f, "%.4f", ImGuiSliderFlags_Logarithmic);
+            ImGui::SliderFloat("Dephasing", &rbSettings.dephasing, 0.0f, 0.1f, "%.4f", ImGuiSliderFlags_Logarithmic);
+            ImGui::SliderFloat("Amplitude Damping", &rbSettings.amplitudeDamping, 0.0f, 0.1f, "%.4f", ImGuiSliderFlags_Logarithmic);
+            ImGui::SliderFloat("Over-Rotation (rad)", &rbSettings.overRotation, -0.2f, 0.2f, "%.4f");
+            if (ImGui::Button("Run")) {
+                rbBenchmark.run(rbSettings);
+                rbCurve.clear();
+                for (const RbPoint& point : rbBenchmark.points())
+                    rbCurve.push_back((float)point.survival);
+            }
+            if (!rbCurve.empty()) {
+                const RbFit& fit = rbBenchmark.fit();
+                ImGui::SameLine();
+                ImGui::Text("%llu Cliffords in %.2f ms", (unsigned long long)rbBenchmark.cliffords(), rbBenchmark.elapsedMs());
+                ImGui::PlotLines("Survival", rbCurve.data(), (int)rbCurve.size(), 0, nullptr, 0.0f, 1.0f, ImVec2(0.0f, 80.0f));
+                ImGui::Text("Fit %.4f * %.6f^m + %.4f", fit.amplitude, fit.decay, fit.offset);
+                ImGui::Text("Error per Clifford %.3e", fit.errorPerClifford);
+                ImGui::Checkbox("Animate", &rbAnimate);
+                ImGui::SliderFloat("Seconds per Length", &rbSecondsPerLength, 0.05f, 2.0f);
+                if (rbAnimate)
+                    ImGui::Text("Length %.0f: survival %.4f, |r| %.3f", rbLength, rbSurvival, glm::length(rbBloch));
+            }
+            ImGui::End();
+
+            ImGui::Begin("Pulses");
+            {
+                auto sliderDouble = [](const char* label, double& value, double min, double max, const char* format) {
+                    return ImGui::SliderScalar(label, ImGuiDataType_Double, &value, &min, &max, format);
+                };
+                if (ImGui::BeginCombo("Shape", pulseShapeName(pulseSettings.shape))) {
+                    for (int i = 0; i < (int)PulseShape::Count; ++i) {
+                        if (ImGui::Selectable(pulseShapeName((PulseShape)i), (PulseShape)i == pulseSettings.shape))
+                            pulseSettings.shape = (PulseShape)i;
+                    }
+                    ImGui::EndCombo();
+                }
+                if (ImGui::BeginCombo("Integrator", pulseIntegratorName(pulseSettings.integrator))) {
+                    for (int i = 0; i < (int)PulseIntegrator::Count; ++i) {
+                        if (ImGui::Selectable(pulseIntegratorName((PulseIntegrator)i), (PulseIntegrator)i == pulseSettings.integrator))
+                            pulseSettings.integrator = (PulseIntegrator)i;
+                    }
+                    ImGui::EndCombo();
+                }
+                int samples = (int)pulseSettings.samples;
+                if (ImGui::SliderInt("Samples", &samples, 1, 100000, "%d", ImGuiSliderFlags_Logarithmic))
+                    pulseSettings.samples = (unsigned int)std::max(samples, 1);
+                sliderDouble("Duration", pulseSettings.duration, 0.01, 10.0, "%.3f");
+                double angle = glm::degrees(pulseSettings.angle), phase = glm::degrees(pulseSettings.phase);
+                if (sliderDouble("Angle (deg)", angle, 0.0, 720.0, "%.1f"))
+                    pulseSettings.angle = glm::radians(angle);
+                if (sliderDouble("Phase (deg)", phase, 0.0, 360.0, "%.1f"))
+                    pulseSettings.phase = glm::radians(phase);
+                if (pulseSettings.shape != PulseShape::Square)
+                    sliderDouble("Sigma (of duration)", pulseSettings.sigma, 0.05, 1.0, "%.3f");
+                if (pulseSettings.shape == PulseShape::Drag)
+                    sliderDouble("DRAG Beta", pulseSettings.dragBeta, -0.5, 0.5, "%.4f");
+                sliderDouble("Detuning", pulseSettings.detuning, -20.0, 20.0, "%.3f");
+                ImGui::SliderInt("Repeats", &pulseRepeats, 1, 50);
+                ImGui::SliderFloat("Play Seconds", &pulsePlaySeconds, 0.1f, 20.0f);
+            }
+            // Settings that change mid-play stop it, since the path no longer applies
+            if (pulseEngine.prepare(pulseSettings))
+                pulsePlaying = false;
+            if (ImGui::Button("Play")) {
+                pulseStart = blochFromAngles(glm::radians(theta), glm::radians(phi));
+                size_t total = pulseEngine.samples() * pulseRepeats;
+                pulseTrailStride = std::max<size_t>(1, (total + kMaxPulseTrail - 1) / kMaxPulseTrail);
+                pulseEngine.trajectory(pulseStart, (unsigned int)pulseRepeats, pulseTrailStride, pulseTrail);
+                for (glm::vec3& point : pulseTrail)
+                    point = toScene(point);
+                pulsePlayStart = glfwGetTime();
+                pulsePlaying = true;
+                stateVector.storePreviousState();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Apply")) {
+                pulsePlaying = false;
+                stateVector.storePreviousState();
+                setStateFromBloch(pulseEngine.apply(blochFromAngles(glm::radians(theta), glm::radians(phi)), (unsigned int)pulseRepeats));
+            }
+            {
+                const glm::dquat& total = pulseEngine.total();
+                double sine = glm::length(glm::dvec3(total.x, total.y, total.z));
+                glm::dvec3 axis = sine > 0.0 ? glm::dvec3(total.x, total.y, total.z) / sine : glm::dvec3(0.0, 0.0, 1.0);
+                ImGui::Text("Pulse rotates %.3f deg about (%.3f, %.3f, %.3f)", glm::degrees(2.0 * std::atan2(sine, total.w)), axis.x, axis.y,
+                            axis.z);
+                const PulseEngine::Stats& pulseStats = pulseEngine.stats();
+                ImGui::Text("Built in %.1f us; %llu builds, %llu cache hits", pulseStats.buildMicros, (unsigned long long)pulseStats.builds,
+                            (unsigned long long)pulseStats.reuses);
+            }
+            ImGui::End();
 
-        auto draw_label_if_visible = [&](const char* id, const glm::vec3& pos_3d, const char* text) {
-            glm::vec3 screen_pos = glm::project(pos_3d, identityModel, pvMatrix, viewport);
-            if (screen_pos.z < 1.0f) {
-                ImGui::SetNextWindowPos(ImVec2(screen_pos.x, screen_pos.y), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
-                ImGui::Begin(id, nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoBackground);
-                ImGui::Text(text);
-                ImGui::End();
+            ImGui::Begin("Gate Synthesis");
+            ImGui::InputText("Table", synthesisPath, sizeof(synthesisPath));
+            if (ImGui::Button("Load")) {
+                if (synthesisNet.load(synthesisPath, synthesisStatus))
+                    synthesisStatus = "Loaded";
+            }
+            ImGui::SameLine();
+            if (synthesisNet.size() > 0 && ImGui::Button("Save")) {
+                if (synthesisNet.save(synthesisPath, synthesisStatus))
+                    synthesisStatus = "Saved";
+            }
+            ImGui::SliderInt("Max Word Length", &synthesisMaxLength, 1, (int)CliffordTNet::kMaxWordLength);
+            if (ImGui::Button("Build Net")) {
+                auto buildStart = std::chrono::steady_clock::now();
+                synthesisNet.build((unsigned int)synthesisMaxLength, 1000000);
+                double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+                synthesisStatus = "Built in " + std::to_string((int)buildMs) + " ms";
+            }
+            ImGui::SameLine();
+            ImGui::TextUnformatted(synthesisStatus.c_str());
+            if (synthesisNet.size() > 0) {
+                ImGui::Text("%zu unitaries, words up to %u gates, %zu KB in memory", synthesisNet.size(), synthesisNet.maxLength(),
+                            synthesisNet.memoryBytes() / 1024);
+                ImGui::Combo("Target", &synthesisTarget, kSynthesisTargets, IM_ARRAYSIZE(kSynthesisTargets));
+                if (synthesisTarget == 1) {
+                    ImGui::SliderFloat("Axis Theta (deg)", &synthesisAxisTheta, 0.0f, 180.0f);
+                    ImGui::SliderFloat("Axis Phi (deg)", &synthesisAxisPhi, 0.0f, 360.0f);
+                    ImGui::SliderFloat("Angle (deg)", &synthesisAngle, -180.0f, 180.0f);
+                }
+                ImGui::SliderInt("Refinement Levels", &synthesisDepth, 0, 4);
+
+                // Resynthesize when the target, depth or net changes
+                glm::vec4 inputs = synthesisTarget == 0 ? glm::vec4(theta, phi, -1.0f, (float)synthesisDepth)
+                                                        : glm::vec4(synthesisAxisTheta, synthesisAxisPhi, synthesisAngle, (float)synthesisDepth);
+                if (inputs != synthesisInputs || synthesisNet.size() != synthesisNetSize) {
+                    synthesisInputs = inputs;
+                    synthesisNetSize = synthesisNet.size();
+                    if (synthesisTarget == 0) {
+                        // Rz(phi) Ry(theta) takes |0> to the shown state
+                        double halfTheta = 0.5 * glm::radians((double)theta), halfPhi = 0.5 * glm::radians((double)phi);
+                        synthesisGoal = glm::dquat(std::cos(halfPhi), 0.0, 0.0, std::sin(halfPhi)) *
+                                        glm::dquat(std::cos(halfTheta), 0.0, std::sin(halfTheta), 0.0);
+                    } else {
+                        glm::dvec3 axis(blochFromAngles(glm::radians(synthesisAxisTheta), glm::radians(synthesisAxisPhi)));
+                        double half = 0.5 * glm::radians((double)synthesisAngle);
+                        synthesisGoal = glm::dquat(std::cos(half), std::sin(half) * axis.x, std::sin(half) * axis.y, std::sin(half) * axis.z);
+                    }
+                    auto synthesisStart = std::chrono::steady_clock::now();
+                    synthesisResult = synthesizeCliffordT(synthesisNet, synthesisGoal, (unsigned int)synthesisDepth);
+                    synthesisMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - synthesisStart).count();
+                }
+                glm::dvec3 reached = synthesisResult.unitary * glm::dvec3(0.0, 0.0, 1.0);
+                glm::dvec3 wanted = synthesisGoal * glm::dvec3(0.0, 0.0, 1.0);
+                ImGui::Text("%zu gates, T-count %u, distance %.2e, %.3f ms", synthesisResult.gates.size(), tCount(synthesisResult.gates),
+                            synthesisResult.distance, synthesisMs);
+                ImGui::Text("Infidelity on |0>: %.2e", 0.5 * (1.0 - glm::dot(reached, wanted)));
+                // Deep refinements run to thousands of gates; show the start
+                std::string word = formatCliffordT(synthesisResult.gates);
+                if (word.size() > 600)
+                    word = word.substr(0, 600) + " ...";
+                ImGui::TextWrapped("%s", word.c_str());
+                if (ImGui::Button("Apply to |0>")) {
+                    stateVector.hidePrevious();
+                    setStateFromBloch(glm::vec3(reached));
+                }
+            }
+            ImGui::End();
+
+            ImGui::Begin("Majorana Stars");
+            ImGui::Checkbox("Show Stars", &majoranaEnabled);
+            ImGui::SliderInt("2j", &majoranaTwoJ, 1, 100);
+            ImGui::SliderFloat("Twisting", &majoranaTwist, 0.0f, 3.14159265f);
+            ImGui::Checkbox("Animate", &majoranaAnimate);
+            if (majoranaEnabled) {
+                const MajoranaSolver::Stats& solverStats = majoranaSolver.stats();
+                ImGui::Text("%u stars in %.3f ms, %u iterations (%s%s)", (unsigned int)majoranaStars.size(), majoranaSolveMs,
+                            solverStats.iterations, solverStats.warmStart ? "warm" : "cold",
+                            solverStats.converged ? "" : ", not converged");
+            }
+            ImGui::End();
+
+            ImGui::Begin("Live Feed");
+            ImGui::InputText("Name", stateFeedName, sizeof(stateFeedName));
+            if (!stateFeed.isOpen()) {
+                if (ImGui::Button("Connect") && stateFeed.open(stateFeedName, stateFeedStatus)) {
+                    stateFeedStatus = "Connected";
+                    stateVector.hidePrevious();
+                    simulation.clearTrail();
+                    feedReceived = 0;
+                }
+            } else if (ImGui::Button("Disconnect")) {
+                stateFeed.close();
+                stateFeedStatus = "Disconnected";
+                simulation.clearTrail();
+            }
+            ImGui::SameLine();
+            ImGui::TextUnformatted(stateFeedStatus.c_str());
+            if (stateFeed.isOpen()) {
+                ImGui::Text("%.0f samples/s, %llu received", feedRate, (unsigned long long)feedReceived);
+                ImGui::Text("Latency %.3f ms, %llu dropped by producer", feedLatencyMs, (unsigned long long)stateFeed.ring().dropped());
+            }
+            ImGui::End();
+
+            ImGui::Begin("Ingest");
+            const char* transports[] = { "UDP (localhost port)", "Unix socket (path)" };
+            ImGui::Combo("Transport", &ingestTransport, transports, IM_ARRAYSIZE(transports));
+            ImGui::InputText("Address", ingestAddress, sizeof(ingestAddress));
+            if (!ingestServer.isRunning()) {
+                IngestServer::Transport transport = ingestTransport == 0 ? IngestServer::Transport::Udp : IngestServer::Transport::Unix;
+                if (ImGui::Button("Start") && ingestServer.start(transport, ingestAddress, ingestStatus)) {
+                    ingestStatus = "Listening";
+                    stateVector.hidePrevious();
+                    simulation.clearTrail();
+                }
+            } else if (ImGui::Button("Stop")) {
+                ingestServer.stop();
+                ingestStatus = "Stopped";
+            }
+            ImGui::SameLine();
+            ImGui::TextUnformatted(ingestStatus.c_str());
+            if (ingestServer.isRunning()) {
+                IngestServer::Counters counters = ingestServer.counters();
+                ImGui::Text("%llu packets, %llu samples", (unsigned long long)counters.packets, (unsigned long long)counters.samples);
+                ImGui::Text("Dropped: %llu packets lost, %llu samples over queue", (unsigned long long)counters.lostPackets, (unsigned long long)counters.queueDrops);
+                ImGui::Text("Malformed: %llu", (unsigned long long)counters.malformed);
+                ImGui::Text("Latency %.3f ms (peak %.3f ms)", counters.latencyMs, counters.maxLatencyMs);
+                ImGui::SameLine();
+                if (ImGui::SmallButton("Reset Peak"))
+                    ingestServer.resetPeak();
+            }
+            ImGui::End();
+
+            ImGui::Begin("Simulation");
+            const SimulationSnapshot& simSnapshot = simulation.snapshot();
+            ImGui::Text("Render %.1f FPS, simulation %.0f steps/s", ImGui::GetIO().Framerate, simSnapshot.stepRate);
+            ImGui::Text("Step %llu, t = %.3f", (unsigned long long)simSnapshot.step, simSnapshot.time);
+            if (simSnapshot.queuedSteps > 0)
+                ImGui::Text("%llu steps queued", (unsigned long long)simSnapshot.queuedSteps);
+            if (simSnapshot.commandDrops > 0)
+                ImGui::Text("%llu commands dropped", (unsigned long long)simSnapshot.commandDrops);
+            if (simSnapshot.sampleDrops > 0)
+                ImGui::Text("%llu feed samples dropped", (unsigned long long)simSnapshot.sampleDrops);
+            bool dynamicsChanged = ImGui::Checkbox("Evolve", &simEvolve);
+            dynamicsChanged |= ImGui::SliderFloat("Rabi Rate", &simParams.rabi, 0.0f, 10.0f);
+            dynamicsChanged |= ImGui::SliderFloat("Detuning", &simParams.detuning, -10.0f, 10.0f);
+            dynamicsChanged |= ImGui::SliderFloat("T1 (0 = off)", &simParams.t1, 0.0f, 20.0f);
+            dynamicsChanged |= ImGui::SliderFloat("T2 (0 = off)", &simParams.t2, 0.0f, 20.0f);
+            dynamicsChanged |= ImGui::SliderInt("Substeps", &simSubsteps, 1, 100000, "%d", ImGuiSliderFlags_Logarithmic);
+            if (dynamicsChanged) {
+                SimulationCommand command;
+                command.type = SimulationCommand::SetDynamics;
+                command.evolve = simEvolve;
+                command.substeps = (unsigned int)simSubsteps;
+                command.params = simParams;
+                simulation.post(command);
+            }
+            bool clockChanged = ImGui::Checkbox("Pause", &simPaused);
+            ImGui::SameLine();
+            if (ImGui::Button("Step"))
+                simulation.singleStep();
+            clockChanged |= ImGui::SliderFloat("Time Scale", &simTimeScale, 0.001f, 100.0f, "%.3f", ImGuiSliderFlags_Logarithmic);
+            clockChanged |= ImGui::SliderFloat("Fixed Step (ms)", &simFixedStepMs, 0.01f, 100.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+            if (clockChanged)
+                simulation.setClock(simPaused, simTimeScale, simFixedStepMs / 1000.0);
+            ImGui::InputFloat("##fastforward", &simFastForward, 0.0f, 0.0f, "%.2f s");
+            ImGui::SameLine();
+            if (ImGui::Button("Fast Forward"))
+                simulation.fastForward(simFastForward);
+            ImGui::End();
+
+            // The controls above moved the state, so the simulation continues from there
+            if (theta != simTheta || phi != simPhi) {
+                simulation.setState(blochFromAngles(glm::radians(theta), glm::radians(phi)));
+                simTheta = theta;
+                simPhi = phi;
+                simFollowing = false;
             }
-        };
 
-        draw_label_if_visible("X Label", glm::vec3(1.5f, 0.0f, 0.0f), "(|0> + i|1>)/sqrt(2)");
-        draw_label_if_visible("Y Label", glm::vec3(0.0f, 1.5f, 0.0f), "|1>");
-        draw_label_if_visible("Z Label", glm::vec3(0.0f, 0.0f, 1.5f), "(|0> + |1>)/sqrt(2)");
-        draw_label_if_visible("Neg X Label", glm::vec3(-1.5f, 0.0f, 0.0f), "(|0> - i|1>)/sqrt(2)");
-        draw_label_if_visible("Neg Y Label", glm::vec3(0.0f, -1.5f, 0.0f), "|0>");
-        draw_label_if_visible("Neg Z Label", glm::vec3(0.0f, 0.0f, -1.5f), "(|0> - |1>)/sqrt(2)");
+            // Render axis labels
+            glm::vec4 viewport = glm::vec4(0.0f, 0.0f, (float)SCR_WIDTH, (float)SCR_HEIGHT);
+            drawAxisLabels(pvMatrix, viewport, camera.Position);
+
+            ImGui::Begin("Profiler");
+            profiler.drawImGui();
+            ImGui::End();
+
+            ImGui::Begin("Render Queue");
+            ImGui::SliderInt("Grid", &sceneGrid, 1, 16);
+            ImGui::Checkbox("Sort Packets", &queueSorting);
+            if (ImGui::Combo("Sphere Mesh", &sphereMesh, kSphereMeshes, IM_ARRAYSIZE(kSphereMeshes))) {
+                const unsigned int kUvResolution[] = { 8, 32 };
+                const unsigned int kSubdivisions[] = { 1, 3, 5 };
+                if (sphereMesh < 2)
+                    sphere = Sphere(1.0f, kUvResolution[sphereMesh], kUvResolution[sphereMesh]);
+                else
+                    sphere = Sphere(geometryCache().icosphere(1.0f, kSubdivisions[sphereMesh - 2]));
+            }
+            ImGui::Text("%u triangles per sphere, %zu meshes cached", sphere.triangleCount(), geometryCache().size());
+            ImGui::Checkbox("Frustum Culling", &frustumCulling);
+            ImGui::Checkbox("Hide Occluded Arrows", &hideOccludedArrows);
+            ImGui::Checkbox("Level of Detail", &sphereLodEnabled);
+            if (sphereLodEnabled) {
+                ImGui::SliderInt("Triangle Budget", &lodTriangleBudget, 10000, 2000000, "%d", ImGuiSliderFlags_Logarithmic);
+                unsigned int perLevel[8] = {};
+                for (unsigned int level : gridLevels)
+                    ++perLevel[level];
+                ImGui::Text("%llu triangles", (unsigned long long)lodTriangles);
+                for (unsigned int level = 0; level < sphereLod.levelCount(); ++level)
+                    ImGui::Text("Level %u (%u triangles): %u spheres", level, sphereLod.level(level).triangleCount(), perLevel[level]);
+            }
+            const RenderQueue::Stats& queueStats = renderQueue.stats();
+            ImGui::Text("%u packets, %u draw calls", queueStats.packets, queueStats.drawCalls);
+            ImGui::Text("Binds: %u programs, %u vertex arrays", queueStats.programBinds, queueStats.vertexArrayBinds);
+            ImGui::Text("%u state changes", queueStats.stateChanges);
+            ImGui::Text("Uniforms: %u written, %u skipped", queueStats.uniformUpdates, queueStats.uniformsSkipped);
+            ImGui::End();
+
+            ImGui::Begin("GPU Resources");
+            if (ImGui::Checkbox("Churn Spheres", &gpuChurn) && !gpuChurn)
+                churnSpheres.clear();
+            if (gpuChurn) {
+                // Varying resolutions, so buffers move between size classes
+                static unsigned int churnFrame = 0;
+                ++churnFrame;
+                churnSpheres.clear();
+                geometryCache().releaseUnused();
+                for (unsigned int i = 0; i < 16; ++i)
+                    churnSpheres.emplace_back(1.0f, 4 + (i + churnFrame) % 29, 8 + i);
+            }
+            drawGpuResourcesImGui();
+            ImGui::End();
+
+            ImGui::Render();
+            countImGuiDraws(ImGui::GetDrawData());
+            profiler.endScope(imguiScope);
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            {
+                ProfileScope scope(profiler, "ImGui render", true);
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            }
 
-        ImGui::Render();
+            {
+                ProfileScope scope(profiler, "Swap");
+                glfwSwapBuffers(window);
+            }
+            {
+                ProfileScope scope(profiler, "Input");
+                glfwPollEvents();
+                for (const SessionEvent& event : replayEvents) {
+                    if (event.type != SessionEvent::State)
+                        dispatchEvent(window, event);
+                }
+            }
+            profiler.endFrame();
+            frameArena().reset();
+        }
 
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        // Cleanup
+        if (sessionRecorder.isOpen()) {
+            uint64_t frames = sessionRecorder.frameCount();
+            if (sessionRecorder.close())
+                std::cout << "Recorded " << frames << " frames to " << recordPath << std::endl;
+            else
+                std::cout << "Failed to write " << recordPath << std::endl;
+        }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        profiler.shutdown();
     }
 
-    // Cleanup
+    churnSpheres.clear();
+    geometryCache().clear();
+    gpuPool().clear();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -309,14 +1383,14 @@ int main()
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
     glfwTerminate();
-    return 0;
+    return exitCode;
 }
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow *window)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+    if (keysDown[GLFW_KEY_ESCAPE])
         glfwSetWindowShouldClose(window, true);
 }
 
@@ -326,17 +1400,154 @@ void glfw_error_callback(int error, const char* description)
     std::cerr << "GLFW Error (" << error << "): " << description << std::endl;
 }
 
-// glfw: whenever the window size changed (by OS or user resize) this callback function executes
-// ---------------------------------------------------------------------------------------------
+// glfw: window event callbacks; each one becomes a SessionEvent
+// --------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    SessionEvent event;
+    event.type = SessionEvent::FramebufferSize;
+    event.x = width;
+    event.y = height;
+    windowEvent(window, event);
+}
+
+void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    SessionEvent event;
+    event.type = SessionEvent::CursorPos;
+    event.x = xpos;
+    event.y = ypos;
+    windowEvent(window, event);
+}
+
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+    SessionEvent event;
+    event.type = SessionEvent::MouseButton;
+    event.code = button;
+    event.action = action;
+    event.mods = mods;
+    windowEvent(window, event);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    SessionEvent event;
+    event.type = SessionEvent::Scroll;
+    event.x = xoffset;
+    event.y = yoffset;
+    windowEvent(window, event);
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    SessionEvent event;
+    event.type = SessionEvent::Key;
+    event.code = key;
+    event.scancode = scancode;
+    event.action = action;
+    event.mods = mods;
+    windowEvent(window, event);
+}
+
+void char_callback(GLFWwindow* window, unsigned int codepoint)
+{
+    SessionEvent event;
+    event.type = SessionEvent::Char;
+    event.code = (int)codepoint;
+    windowEvent(window, event);
+}
+
+void cursor_enter_callback(GLFWwindow* window, int entered)
+{
+    SessionEvent event;
+    event.type = SessionEvent::CursorEnter;
+    event.code = entered;
+    windowEvent(window, event);
+}
+
+void window_focus_callback(GLFWwindow* window, int focused)
+{
+    SessionEvent event;
+    event.type = SessionEvent::WindowFocus;
+    event.code = focused;
+    windowEvent(window, event);
+}
+
+void windowEvent(GLFWwindow* window, const SessionEvent& event)
+{
+    if (sessionReplay.isOpen())
+        return;
+    if (sessionRecorder.isOpen())
+        sessionRecorder.write(event);
+    dispatchEvent(window, event);
+}
+
+void dispatchEvent(GLFWwindow* window, const SessionEvent& event)
+{
+    // The backend polls the live keyboard for modifiers, so they are set
+    // again from the tracked key state to keep replays independent of it
+    auto syncModifiers = [] {
+        ImGuiIO& io = ImGui::GetIO();
+        io.AddKeyEvent(ImGuiMod_Ctrl, keysDown[GLFW_KEY_LEFT_CONTROL] || keysDown[GLFW_KEY_RIGHT_CONTROL]);
+        io.AddKeyEvent(ImGuiMod_Shift, keysDown[GLFW_KEY_LEFT_SHIFT] || keysDown[GLFW_KEY_RIGHT_SHIFT]);
+        io.AddKeyEvent(ImGuiMod_Alt, keysDown[GLFW_KEY_LEFT_ALT] || keysDown[GLFW_KEY_RIGHT_ALT]);
+        io.AddKeyEvent(ImGuiMod_Super, keysDown[GLFW_KEY_LEFT_SUPER] || keysDown[GLFW_KEY_RIGHT_SUPER]);
+    };
+
+    switch (event.type) {
+    case SessionEvent::CursorPos:
+        ImGui_ImplGlfw_CursorPosCallback(window, event.x, event.y);
+        mouse_callback(window, event.x, event.y);
+        break;
+    case SessionEvent::MouseButton:
+        if (event.code == GLFW_MOUSE_BUTTON_LEFT)
+            leftMouseDown = event.action == GLFW_PRESS;
+        else if (event.code == GLFW_MOUSE_BUTTON_RIGHT)
+            rightMouseDown = event.action == GLFW_PRESS;
+        ImGui_ImplGlfw_MouseButtonCallback(window, event.code, event.action, event.mods);
+        syncModifiers();
+        break;
+    case SessionEvent::Scroll:
+        ImGui_ImplGlfw_ScrollCallback(window, event.x, event.y);
+        break;
+    case SessionEvent::Key:
+        if (event.code >= 0 && event.code <= GLFW_KEY_LAST)
+            keysDown[event.code] = event.action != GLFW_RELEASE;
+        ImGui_ImplGlfw_KeyCallback(window, event.code, event.scancode, event.action, event.mods);
+        syncModifiers();
+        break;
+    case SessionEvent::Char:
+        ImGui_ImplGlfw_CharCallback(window, (unsigned int)event.code);
+        break;
+    case SessionEvent::CursorEnter:
+        ImGui_ImplGlfw_CursorEnterCallback(window, event.code);
+        break;
+    case SessionEvent::WindowFocus:
+        ImGui_ImplGlfw_WindowFocusCallback(window, event.code);
+        break;
+    case SessionEvent::FramebufferSize:
+        if (sessionReplay.isOpen())
+            glfwSetWindowSize(window, (int)event.x, (int)event.y);
+        resize_viewport((int)event.x, (int)event.y);
+        break;
+    case SessionEvent::Frame:
+    case SessionEvent::State:
+        break;
+    }
+}
+
+// whenever the window size changed (by OS, user resize or a replay) this function executes
+// ---------------------------------------------------------------------------------------
+void resize_viewport(int width, int height)
 {
     glViewport(0, 0, width, height);
     SCR_WIDTH = width;
     SCR_HEIGHT = height;
 }
 
-// glfw: whenever the mouse moves, this callback is called
-// -------------------------------------------------------
+// whenever the mouse moves, this function is called
+// -------------------------------------------------
 void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
 {
     if (ImGui::GetIO().WantCaptureMouse)
@@ -359,25 +1570,17 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
     lastY = ypos;
 
     // Only process mouse movement if left mouse button is held down
-    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS)
+    if (leftMouseDown)
     {
         camera.ProcessMouseMovement(xoffset, yoffset, mouseSensitivity);
     }
 }
 
-// Helper function to convert Cartesian to Spherical coordinates
-void cartesianToSpherical(glm::vec3 cartesian, float& theta, float& phi)
+void setStateFromBloch(const glm::vec3& bloch)
 {
-    // Ensure the vector is normalized for unit sphere
-    cartesian = glm::normalize(cartesian);
-
-    // Calculate theta (polar angle)
-    theta = glm::acos(cartesian.y); // acos(z) for standard physics convention, acos(y) for OpenGL/math convention
-
-    // Calculate phi (azimuthal angle)
-    phi = glm::atan(cartesian.z, cartesian.x); // atan2(y, x) for standard math, atan2(z, x) for OpenGL/math convention
-
-    // Adjust phi to be in [0, 2*PI)
-    if (phi < 0.0f)
-        phi += 2.0f * M_PI;
-}
\ No newline at end of file
+    if (glm::length(bloch) <= 0.0f)
+        return;
+    blochToAngles(bloch, theta, phi);
+    theta = glm::degrees(theta);
+    phi = glm::degrees(phi);
+}
@@ -0,0 +1,71 @@
+// Non-finite and zero vectors must be skipped by both binning paths, and any
+// direction must map to a texel inside the histogram
+#include "SphereHistogram.h"
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+// Every fourth point is bad: NaN, +inf, -inf in turn, or zero
+std::vector<glm::vec3> mixedPoints(size_t count, size_t& good)
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    const glm::vec3 bad[] = { glm::vec3(nan, nan, nan), glm::vec3(0.0f, 0.0f, inf), glm::vec3(-inf, 0.5f, 0.0f),
+                              glm::vec3(0.0f), glm::vec3(0.3f, nan, 0.1f) };
+    std::vector<glm::vec3> points(count);
+    good = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i % 4 == 3) {
+            points[i] = bad[(i / 4) % 5];
+        } else {
+            points[i] = glm::vec3((float)(i % 7) - 3.0f, (float)(i % 5) - 2.0f, (float)(i % 3) - 1.0f);
+            if (points[i] == glm::vec3(0.0f))
+                points[i].z = 1.0f;
+            ++good;
+        }
+    }
+    return points;
+}
+
+}
+
+int main()
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    const unsigned int nside = 64;
+    const unsigned int bins = 12 * nside * nside;
+    const glm::vec3 odd[] = { glm::vec3(nan), glm::vec3(0.0f, 0.0f, inf), glm::vec3(inf, inf, -inf),
+                              glm::vec3(1e-30f, 0.0f, 1e-30f), glm::vec3(3e38f, -3e38f, 3e38f) };
+    for (const glm::vec3& direction : odd)
+        check(healpixTexel(nside, direction) < bins, "healpixTexel stays in range");
+
+    // Below and above the size at which add() goes parallel
+    for (size_t count : { (size_t)1000, (size_t)1 << 18 }) {
+        size_t good = 0;
+        std::vector<glm::vec3> points = mixedPoints(count, good);
+        SphereHistogram histogram(nside);
+        histogram.add(points.data(), points.size());
+        check(histogram.total() == good, "total() counts only finite nonzero vectors");
+        uint64_t sum = 0;
+        for (uint32_t value : histogram.counts())
+            sum += value;
+        check(sum == good, "counts sum to total()");
+    }
+
+    if (failures == 0)
+        std::printf("sphere_histogram_test passed\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,330 @@
+// bloch_bench: micro-benchmarks for the bloch_core hot paths. Each benchmark
+// is rerun with doubling iteration counts until one run takes at least the
+// minimum time, and the results are printed to stdout as JSON.
+//
+//   bloch_bench [--filter SUBSTRING] [--min-time SECONDS]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "BlochDynamics.h"
+#include "BlochMath.h"
+#include "GateScript.h"
+#include "GateSynthesis.h"
+#include "Gates.h"
+#include "MajoranaStars.h"
+#include "PulseEngine.h"
+#include "RandomizedBenchmarking.h"
+#include "SphereHistogram.h"
+#include "SphereIndex.h"
+#include "SphereMesh.h"
+
+namespace {
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+    uint64_t bytes = 0;  // memory the benchmarked structure holds, if it matters
+};
+
+// Keeps the compiler from discarding a value that is otherwise unused
+template <typename T>
+void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// `body(iterations)` runs the operation `iterations` times
+template <typename Body>
+Result measure(const char* name, double minSeconds, Body body)
+{
+    using Clock = std::chrono::steady_clock;
+    body(1);
+    uint64_t iterations = 1;
+    while (true) {
+        Clock::time_point start = Clock::now();
+        body(iterations);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= minSeconds || iterations >= (uint64_t(1) << 40)) {
+            Result result;
+            result.name = name;
+            result.iterations = iterations;
+            result.nsPerOp = seconds * 1e9 / double(iterations);
+            return result;
+        }
+        iterations *= 2;
+    }
+}
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: bloch_bench [options]\n"
+        "  --filter S      only run benchmarks whose name contains S\n"
+        "  --min-time T    minimum seconds per benchmark (default 0.2)\n");
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const char* filter = nullptr;
+    double minSeconds = 0.2;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    std::vector<Result> results;
+    auto wanted = [&](const char* name) { return !filter || std::strstr(name, filter); };
+    auto run = [&](const char* name, auto body) {
+        if (!wanted(name))
+            return;
+        results.push_back(measure(name, minSeconds, body));
+    };
+
+    // Vary the input per iteration so nothing folds into a constant
+    const glm::vec3 start(0.3f, -0.4f, 0.8f);
+
+    run("gate_apply", [&](uint64_t n) {
+        BlochChannel gate = hadamard();
+        glm::vec3 bloch = start;
+        for (uint64_t i = 0; i < n; ++i)
+            bloch = gate.apply(bloch);
+        doNotOptimize(bloch);
+    });
+    run("gate_compose", [&](uint64_t n) {
+        BlochChannel total;
+        BlochChannel gate = phaseT();
+        for (uint64_t i = 0; i < n; ++i)
+            total = compose(total, gate);
+        doNotOptimize(total);
+    });
+    run("rotation_gate", [&](uint64_t n) {
+        float angle = 0.1f;
+        for (uint64_t i = 0; i < n; ++i) {
+            BlochChannel gate = rotationGate(glm::vec3(0.0f, 0.6f, 0.8f), angle);
+            doNotOptimize(gate);
+            angle += 1e-6f;
+        }
+    });
+    run("bloch_from_angles", [&](uint64_t n) {
+        float theta = 0.3f;
+        for (uint64_t i = 0; i < n; ++i) {
+            glm::vec3 bloch = blochFromAngles(theta, 1.1f);
+            doNotOptimize(bloch);
+            theta += 1e-6f;
+        }
+    });
+    run("bloch_to_angles", [&](uint64_t n) {
+        glm::vec3 bloch = start;
+        for (uint64_t i = 0; i < n; ++i) {
+            float theta, phi;
+            blochToAngles(bloch, theta, phi);
+            doNotOptimize(theta);
+            doNotOptimize(phi);
+            bloch.x += 1e-7f;
+        }
+    });
+    run("amplitudes_from_bloch", [&](uint64_t n) {
+        glm::vec3 bloch = start;
+        for (uint64_t i = 0; i < n; ++i) {
+            Amplitudes amplitudes = amplitudesFromBloch(bloch);
+            doNotOptimize(amplitudes);
+            bloch.y += 1e-7f;
+        }
+    });
+    run("evolve_bloch_step", [&](uint64_t n) {
+        BlochEquationParams params;
+        params.rabi = 1.0f;
+        params.detuning = 0.2f;
+        params.t1 = 50.0f;
+        params.t2 = 30.0f;
+        glm::vec3 bloch = evolveBloch(start, params, float(n) * 0.01f, unsigned(n));
+        doNotOptimize(bloch);
+    });
+    run("parse_circuit", [&](uint64_t n) {
+        static const char kCircuit[] = "h t rx(0.5) s depol(0.01) ry(1.2) z";
+        std::vector<BlochChannel> ops;
+        std::string error;
+        for (uint64_t i = 0; i < n; ++i) {
+            parseCircuit(kCircuit, kCircuit + sizeof(kCircuit) - 1, ops, error);
+            doNotOptimize(ops.data());
+        }
+    });
+
+    const unsigned int kResolutions[] = { 16, 64, 256 };
+    for (unsigned int resolution : kResolutions) {
+        std::string name = "uv_sphere_" + std::to_string(resolution);
+        run(name.c_str(), [&](uint64_t n) {
+            MeshData mesh;
+            for (uint64_t i = 0; i < n; ++i) {
+                generateUvSphere(1.0f, resolution, resolution, mesh);
+                doNotOptimize(mesh.positions.data());
+            }
+        });
+    }
+
+    const unsigned int kSubdivisions[] = { 3, 5, 7 };
+    for (unsigned int subdivisions : kSubdivisions) {
+        std::string name = "icosphere_" + std::to_string(subdivisions);
+        run(name.c_str(), [&](uint64_t n) {
+            MeshData mesh;
+            for (uint64_t i = 0; i < n; ++i) {
+                generateIcosphere(1.0f, subdivisions, mesh);
+                doNotOptimize(mesh.positions.data());
+            }
+        });
+    }
+
+    // One op bins a million points; ops_per_sec in millions is points per second
+    std::vector<glm::vec3> points;
+    if (wanted("sphere_histogram_1m") || wanted("sphere_index_build_1m") || wanted("sphere_index_knn_16")) {
+        points.resize(1000000);
+        for (size_t i = 0; i < points.size(); ++i) {
+            float z = 1.0f - 2.0f * (i + 0.5f) / points.size();
+            float r = std::sqrt(1.0f - z * z);
+            float angle = 2.39996323f * i;
+            points[i] = glm::vec3(r * std::cos(angle), r * std::sin(angle), z);
+        }
+    }
+    run("sphere_histogram_1m", [&](uint64_t n) {
+        SphereHistogram histogram(64);
+        for (uint64_t i = 0; i < n; ++i)
+            histogram.add(points.data(), points.size());
+        doNotOptimize(histogram.total());
+    });
+
+    // Index the same million points, then query them; ids are ignored
+    run("sphere_index_build_1m", [&](uint64_t n) {
+        SphereIndex index;
+        for (uint64_t i = 0; i < n; ++i)
+            index.build(points.data(), points.size());
+        doNotOptimize(index.size());
+    });
+    if (wanted("sphere_index_knn_16")) {
+        SphereIndex index;
+        index.build(points.data(), points.size());
+        std::vector<SphereIndex::Neighbor> neighbors;
+        run("sphere_index_knn_16", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                index.nearest(points[(i * 7919) % points.size()] + glm::vec3(0.01f), 16, neighbors);
+                doNotOptimize(neighbors.data());
+            }
+        });
+    }
+
+    // Gate synthesis over a net of all Clifford+T words up to 24 gates: the
+    // plain lookup, then two Solovay-Kitaev levels on top
+    if (wanted("clifford_t_nearest") || wanted("clifford_t_sk_2")) {
+        CliffordTNet net;
+        net.build(24, 1000000);
+        std::vector<glm::dquat> targets(256);
+        for (size_t i = 0; i < targets.size(); ++i)
+            targets[i] = glm::normalize(glm::dquat(std::cos(0.37 * i), std::sin(1.3 * i), std::cos(2.1 * i + 0.5), std::sin(0.9 * i + 1.0)));
+        run("clifford_t_nearest", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                double distance;
+                doNotOptimize(net.nearest(targets[i % targets.size()], distance));
+            }
+        });
+        if (!results.empty() && results.back().name == "clifford_t_nearest")
+            results.back().bytes = net.memoryBytes();
+        run("clifford_t_sk_2", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                SynthesisResult result = synthesizeCliffordT(net, targets[i % targets.size()], 2);
+                doNotOptimize(result.distance);
+            }
+        });
+    }
+
+    // Stars of a twisted spin-50 state, from scratch and then as an animation
+    // whose twist moves a little each frame
+    run("majorana_cold_100", [&](uint64_t n) {
+        MajoranaSolver solver;
+        SpinAmplitudes state;
+        std::vector<glm::vec3> stars;
+        coherentSpinState(100, 1.2, 0.3, state);
+        twistSpinState(state, 0.5);
+        for (uint64_t i = 0; i < n; ++i) {
+            solver.reset();
+            solver.solve(state, stars);
+            doNotOptimize(stars.data());
+        }
+    });
+    run("majorana_warm_100", [&](uint64_t n) {
+        MajoranaSolver solver;
+        SpinAmplitudes state;
+        std::vector<glm::vec3> stars;
+        for (uint64_t i = 0; i < n; ++i) {
+            coherentSpinState(100, 1.2, 0.3, state);
+            twistSpinState(state, 0.5 + 0.001 * (i % 1000));
+            solver.solve(state, stars);
+            doNotOptimize(stars.data());
+        }
+    });
+
+    // Propagators of a detuned 10k-sample DRAG pulse, rebuilt every op since
+    // the angle changes, with both integrators
+    auto pulseBenchmark = [&](const char* name, PulseIntegrator integrator) {
+        run(name, [&](uint64_t n) {
+            PulseEngine engine;
+            PulseSettings settings;
+            settings.shape = PulseShape::Drag;
+            settings.integrator = integrator;
+            settings.dragBeta = 0.05;
+            settings.detuning = 3.0;
+            for (uint64_t i = 0; i < n; ++i) {
+                settings.angle = 3.0 + 1e-6 * (i % 1000);
+                engine.prepare(settings);
+                doNotOptimize(engine.total().w);
+            }
+        });
+    };
+    pulseBenchmark("pulse_pwc_10k", PulseIntegrator::PiecewiseConstant);
+    pulseBenchmark("pulse_magnus_10k", PulseIntegrator::Magnus4);
+
+    // A randomized-benchmarking run of 16 lengths up to 300 Cliffords, 100
+    // sequences each, about 96k noisy Cliffords per op
+    run("rb_run_16x100", [&](uint64_t n) {
+        RandomizedBenchmark benchmark;
+        RbSettings settings;
+        settings.sequences = 100;
+        for (uint64_t i = 0; i < n; ++i) {
+            settings.seed = i + 1;
+            benchmark.run(settings);
+            doNotOptimize(benchmark.fit().decay);
+        }
+    });
+
+    std::printf("{\"benchmarks\":[");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::printf("%s\n  {\"name\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.3f,\"ops_per_sec\":%.1f",
+            i ? "," : "", r.name.c_str(), (unsigned long long)r.iterations, r.nsPerOp,
+            r.nsPerOp > 0.0 ? 1e9 / r.nsPerOp : 0.0);
+        if (r.bytes > 0)
+            std::printf(",\"bytes\":%llu", (unsigned long long)r.bytes);
+        std::printf("}");
+    }
+    std::printf("\n]}\n");
+    return 0;
+}
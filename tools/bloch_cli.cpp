@@ -0,0 +1,177 @@
+// bloch-cli: runs gate scripts through the simulation core without a window
+// and streams the resulting Bloch vectors, amplitudes and purities.
+//
+//   bloch-cli [--format csv|binary|trajectory] [--every-step] [--repeat N] [--stats] [script]
+//
+// Each non-empty line of the script (stdin when no file is given) is one
+// circuit, see GateScript.h for the syntax. The trajectory format writes a
+// .btraj file (see TrajectoryFile.h) timed by record number, for scrubbing
+// through long runs in the viewer.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "GateScript.h"
+#include "RecordWriter.h"
+#include "TrajectoryFile.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: bloch-cli [options] [script]\n"
+        "  --format csv|binary|trajectory  output format (default csv)\n"
+        "  --every-step         emit a record after every gate, not just the final state\n"
+        "  --repeat N           run the whole script N times\n"
+        "  --stats              print throughput to stderr when done\n");
+}
+
+bool readAll(FILE* file, std::vector<char>& data)
+{
+    char chunk[1 << 16];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+        data.insert(data.end(), chunk, chunk + read);
+    return !std::ferror(file);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    RecordWriter::Format format = RecordWriter::Format::Csv;
+    bool trajectory = false;
+    bool everyStep = false;
+    bool stats = false;
+    unsigned long repeat = 1;
+    const char* path = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "csv") == 0) {
+                format = RecordWriter::Format::Csv;
+            } else if (std::strcmp(name, "binary") == 0) {
+                format = RecordWriter::Format::Binary;
+            } else if (std::strcmp(name, "trajectory") == 0) {
+                trajectory = true;
+            } else {
+                std::fprintf(stderr, "unknown format '%s'\n", name);
+                return 2;
+            }
+        } else if (std::strcmp(argv[i], "--every-step") == 0) {
+            everyStep = true;
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else if (std::strcmp(argv[i], "--help") == 0 || (argv[i][0] == '-' && argv[i][1] != '\0')) {
+            printUsage();
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    FILE* input = stdin;
+    if (path && std::strcmp(path, "-") != 0) {
+        input = std::fopen(path, "rb");
+        if (!input) {
+            std::fprintf(stderr, "cannot open '%s'\n", path);
+            return 1;
+        }
+    }
+    std::vector<char> script;
+    bool readOk = readAll(input, script);
+    if (input != stdin)
+        std::fclose(input);
+    if (!readOk) {
+        std::fprintf(stderr, "error reading script\n");
+        return 1;
+    }
+
+    // Compile every circuit once up front; --repeat then replays the flat list
+    std::vector<BlochChannel> ops;
+    std::vector<size_t> circuitEnds;
+    std::vector<BlochChannel> lineOps;
+    std::string error;
+    const char* cursor = script.data();
+    const char* end = script.data() + script.size();
+    unsigned int lineNumber = 0;
+    while (cursor < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        if (!lineEnd)
+            lineEnd = end;
+        ++lineNumber;
+        if (!parseCircuit(cursor, lineEnd, lineOps, error)) {
+            std::fprintf(stderr, "line %u: %s\n", lineNumber, error.c_str());
+            return 1;
+        }
+        if (!lineOps.empty()) {
+            ops.insert(ops.end(), lineOps.begin(), lineOps.end());
+            circuitEnds.push_back(ops.size());
+        }
+        cursor = lineEnd + 1;
+    }
+
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    RecordWriter writer(stdout, format);
+    TrajectoryWriter trajectoryWriter;
+    if (trajectory)
+        trajectoryWriter.open(stdout);
+    else
+        writer.writeHeader();
+
+    uint64_t records = 0;
+    auto emit = [&](uint32_t circuit, uint32_t step, const glm::vec3& bloch) {
+        if (trajectory)
+            trajectoryWriter.append(static_cast<double>(records), bloch);
+        else
+            writer.write(makeRecord(circuit, step, bloch));
+        ++records;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t circuit = 0;
+    for (unsigned long r = 0; r < repeat; ++r) {
+        size_t op = 0;
+        for (size_t circuitEnd : circuitEnds) {
+            glm::vec3 bloch(0.0f, 0.0f, 1.0f);
+            uint32_t step = 0;
+            for (; op < circuitEnd; ++op) {
+                bloch = ops[op].apply(bloch);
+                ++step;
+                if (everyStep)
+                    emit(circuit, step, bloch);
+            }
+            if (!everyStep)
+                emit(circuit, step, bloch);
+            ++circuit;
+        }
+    }
+    bool ok = trajectory ? trajectoryWriter.close() : writer.flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (stats) {
+        std::fprintf(stderr, "%llu records in %.3f s (%.2f M records/s)\n",
+            (unsigned long long)records, seconds, records / seconds / 1e6);
+    }
+    if (!ok) {
+        std::fprintf(stderr, "error writing output\n");
+        return 1;
+    }
+    return 0;
+}
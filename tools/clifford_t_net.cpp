@@ -0,0 +1,86 @@
+// clifford-t-net: builds the epsilon-net of Clifford+T words that gate
+// synthesis searches, and writes it as a .ctnet table (see GateSynthesis.h).
+// Prints the table size and how well it covers SU(2), estimated from random
+// targets.
+//
+//   clifford-t-net [--max-length N] [--max-entries N] [--probes N] [output]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "GateSynthesis.h"
+
+namespace {
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: clifford-t-net [options] [output]\n"
+        "  --max-length N   longest word, at most %u gates (default %u)\n"
+        "  --max-entries N  stop once the net holds N unitaries (default 1000000)\n"
+        "  --probes N       random targets for the coverage estimate (default 10000)\n"
+        "  output           table to write (default clifford_t.ctnet)\n",
+        CliffordTNet::kMaxWordLength, CliffordTNet::kMaxWordLength);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int maxLength = CliffordTNet::kMaxWordLength;
+    size_t maxEntries = 1000000;
+    unsigned long probes = 10000;
+    const char* path = "clifford_t.ctnet";
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--max-length") == 0 && i + 1 < argc) {
+            maxLength = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--max-entries") == 0 && i + 1 < argc) {
+            maxEntries = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--probes") == 0 && i + 1 < argc) {
+            probes = std::strtoul(argv[++i], nullptr, 10);
+        } else if (argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    CliffordTNet net;
+    net.build(maxLength, maxEntries);
+    double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::string error;
+    if (!net.save(path, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    // Uniform random rotations are normalized 4D Gaussians
+    std::mt19937 rng(1);
+    std::normal_distribution<double> gaussian;
+    double worst = 0.0, total = 0.0;
+    start = Clock::now();
+    for (unsigned long i = 0; i < probes; ++i) {
+        glm::dquat target = glm::normalize(glm::dquat(gaussian(rng), gaussian(rng), gaussian(rng), gaussian(rng)));
+        double distance;
+        net.nearest(target, distance);
+        worst = std::max(worst, distance);
+        total += distance;
+    }
+    double queryUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / std::max(probes, 1ul);
+
+    std::printf("%zu unitaries, words up to %u gates, built in %.0f ms\n", net.size(), net.maxLength(), buildMs);
+    std::printf("%s: %zu bytes on disk, %zu bytes in memory\n", path, net.fileBytes(), net.memoryBytes());
+    std::printf("distance to random targets: mean %.4f, worst %.4f, %.1f us per lookup\n",
+                total / std::max(probes, 1ul), worst, queryUs);
+    return 0;
+}
@@ -0,0 +1,159 @@
+// ingest-generator: stand-in for an instrument that can only push datagrams.
+// Sends batches of synthetic states as StatePackets to the viewer's ingest
+// server over localhost UDP or a Unix domain socket.
+//
+//   ingest-generator [--udp PORT | --unix PATH] [--rate HZ] [--batch N]
+//                    [--seconds S] [--loss P]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+
+#include "StatePacket.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: ingest-generator [options]\n"
+        "  --udp PORT     send to 127.0.0.1:PORT (default 47000)\n"
+        "  --unix PATH    send to a Unix domain datagram socket instead\n"
+        "  --rate HZ      samples per second (default 10000)\n"
+        "  --batch N      samples per datagram, at most %zu (default 32)\n"
+        "  --seconds S    stop after S seconds, 0 runs forever (default 0)\n"
+        "  --loss P       skip sending a fraction P of datagrams to exercise loss counters\n",
+        kMaxSamplesPerPacket);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int port = 47000;
+    const char* unixPath = nullptr;
+    double rate = 10000.0;
+    size_t batch = 32;
+    double seconds = 0.0;
+    double loss = 0.0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--udp") == 0 && i + 1 < argc) {
+            port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--unix") == 0 && i + 1 < argc) {
+            unixPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            rate = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--loss") == 0 && i + 1 < argc) {
+            loss = std::atof(argv[++i]);
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    batch = std::max<size_t>(1, std::min(batch, kMaxSamplesPerPacket));
+    if (rate <= 0.0) {
+        std::fprintf(stderr, "rate must be positive\n");
+        return 2;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+    if (unixPath) {
+        std::fprintf(stderr, "Unix sockets are not supported on this platform\n");
+        return 1;
+    }
+    SOCKET fd = socket(AF_INET, SOCK_DGRAM, 0);
+#else
+    int fd = socket(unixPath ? AF_UNIX : AF_INET, SOCK_DGRAM, 0);
+#endif
+
+    sockaddr_storage target = {};
+    socklen_t targetSize = 0;
+    if (unixPath) {
+#ifndef _WIN32
+        sockaddr_un* address = reinterpret_cast<sockaddr_un*>(&target);
+        address->sun_family = AF_UNIX;
+        std::strncpy(address->sun_path, unixPath, sizeof(address->sun_path) - 1);
+        targetSize = sizeof(sockaddr_un);
+#endif
+    } else {
+        sockaddr_in* address = reinterpret_cast<sockaddr_in*>(&target);
+        address->sin_family = AF_INET;
+        address->sin_port = htons(static_cast<unsigned short>(port));
+        address->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        targetSize = sizeof(sockaddr_in);
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    StateSample samples[kMaxSamplesPerPacket] = {};
+    unsigned char packet[kMaxStatePacketSize];
+    uint32_t sequence = 0;
+    uint64_t sent = 0;
+    uint64_t failed = 0;
+
+    double start = steadySeconds();
+    double lastReport = start;
+    uint64_t sentAtReport = 0;
+    for (;;) {
+        double now = steadySeconds();
+        double elapsed = now - start;
+        if (seconds > 0.0 && elapsed >= seconds)
+            break;
+
+        uint64_t due = static_cast<uint64_t>(elapsed * rate);
+        while (sent + batch <= due) {
+            for (size_t i = 0; i < batch; ++i) {
+                // Detuned precession around a tilted axis
+                double t = (sent + i) / rate;
+                glm::vec3 bloch = blochFromAngles(static_cast<float>(kPi / 4.0 + 0.3 * std::sin(0.5 * t)), static_cast<float>(2.0 * kPi * 0.5 * t));
+                samples[i].timestamp = steadySeconds();
+                samples[i].kind = StateSample::Bloch;
+                samples[i].values[0] = bloch.x;
+                samples[i].values[1] = bloch.y;
+                samples[i].values[2] = bloch.z;
+            }
+            size_t size = encodeStatePacket(sequence++, samples, batch, packet);
+            sent += batch;
+            if (loss > 0.0 && uniform(rng) < loss)
+                continue;
+            if (sendto(fd, reinterpret_cast<const char*>(packet), static_cast<int>(size), 0, reinterpret_cast<sockaddr*>(&target), targetSize) < 0)
+                ++failed;
+        }
+
+        if (now - lastReport >= 1.0) {
+            std::fprintf(stderr, "%.0f samples/s, %u datagrams, %llu send failures\n",
+                (sent - sentAtReport) / (now - lastReport), sequence, (unsigned long long)failed);
+            lastReport = now;
+            sentAtReport = sent;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return 0;
+}
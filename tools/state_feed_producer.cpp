@@ -0,0 +1,169 @@
+// state-feed-producer: stand-in for the lab controller. Creates the shared
+// state ring and pushes a synthetic stream of timestamped states into it.
+//
+//   state-feed-producer [--name bloch_feed] [--rate HZ] [--capacity N]
+//                       [--seconds S] [--pattern rabi|spiral|noise] [--amplitudes]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "SharedStateRing.h"
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+enum class Pattern { Rabi, Spiral, Noise };
+
+// Set by SIGINT/SIGTERM so the loop ends and the ring's name is removed
+std::atomic<bool> stopRequested(false);
+static_assert(std::atomic<bool>::is_always_lock_free, "the stop flag is set from a signal handler");
+
+void requestStop(int)
+{
+    stopRequested.store(true, std::memory_order_relaxed);
+}
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "usage: state-feed-producer [options]\n"
+        "  --name NAME              shared memory name (default bloch_feed)\n"
+        "  --rate HZ                samples per second (default 1000)\n"
+        "  --capacity N             ring slots (default 65536)\n"
+        "  --seconds S              stop after S seconds, 0 runs forever (default 0)\n"
+        "  --pattern rabi|spiral|noise  synthetic trajectory (default rabi)\n"
+        "  --amplitudes             send amplitudes instead of Bloch vectors\n");
+}
+
+glm::vec3 patternAt(Pattern pattern, double t, std::mt19937& rng)
+{
+    switch (pattern) {
+    case Pattern::Spiral: {
+        // Slow sweep from pole to pole while precessing
+        double theta = kPi * 0.5 * (1.0 - std::cos(0.1 * t));
+        return blochFromAngles(static_cast<float>(theta), static_cast<float>(2.0 * kPi * t));
+    }
+    case Pattern::Noise: {
+        std::normal_distribution<float> jitter(0.0f, 0.05f);
+        glm::vec3 bloch = blochFromAngles(static_cast<float>(kPi / 3.0), static_cast<float>(t)) + glm::vec3(jitter(rng), jitter(rng), jitter(rng));
+        return bloch / std::max(1.0f, glm::length(bloch));
+    }
+    default:
+        // Resonant Rabi oscillation, one cycle per second
+        return glm::vec3(0.0f, static_cast<float>(-std::sin(2.0 * kPi * t)), static_cast<float>(std::cos(2.0 * kPi * t)));
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const char* name = "bloch_feed";
+    double rate = 1000.0;
+    unsigned long capacity = 65536;
+    double seconds = 0.0;
+    Pattern pattern = Pattern::Rabi;
+    bool amplitudes = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            rate = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) {
+            capacity = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--pattern") == 0 && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (std::strcmp(value, "rabi") == 0) {
+                pattern = Pattern::Rabi;
+            } else if (std::strcmp(value, "spiral") == 0) {
+                pattern = Pattern::Spiral;
+            } else if (std::strcmp(value, "noise") == 0) {
+                pattern = Pattern::Noise;
+            } else {
+                std::fprintf(stderr, "unknown pattern '%s'\n", value);
+                return 2;
+            }
+        } else if (std::strcmp(argv[i], "--amplitudes") == 0) {
+            amplitudes = true;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (rate <= 0.0) {
+        std::fprintf(stderr, "rate must be positive\n");
+        return 2;
+    }
+
+    SharedStateRing feed;
+    std::string error;
+    if (!feed.create(name, static_cast<uint32_t>(capacity), error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    SpscRing<StateSample>& ring = feed.ring();
+    std::fprintf(stderr, "feeding '%s' at %.0f Hz, %u slots\n", name, rate, ring.capacity());
+
+    // Closing the ring on the way out of main unlinks the shared memory
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    std::mt19937 rng(1234);
+    double start = steadySeconds();
+    double lastReport = start;
+    uint64_t sent = 0;
+    uint64_t sentAtReport = 0;
+    while (!stopRequested.load(std::memory_order_relaxed)) {
+        double now = steadySeconds();
+        double elapsed = now - start;
+        if (seconds > 0.0 && elapsed >= seconds)
+            break;
+
+        // Catch up to the target count in one burst, then sleep; high rates
+        // are reached by larger bursts rather than shorter sleeps
+        uint64_t target = static_cast<uint64_t>(elapsed * rate);
+        for (; sent < target; ++sent) {
+            double t = sent / rate;
+            glm::vec3 bloch = patternAt(pattern, t, rng);
+            StateSample sample = {};
+            sample.timestamp = steadySeconds();
+            if (amplitudes) {
+                Amplitudes a = amplitudesFromBloch(bloch);
+                sample.kind = StateSample::Amplitudes;
+                sample.values[0] = a.alpha.real();
+                sample.values[1] = a.alpha.imag();
+                sample.values[2] = a.beta.real();
+                sample.values[3] = a.beta.imag();
+            } else {
+                sample.kind = StateSample::Bloch;
+                sample.values[0] = bloch.x;
+                sample.values[1] = bloch.y;
+                sample.values[2] = bloch.z;
+            }
+            ring.tryPush(sample);
+        }
+
+        if (now - lastReport >= 1.0) {
+            std::fprintf(stderr, "%.0f samples/s, %llu dropped (ring full)\n",
+                (sent - sentAtReport) / (now - lastReport), (unsigned long long)ring.dropped());
+            lastReport = now;
+            sentAtReport = sent;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    feed.close();
+    return 0;
+}